@@ -1,22 +1,35 @@
 ﻿#define _CRT_SECURE_NO_WARNINGS
 #include "raylib.h"
+#include "atlas.h"
+#include "bot.h"
+#include "game.h"
+#include "cli.h"
+#include "io.h"
+#include "journal.h"
+#include "prof.h"
+#include "save.h"
+#include "stats.h"
+#include "undo.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
 #include <math.h>
+#include <stddef.h>
 
 #define SCREEN_WIDTH    1920
 #define SCREEN_HEIGHT   1080
-#define BOARD_SIZE      10
 #define CELL_SIZE       80 
 #define BOARD_OFFSET_X  ((SCREEN_WIDTH - BOARD_SIZE * CELL_SIZE) / 2) //center screen 
 #define BOARD_OFFSET_Y  150
-#define MAX_SNAKES      20
-#define MAX_LADDERS     5 //default 5 
+#define VIEW_SIZE       (BOARD_SIZE * CELL_SIZE) //boards of any size are seen through the 10x10 window
+#define ZOOM_MAX        2.f
+#define GRID_MIN_PX     6.f  //cells smaller than this on screen skip their outlines
+#define LABEL_MIN_PX    28.f //and these skip their numbers
 
 //game states apilon presentation
 typedef enum {
+    LOADING_ASSETS,
     TITLE_SCREEN,
     SELECT_PLAYERS,
     ENTER_NAMES,
@@ -25,59 +38,48 @@ typedef enum {
     PIECE_MOVING,
     NAME_INPUT_SAVE,
     PLACING_SNAKE,
+    LOAD_BROWSER,
     GAME_OVER
 } GameState;
 
-typedef enum { 
-    MODE_CLASSIC,
-    MODE_CHAOS
-} Mode;
-
 typedef struct {
-    Texture2D texture;
+    Rectangle src; //where it sits in the atlas
     Rectangle bounds;
 } Button;
 
 typedef struct {
-    int position;
     Color color;
     char name[32];
     int playerNumber;
-    Texture2D  token;
+    Rectangle token; //in the atlas
 } Player;
 
-typedef struct {
-    int   position;
-    Color color;
-    char  name[32];
-    int   playerNumber;
-} SavePlayer;
-
-typedef struct SnakeOrLadder {
-    int start;
-    int end;
-    struct SnakeOrLadder* next;
-} SnakeOrLadder;
 
-
-static GameState state = TITLE_SCREEN;
-static Mode gMode = MODE_CLASSIC;
+static GameState state = LOADING_ASSETS;
+static Game game; //rules state, see game.h
 
 static Player players[4];
-static int playerCount = 2;
-static int diceCount = 1;
-static int currentPlayer = 0;        
 static int dieA = 1, dieB = 0;      
 static int diceTotal = 1;       
 
-static int boardNumbers[BOARD_SIZE][BOARD_SIZE];
-static SnakeOrLadder* snakes = NULL;
-static SnakeOrLadder* ladders = NULL;
-static int snakeCount = 0;
-
-static int personalTurn[4] = { 0 };
-static bool canPlace[4] = { 0 };
-static int globalTurn = 0;
+//board geometry, world space has the top left corner of the board at 0,0 and a cell is
+//CELL_SIZE across. rebuilt only when the board size changes
+static int geoWidth = 0, geoHeight = 0;
+static Vector2* tileCenter = NULL; //tile -> world position of its center, tiles + 1 entries
+static int* cellTile = NULL;       //row * width + col -> tile, row 0 is the top one
+static Camera2D camera;            //world to screen, the view window sits at BOARD_OFFSET
+
+//board size picked on the setup screen
+static const int boardSizes[][2] = { { 10, 10 }, { 16, 12 }, { 30, 30 }, { 100, 100 }, { 1000, 1000 } };
+static int boardPick = 0;
+
+//the view only changes when a snake goes down, a game starts or loads or the camera moves,
+//so it is drawn into a texture then and each frame just blits it
+static RenderTexture2D boardLayer;
+static Board boardDrawn; //links the layer was drawn from
+static Camera2D cameraDrawn;
+static bool boardLayerValid = false;
+static Texture2D checker; //2x2 cell colors, repeated over the whole board in one quad
 
 static bool diceAnimating = false;
 static int animFaceA = 1;
@@ -85,44 +87,106 @@ static int animFaceB = 1;
 static float diceAnimTimer = 0.f;
 static const float DICE_FRAME = 0.08f;  
 
-static int stepsRemaining = 0;
-static int stepDir = 1;    
+static TokenWalk walk;
 static float stepTimer = 0.f;
 static const float STEP_DELAY = 0.15f;
-static bool bouncing = false;  
 
-static int winnerIdx = -1;
+//animation and walking advance in fixed ticks, so leftover time carries into the next frame
+//and the speed doesn't depend on the frame rate. tokens are drawn between ticks
+#define TICK       (1.f / 120.f)
+#define MAX_TICKS  12 //a frame slower than 100 ms drops the rest rather than catching up
+static float tickAccum = 0.f;
+
+//turbo (F5) plays whole turns straight through the rules, for demos and soak runs
+#define TURBO_TURNS   256  //per frame
+#define TURBO_REMATCH 1.5f //seconds the winner stays up before the next game starts
+static bool turbo = false;
+static float turboWait = 0.f;
+
+//seats the computer plays: it places its chaos snakes with the expectimax bot and rolls and
+//throws on its own after a short pause so the moves can be followed
+#define BOT_PAUSE 0.6f
+static Bot bot;
+static uint32_t botSeats = 0;
+static int botAsked = -1; //the turn the bot last decided on, it keeps its right until its next turn
+static float botWait = 0.f;
 
 static char nameBuf[32] = ""; 
 static int nameLen = 0, nameIdx = 0;
 static char saveFile[64] = ""; 
 static int saveLen = 0;
 static GameState returnState;
-static char tileBuf[4] = ""; 
+static char tileBuf[8] = ""; 
 static int tileLen = 0;
 
-static char loadNames[64][64];
-static int loadCount = 0;
-
-static Texture2D diceTex[6];
-static Texture2D tokenTex[4];
+//save browser, rows come a page at a time from the io worker
+#define BROWSER_ROWS 12
+static IoRow browserRows[IO_PAGE];
+static int browserRowCount = 0, browserPageStart = 0, browserTotal = 0;
+static int browserSel = 0, browserFirst = 0;
+static CatalogSort browserSort = CATALOG_BY_TIME;
+static char browserText[32] = "";
+static int browserTextLen = 0;
+static bool listInFlight = false, listWanted = false, loadInFlight = false;
+
+static bool profOverlay = false; //F3, F4 streams every frame to a csv
+
+//short messages over whatever is on screen instead of stalling the frame
+#define TOAST_MAX 4
+static const float TOAST_TIME = 2.5f;
+typedef struct {
+    char text[96];
+    Color color;
+    float left;
+} Toast;
+static Toast toasts[TOAST_MAX];
+
+//F6, counts of what's been played on screen. shard 1 is the game in play, shard 0 every
+//game before it this session, the session column merges the two
+static StatsShard liveStats[2];
+static int chaosFrom = 0; //snakes the game had when it started or was loaded
+static bool statsPanel = false;
+
+//everything the ui draws comes out of one texture, see atlas.h
+static Atlas atlas;
+static AtlasLoader loader; //decoding while the progress bar shows, done once state leaves LOADING_ASSETS
+static Rectangle diceSrc[6];
+static Rectangle tokenSrc[4];
+
+//what goes into the atlas, relative to assets/. "SnakesAndLadders atlas" packs exactly these
+static const char* const uiImages[] = {
+    "buttons/background.png", "buttons/title.png", "buttons/start_btn.png", "buttons/load_btn.png",
+    "buttons/exit_btn.png", "buttons/2p.png", "buttons/3p.png", "buttons/4p.png",
+    "buttons/one_die_btn.png", "buttons/two_dice_btn.png", "buttons/Classic_Mode_btn.png", "buttons/Chaos_mode_btn.png",
+    "buttons/play_btn.png", "buttons/roll_btn.png", "buttons/throw_btn.png", "buttons/save_btn.png",
+    "buttons/place_snake_btn.png",
+    "dice/dice1.png", "dice/dice2.png", "dice/dice3.png", "dice/dice4.png", "dice/dice5.png", "dice/dice6.png",
+    "tokens/token1.png", "tokens/token2.png", "tokens/token3.png", "tokens/token4.png"
+};
+#define UI_IMAGES ((int)(sizeof(uiImages) / sizeof(uiImages[0])))
 
 static Button bg, titleB, startB, loadB, exitB;
 static Button twoP, threeP, fourP, oneDie, twoDice, classicBtn, chaosBtn;
 static Button playB;
 static Button rollB, throwB, leaveB, saveB, placeSnakeB;
+static UndoRing undo; //Ctrl+Z / Ctrl+Y between turns
+static JournalWriter journal; //the game being played, on disk through the io worker
 
-static Button makeBtn(const char* path, int x, int y)
+static Button makeBtn(const char* name, int x, int y)
 {
     Button b;
-    b.texture = LoadTexture(path);
+    b.src = AtlasRect(&atlas, name);
     b.bounds = (Rectangle){
         x, y,
-        b.texture.width, 
-        b.texture.height 
+        b.src.width, 
+        b.src.height 
     };
     return b;
 }
+static void DrawButton(Button b)
+{
+    DrawTextureRec(atlas.texture, b.src, (Vector2){ b.bounds.x, b.bounds.y }, WHITE);
+}
 static bool hit(Button b)
 {
     return CheckCollisionPointRec(GetMousePosition(), b.bounds) && IsMouseButtonPressed(MOUSE_LEFT_BUTTON);
@@ -134,411 +198,821 @@ static inline int DiceFaceA(void)
 }
 static inline int DiceFaceB(void)
 {
-    if (diceCount == 1) {
+    if (game.diceCount == 1) {
         return 0;
     }
     return (state == DICE_ROLLING) ? animFaceB : dieB;
 }
 
-static void FreeSnakesAndLadders(void)
+static float FitZoom(void)
 {
-    SnakeOrLadder* n = snakes;
-    while (n){ SnakeOrLadder * nxt = n->next;
-    free(n);
-    n = nxt; }
-    n = ladders;
-
-    while (n){ 
-        SnakeOrLadder * nxt = n->next;
-        free(n);
-        n = nxt; }
-    snakes = ladders = NULL;
-    snakeCount = 0;
+    const Board* b = &game.board;
+    return VIEW_SIZE / (float)((b->width > b->height ? b->width : b->height) * CELL_SIZE);
 }
 
-static void InitBoardNumbers(void)
+//whole board in the view window, centered
+static void FitCamera(void)
 {
-    int n = 1;
-    bool right = true;
-    for (int r = BOARD_SIZE - 1; r >= 0; --r)
-    {
-        for (int c = 0; c < BOARD_SIZE; ++c)
-            boardNumbers[r][right ? c : (BOARD_SIZE - 1 - c)] = n++;
-        right = !right;
-    }
+    camera.zoom = FitZoom();
+    camera.target = (Vector2){ game.board.width * CELL_SIZE / 2.f, game.board.height * CELL_SIZE / 2.f };
+    camera.offset = (Vector2){ BOARD_OFFSET_X + VIEW_SIZE / 2.f, BOARD_OFFSET_Y + VIEW_SIZE / 2.f };
+    camera.rotation = 0.f;
 }
 
-static void PushLink(SnakeOrLadder** head, int s, int e)
+//tile centers and the cell lookup for the board's size, the numbering is TileCell's
+static bool BuildGeometry(int width, int height)
 {
-    //linked list implementation
-    SnakeOrLadder* n = (SnakeOrLadder*)malloc(sizeof(SnakeOrLadder));
-    n->start = s;
-    n->end = e;
-    n->next = *head;
-    *head = n;
+    if (width == geoWidth && height == geoHeight) {
+        return true;
+    }
+    int tiles = width * height;
+    Vector2* center = (Vector2*)malloc(((size_t)tiles + 1) * sizeof(Vector2));
+    int* cell = (int*)malloc((size_t)tiles * sizeof(int));
+    if (!center || !cell) {
+        free(center);
+        free(cell);
+        return false;
+    }
+    free(tileCenter);
+    free(cellTile);
+    tileCenter = center;
+    cellTile = cell;
+    geoWidth = width;
+    geoHeight = height;
+
+    tileCenter[0] = (Vector2){ -CELL_SIZE, (height - 0.5f) * CELL_SIZE }; //off the board left of tile 1
+    for (int t = 1; t <= tiles; t++) {
+        int c, r;
+        TileCell(width, height, t, &c, &r);
+        tileCenter[t] = (Vector2){ c * CELL_SIZE + CELL_SIZE / 2.f, r * CELL_SIZE + CELL_SIZE / 2.f };
+        cellTile[r * width + c] = t;
+    }
+    boardLayerValid = false;
+    return true;
 }
-static void InitSnakesLadders(void)
+
+//fresh seed per game, a bug report only needs this number to get the same rolls back
+static uint64_t NewSeed(void)
 {
-    FreeSnakesAndLadders();
- 
-    PushLink(&snakes, 97, 78);
-    PushLink(&snakes, 82, 55);
-    PushLink(&snakes, 49, 27);
-    PushLink(&snakes, 37, 21);
-    PushLink(&snakes, 16, 6);
-    snakeCount = 5; //default 5 to check for placed snakes
- 
-    PushLink(&ladders, 80, 99);
-    PushLink(&ladders, 71, 92);
-    PushLink(&ladders, 28, 76);
-    PushLink(&ladders, 8, 30);
-    PushLink(&ladders, 4, 14);
+    static uint64_t games = 0;
+    return GameSeed((uint64_t)time(NULL), games++);
 }
 
 static void ResetGame(void)
 {
-    playerCount = 2; diceCount = 1; currentPlayer = 0;
+    JournalEnd(&journal, game.winner < 0); //a game dropped before anyone won was left
+    UndoClear(&undo);
+    botSeats = 0;
+    GameInit(&game, 2, 1, MODE_CLASSIC, NewSeed());
+    FitCamera();
     dieA = dieB = diceTotal = 1;
-    InitSnakesLadders();
-    memset(personalTurn, 0, sizeof(personalTurn));
-    memset(canPlace, 0, sizeof(canPlace));
-    globalTurn = 0;  gMode = MODE_CLASSIC;
-    bouncing = false; winnerIdx = -1;
 
     for (int i = 0; i < 4; ++i) {
-        players[i].position = 1; //places player at 1 at starting
+        Rng rng = RngAt(game.seed, (uint64_t)i, RNG_COLOR);
         players[i].color = (Color){
-            GetRandomValue(50, 255),
-            GetRandomValue(50, 255),
-            GetRandomValue(50, 255), 255
+            RngRange(&rng, 50, 255),
+            RngRange(&rng, 50, 255),
+            RngRange(&rng, 50, 255), 255
         };
         sprintf(players[i].name, "Player %d", i + 1);
         players[i].playerNumber = i + 1;
-        players[i].token = tokenTex[i];
+        players[i].token = tokenSrc[i];
     }
 }
 
+//world position of a tile's center, one lookup
 static Vector2 CellPos(int num)
 {
-    if (num < 1 || num>100) {
-        return (Vector2) { -500, -500 };
+    if (num < 0 || num > geoWidth * geoHeight) {
+        return (Vector2) { -10000, -10000 };
     }
-    //logic for the board tiles do not touch anymore pls
-    for (int r = 0; r < BOARD_SIZE; r++)
-        for (int c = 0; c < BOARD_SIZE; c++)
-            if (boardNumbers[r][c] == num){
-                return (Vector2) { BOARD_OFFSET_X + c * CELL_SIZE + CELL_SIZE / 2,BOARD_OFFSET_Y + r * CELL_SIZE + CELL_SIZE / 2 }
-            };
-    return (Vector2) { 0, 0 }; 
+    return tileCenter[num];
 }
-static int Slide(int pos)
+
+static bool InView(Vector2 screen)
 {
-    for (SnakeOrLadder* s = snakes; s; s = s->next) {
-        if (s->start == pos) {
-            return s->end;
-        }
+    return screen.x >= BOARD_OFFSET_X && screen.x < BOARD_OFFSET_X + VIEW_SIZE &&
+        screen.y >= BOARD_OFFSET_Y && screen.y < BOARD_OFFSET_Y + VIEW_SIZE;
+}
+
+//tile under a screen point, 0 off the board
+static int TileAt(Vector2 screen)
+{
+    if (!InView(screen)) {
+        return 0;
     }
-    for (SnakeOrLadder* l = ladders; l; l = l->next) {
-        if (l->start == pos) {
-            return l->end;
-        }
+    Vector2 w = GetScreenToWorld2D(screen, camera);
+    int c = (int)floorf(w.x / CELL_SIZE), r = (int)floorf(w.y / CELL_SIZE);
+    if (c < 0 || c >= geoWidth || r < 0 || r >= geoHeight) {
+        return 0;
     }
-    return pos;
+    return cellTile[r * geoWidth + c];
 }
-static int RollDice(void)
+
+//wheel zooms about the cursor, right or middle drag pans, home fits the board again
+static void MoveCamera(void)
 {
-    //bruteforce dice 2 = 0
-    dieA = GetRandomValue(1, 6);
-    if (diceCount == 1) {
-        dieB = 0;
-        return dieA;
+    if (!BuildGeometry(game.board.width, game.board.height)) {
+        return;
+    }
+    Vector2 mouse = GetMousePosition();
+    float wheel = GetMouseWheelMove();
+    if (wheel != 0.f && InView(mouse)) {
+        float fit = FitZoom();
+        camera.target = GetScreenToWorld2D(mouse, camera);
+        camera.offset = mouse;
+        camera.zoom *= wheel > 0 ? 1.25f : 0.8f;
+        if (camera.zoom < fit) camera.zoom = fit;
+        if (camera.zoom > ZOOM_MAX) camera.zoom = ZOOM_MAX;
     }
-    dieB = GetRandomValue(1, 6);
-    return dieA + dieB;
+    if ((IsMouseButtonDown(MOUSE_BUTTON_RIGHT) || IsMouseButtonDown(MOUSE_BUTTON_MIDDLE)) && InView(mouse)) {
+        Vector2 d = GetMouseDelta();
+        camera.target.x -= d.x / camera.zoom;
+        camera.target.y -= d.y / camera.zoom;
+    }
+    if (IsKeyPressed(KEY_HOME)) {
+        FitCamera();
+    }
+
+    //the board center never leaves the window
+    Vector2 c = GetWorldToScreen2D((Vector2){ geoWidth * CELL_SIZE / 2.f, geoHeight * CELL_SIZE / 2.f }, camera);
+    if (c.x < BOARD_OFFSET_X) camera.target.x -= (BOARD_OFFSET_X - c.x) / camera.zoom;
+    if (c.x > BOARD_OFFSET_X + VIEW_SIZE) camera.target.x += (c.x - BOARD_OFFSET_X - VIEW_SIZE) / camera.zoom;
+    if (c.y < BOARD_OFFSET_Y) camera.target.y -= (BOARD_OFFSET_Y - c.y) / camera.zoom;
+    if (c.y > BOARD_OFFSET_Y + VIEW_SIZE) camera.target.y += (c.y - BOARD_OFFSET_Y - VIEW_SIZE) / camera.zoom;
 }
 
-static bool TileOccupied(int tile)
+static void ShowToast(Color color, const char* text)
 {
-    for (SnakeOrLadder* s = snakes; s; s = s->next) {
-        if (s->start == tile || s->end == tile)
-            return true;
-    }
+    //newest on top, the oldest one drops off
+    memmove(&toasts[1], &toasts[0], sizeof(Toast) * (TOAST_MAX - 1));
+    strncpy(toasts[0].text, text, sizeof(toasts[0].text) - 1);
+    toasts[0].text[sizeof(toasts[0].text) - 1] = '\0';
+    toasts[0].color = color;
+    toasts[0].left = TOAST_TIME;
+}
 
-    for (SnakeOrLadder* l = ladders; l; l = l->next) {
-        if (l->start == tile || l->end == tile)
-            return true;
+static void DrawToasts(void)
+{
+    int y = 20;
+    for (int i = 0; i < TOAST_MAX; i++) {
+        if (toasts[i].left <= 0.f) continue;
+        toasts[i].left -= GetFrameTime();
+        float a = toasts[i].left < 0.5f ? toasts[i].left / 0.5f : 1.f;
+        int w = MeasureText(toasts[i].text, 26) + 40;
+        DrawRectangle(SCREEN_WIDTH / 2 - w / 2, y, w, 44, Fade(WHITE, 0.9f * a));
+        DrawRectangleLines(SCREEN_WIDTH / 2 - w / 2, y, w, 44, Fade(toasts[i].color, a));
+        DrawText(toasts[i].text, SCREEN_WIDTH / 2 - w / 2 + 20, y + 9, 26, Fade(toasts[i].color, a));
+        y += 52;
     }
-    return false;
 }
 
-static void SaveBinary(const char* fn)
+//p50/p99/max per zone over the last PROF_HISTORY frames and a histogram of whole frames
+static void DrawProfiler(void)
 {
-    FILE* fp = fopen(fn, "wb");
-    if (!fp) {
-        perror("save");
-        return;
+    int x = 20, y = 20;
+    DrawRectangle(x, y, 420, 420, Fade(BLACK, 0.8f));
+    DrawText(TextFormat("frame ms over %d frames%s", ProfFrameCount(), ProfCsvActive() ? "  [csv]" : ""), x + 12, y + 10, 20, WHITE);
+    DrawText("zone        p50     p99     max", x + 12, y + 40, 20, LIGHTGRAY);
+    for (int z = 0; z <= PROF_ZONES; z++) {
+        ProfStat st = ProfStats(z);
+        const char* name = z < PROF_ZONES ? profZoneNames[z] : "total";
+        DrawText(TextFormat("%-8s %7.2f %7.2f %7.2f", name, st.p50, st.p99, st.max), x + 12, y + 66 + z * 24, 20, z < PROF_ZONES ? WHITE : YELLOW);
     }
 
+    int buckets[PROF_BUCKETS], most = 1;
+    ProfHistogram(PROF_TOTAL, buckets);
+    for (int b = 0; b < PROF_BUCKETS; b++) {
+        if (buckets[b] > most) most = buckets[b];
+    }
+    int base = y + 400, h = 130;
+    for (int b = 0; b < PROF_BUCKETS; b++) {
+        int bh = buckets[b] * h / most;
+        Color c = b < 17 ? GREEN : (b < 33 ? ORANGE : RED); //under 60 fps, under 30, slower
+        DrawRectangle(x + 12 + b * 12, base - bh, 10, bh, c);
+    }
+    DrawText("0", x + 12, base + 2, 10, LIGHTGRAY);
+    DrawText("16", x + 12 + 16 * 12, base + 2, 10, LIGHTGRAY);
+    DrawText("33+", x + 12 + 33 * 12, base + 2, 10, LIGHTGRAY);
+}
 
-    fwrite(&playerCount, sizeof(int), 1, fp);
-    fwrite(&currentPlayer, sizeof(int), 1, fp);
-    fwrite(&diceCount, sizeof(int), 1, fp);
-    fwrite(&gMode, sizeof(int), 1, fp);
+static void StatsRow(int x, int y, const char* name, int64_t game, int64_t session)
+{
+    DrawText(TextFormat("%-12s %10lld %10lld", name, (long long)game, (long long)session), x, y, 20, WHITE);
+}
 
+//the game in play next to the whole session, and the session's rolls as bars
+static void DrawStatsPanel(void)
+{
+    Stats all;
+    StatsMerge(liveStats, 2, &all);
+    const Stats* now = &liveStats[1].s;
+    int x = 20, y = 640;
+    DrawRectangle(x, y, 520, 400, Fade(BLACK, 0.8f));
+    DrawText("stats (F6)      this game    session", x + 12, y + 10, 20, LIGHTGRAY);
+    StatsRow(x + 12, y + 40, "games", now->games, all.games);
+    StatsRow(x + 12, y + 64, "moves", now->moves, all.moves);
+    StatsRow(x + 12, y + 88, "snake hits", now->snakeHits, all.snakeHits);
+    StatsRow(x + 12, y + 112, "ladder hits", now->ladderHits, all.ladderHits);
+    StatsRow(x + 12, y + 136, "bounces", now->bounces, all.bounces);
+    StatsRow(x + 12, y + 160, "snakes put", now->chaosPlaced, all.chaosPlaced);
+    StatsRow(x + 12, y + 184, "put ones hit", now->chaosHits, all.chaosHits);
+    if (all.games) {
+        DrawText(TextFormat("turns a game %.1f (p50 %d)", (double)all.turns / (double)all.games, StatsTurnPercentile(&all, 50)), x + 12, y + 208, 20, YELLOW);
+    }
 
-    int safeSnakeCount = snakeCount;
-    if (safeSnakeCount < 0) {
-        safeSnakeCount = 0;
+    int64_t most = 1;
+    for (int r = 1; r < STATS_ROLLS; r++) {
+        if (all.rollTotals[r] > most) most = all.rollTotals[r];
     }
-    if (safeSnakeCount > MAX_SNAKES) {
-        safeSnakeCount = MAX_SNAKES;
+    int base = y + 370, h = 120;
+    for (int r = 1; r < STATS_ROLLS; r++) {
+        int bh = (int)(all.rollTotals[r] * h / most);
+        DrawRectangle(x + 12 + (r - 1) * 40, base - bh, 32, bh, SKYBLUE);
+        DrawText(TextFormat("%d", r), x + 22 + (r - 1) * 40, base + 4, 16, LIGHTGRAY);
     }
-    fwrite(&safeSnakeCount, sizeof(int), 1, fp);
+}
 
-    SnakeOrLadder* current = snakes;
-    for (int i = 0; i < safeSnakeCount; i++)
-    {
-        fwrite(&current->start, sizeof(int), 1, fp);
-        fwrite(&current->end, sizeof(int), 1, fp);
-        current = current->next;
-    }
+static void OnSaved(IoJob* job)
+{
+    if (job->ok) ShowToast(DARKGREEN, TextFormat("Saved %s", job->file));
+    else ShowToast(RED, TextFormat("Could not save %s", job->file));
+}
 
-    SavePlayer buf[4];
-    for (int i = 0; i < playerCount; ++i)
+//at is the state the game is in (or goes back to after the save prompt)
+static void CaptureState(SaveState* s, GameState at)
+{
+    memset(s, 0, sizeof(*s));
+    s->game = game;
+    for (int i = 0; i < game.playerCount; ++i)
     {
-        buf[i].position = players[i].position;
-        buf[i].color = players[i].color;
-        strcpy(buf[i].name, players[i].name);
-        buf[i].playerNumber = players[i].playerNumber;
+        strcpy(s->players[i].name, players[i].name);
+        s->players[i].color[0] = players[i].color.r;
+        s->players[i].color[1] = players[i].color.g;
+        s->players[i].color[2] = players[i].color.b;
+        s->players[i].color[3] = players[i].color.a;
+        s->players[i].playerNumber = players[i].playerNumber;
     }
-    fwrite(buf, sizeof(SavePlayer),
-        (size_t)playerCount, fp);
 
-    fclose(fp);
+    //mid turn saves keep the dice and the walk so the load picks up right there
+    s->phase = SAVE_PHASE_TURN;
+    if (at == DICE_ROLLING) s->phase = SAVE_PHASE_ROLLED;
+    if (at == PIECE_MOVING) s->phase = SAVE_PHASE_MOVING;
+    s->dieA = dieA;
+    s->dieB = dieB;
+    s->diceTotal = diceTotal;
+    s->walk = walk;
 }
 
-static int LoadBinary(const char* fn)
+static void SaveBinary(const char* fn)
 {
-    FILE* fp = fopen(fn, "rb");
-    if (!fp) { 
-        perror("load"); 
-    return 0; }
-
-    if (fread(&playerCount, sizeof(int), 1, fp) != 1) {
-        goto bad;
+    IoJob* job = IoNew(IO_SAVE, OnSaved);
+    if (!job) {
+        ShowToast(RED, "Out of memory, game not saved");
+        return;
     }
-    fread(&currentPlayer, sizeof(int), 1, fp);
-    fread(&diceCount, sizeof(int), 1, fp);
-    fread(&gMode, sizeof(int), 1, fp);
+    snprintf(job->file, sizeof(job->file), "%s", fn);
+    CaptureState(&job->state, returnState);
+    IoSubmit(job); //the worker writes it, the game keeps going
+    JournalSave(&journal, fn);
+}
 
-    int fileSnakeCount = 0;
-    fread(&fileSnakeCount, sizeof(int), 1, fp);
-    if (fileSnakeCount < 0 || fileSnakeCount > MAX_SNAKES) {
-        goto bad;
+static void OnJournalWritten(IoJob* job)
+{
+    if (!job->ok && job->first) ShowToast(RED, TextFormat("Could not write %s", job->file));
+}
+
+//journal flushes become append jobs so the disk never stalls a frame
+static void JournalToIo(const char* path, const uint8_t* data, size_t len, bool first, void* ctx)
+{
+    (void)ctx;
+    IoJob* job = IoNew(IO_APPEND, OnJournalWritten);
+    if (!job || !(job->data = (uint8_t*)malloc(len))) {
+        free(job);
+        return;
     }
-    snakeCount = fileSnakeCount;      
+    snprintf(job->file, sizeof(job->file), "%s", path);
+    memcpy(job->data, data, len);
+    job->len = len;
+    job->first = first;
+    IoSubmit(job);
+}
+
+//a new or loaded game, the one before goes into the session's counts
+static void StartStats(void)
+{
+    StatsAdd(&liveStats[0].s, &liveStats[1].s);
+    memset(&liveStats[1].s, 0, sizeof(Stats));
+    chaosFrom = game.board.snakeCount;
+}
+
+static void CountMove(MoveInfo m, bool bounced)
+{
+    StatsMove(&liveStats[1].s, game.board.tiles, m.landed, m.to, bounced, StatsChaosHead(&game.board, chaosFrom, m.landed));
+    if (game.winner >= 0) StatsGameEnd(&liveStats[1].s, game.winner, game.globalTurn);
+}
 
-    snakes = (SnakeOrLadder*)malloc(sizeof(SnakeOrLadder));
-    SnakeOrLadder* current = snakes;
-    for (int i = 0; i < snakeCount; i++)
+static void BeginJournal(void)
+{
+    SaveState s;
+    CaptureState(&s, state);
+    JournalBegin(&journal, TextFormat("journal_%016llx.slj", (unsigned long long)game.seed), &s, JournalToIo, NULL);
+}
+
+//the worker decoded and checked everything already, the running game is only touched here
+static void ApplySave(const SaveState* s)
+{
+    game = s->game;
+    for (int i = 0; i < game.playerCount; ++i)
     {
-        if (fread(&current->start, sizeof(int), 1, fp) != 1) {
-            goto bad;
-        }
-        if (fread(&current->end, sizeof(int), 1, fp) != 1) {
-            goto bad;
-        }
-        if (i < snakeCount - 1)
-        {
-            current->next = (SnakeOrLadder*)malloc(sizeof(SnakeOrLadder));
-            current = current->next;
-        }
-        else
-        {
-            current->next = NULL;
-        }
+        strcpy(players[i].name, s->players[i].name);
+        players[i].color = (Color){ s->players[i].color[0], s->players[i].color[1], s->players[i].color[2], s->players[i].color[3] };
+        players[i].playerNumber = s->players[i].playerNumber;
+        players[i].token = tokenSrc[i];
+    }
+    dieA = s->dieA;
+    dieB = s->dieB;
+    diceTotal = s->diceTotal;
+    walk = s->walk;
+    FitCamera();
+    animFaceA = 1;
+    animFaceB = 1;
+    diceAnimTimer = 0.f;
+    stepTimer = 0.f;
+
+    if (s->phase == SAVE_PHASE_ROLLED) {
+        diceAnimating = true;
+        state = DICE_ROLLING;
     }
+    else if (s->phase == SAVE_PHASE_MOVING) {
+        state = PIECE_MOVING;
+    }
+    else {
+        state = (game.winner >= 0) ? GAME_OVER : GAME_ACTIVE;
+    }
+}
 
-    if (playerCount < 1 || playerCount > 4) {
-        goto bad;
+static void OnLoaded(IoJob* job)
+{
+    loadInFlight = false;
+    if (!job->ok) {
+        ShowToast(RED, TextFormat("Could not load %s", job->file));
+        return;
     }
+    if (state == LOAD_BROWSER) {
+        ApplySave(&job->state);
+        UndoClear(&undo);
+        BeginJournal(); //a loaded game gets a journal of its own from here on
+        StartStats();
+        ShowToast(DARKGREEN, TextFormat("Loaded %s", job->file));
+    }
+}
 
-    SavePlayer buf[4];
-    if (fread(buf, sizeof(SavePlayer), (size_t)playerCount, fp) != (size_t)playerCount) {
-        goto bad;
+//undo and redo only happen between turns, the journal gets the jump as a rewind
+static void StepHistory(bool forward)
+{
+    SaveState now, to;
+    CaptureState(&now, GAME_ACTIVE);
+    if (!(forward ? UndoForward(&undo, &now, &to) : UndoBack(&undo, &now, &to))) {
+        ShowToast(DARKGRAY, forward ? "Nothing to redo" : "Nothing to undo");
+        return;
     }
+    ApplySave(&to);
+    JournalRewind(&journal, &to);
+}
 
-    fclose(fp);
+//before anything changes the game in a turn, so it can be taken back
+static void RememberTurn(void)
+{
+    SaveState before;
+    CaptureState(&before, GAME_ACTIVE);
+    UndoPush(&undo, &before);
+}
 
-    for (int i = 0; i < playerCount; ++i)
-    {
-        players[i].position = buf[i].position;
-        players[i].color = buf[i].color;
-        strcpy(players[i].name, buf[i].name);
-        players[i].playerNumber = buf[i].playerNumber;
-        players[i].token = tokenTex[i];
+static bool IsBot(int seat)
+{
+    return (botSeats >> seat & 1) != 0;
+}
+
+//a bot seat's chaos snake, through the same calls the placing screen makes
+static void BotPlace(void)
+{
+    botAsked = game.globalTurn;
+    int head = BotChooseHead(&bot, &game);
+    if (!head) {
+        return;
+    }
+    SaveState before;
+    CaptureState(&before, GAME_ACTIVE);
+    if (GamePlaceSnake(&game, head) == PLACE_OK) {
+        UndoPush(&undo, &before);
+        JournalPlace(&journal, head, game.board.snakes[game.board.snakeCount - 1].end);
+        StatsPlaced(&liveStats[1].s);
+        ShowToast(DARKGREEN, TextFormat("%s put a snake on %d", players[game.currentPlayer].name, head));
     }
-    return 1;
+}
 
-bad:
-    fclose(fp);
-    fprintf(stderr, "Something went wrong error message: %s\n", fn);
-    return 0;
+//true once a bot seat has waited its pause, standing in for its click
+static bool BotGo(void)
+{
+    if (!IsBot(game.currentPlayer) || turbo) {
+        botWait = 0.f;
+        return false;
+    }
+    botWait += GetFrameTime();
+    if (botWait < BOT_PAUSE) {
+        return false;
+    }
+    botWait = 0.f;
+    return true;
 }
 
-static void LoadList(void)
+static Rectangle BotToggle(int seat)
 {
-    //raylib LoadDirectory
-    FilePathList list = LoadDirectoryFilesEx(".", ".sav", false);
-    loadCount = 0;
+    return (Rectangle){ 1200.f + 170.f * (float)seat, 250.f, 160.f, 44.f };
+}
+
+static void RequestList(bool sync);
 
-    for (unsigned int i = 0; i < list.count && loadCount < 64; i++) {
-        strcpy(loadNames[loadCount++], list.paths[i]);
+static void OnListed(IoJob* job)
+{
+    listInFlight = false;
+    memcpy(browserRows, job->rows, sizeof(IoRow) * (size_t)job->rowCount);
+    browserRowCount = job->rowCount;
+    browserPageStart = job->skip;
+    browserTotal = job->total;
+    if (browserSel >= browserTotal) browserSel = browserTotal ? browserTotal - 1 : 0;
+    if (listWanted) {
+        listWanted = false;
+        RequestList(false);
     }
-    UnloadDirectoryFiles(list);
 }
 
-static int ChooseSave(char* out)
+//one list job at a time, anything asked for meanwhile folds into a single follow up
+static void RequestList(bool sync)
 {
-    LoadList();
-    if (!loadCount) { puts("(no save files)"); return 0; }
+    if (listInFlight) {
+        listWanted = true;
+        return;
+    }
+    IoJob* job = IoNew(IO_LIST, OnListed);
+    if (!job) {
+        return;
+    }
+    job->sync = sync;
+    job->sort = browserSort;
+    job->descending = browserSort != CATALOG_BY_NAME;
+    strcpy(job->text, browserText);
+    job->skip = browserFirst > IO_PAGE / 4 ? browserFirst - IO_PAGE / 4 : 0; //some rows either side for scrolling
+    listInFlight = true;
+    IoSubmit(job);
+}
 
-    puts("\nSave files:");
-    for (int i = 0; i < loadCount; i++)
-        printf("  %d) %s\n", i + 1, GetFileName(loadNames[i]));
+static void OpenBrowser(void)
+{
+    browserSel = browserFirst = 0;
+    browserRowCount = browserTotal = 0;
+    state = LOAD_BROWSER;
+    RequestList(true); //only saves that changed since the last look get opened
+}
 
-    printf("Choose #: ");
-    int sel = 0;
-    if (scanf("%d", &sel) != 1 || sel < 1 || sel > loadCount)
-    {
-        while (getchar() != '\n'); return 0;
-    }
+static Rectangle BrowserRow(int r)
+{
+    return (Rectangle){ SCREEN_WIDTH / 2 - 640, 300 + r * 52, 1280, 48 };
+}
 
-    strcpy(out, loadNames[sel - 1]);
-    while (getchar() != '\n');
-    return 1;
+static const IoRow* BrowserRowAt(int i)
+{
+    if (i < browserPageStart || i >= browserPageStart + browserRowCount) {
+        return NULL;
+    }
+    return &browserRows[i - browserPageStart];
 }
 
 
-static void DrawBoard(void)
+//the link's bounding box against the visible part of the world
+static bool LinkVisible(SnakeOrLadder l, Vector2 lo, Vector2 hi)
 {
-    //board initialization
-    for (int r = 0; r < BOARD_SIZE; r++)
-        for (int c = 0; c < BOARD_SIZE; c++)
-        {
-            //Checks Color If ODD: WHITE IF EVEN: LIGHTGRAY
-            Color cell = ((r + c) & 1) ? WHITE : LIGHTGRAY;
-            DrawRectangle(BOARD_OFFSET_X + c * CELL_SIZE, BOARD_OFFSET_Y + r * CELL_SIZE, CELL_SIZE, CELL_SIZE, cell);
-            char t[4];
-            sprintf(t, "%d", boardNumbers[r][c]);
-            DrawText(t, BOARD_OFFSET_X + c * CELL_SIZE + 8, BOARD_OFFSET_Y + r * CELL_SIZE + 6, 18, DARKGRAY);
-            DrawRectangleLines(BOARD_OFFSET_X + c * CELL_SIZE,
-                BOARD_OFFSET_Y + r * CELL_SIZE,
-                CELL_SIZE, CELL_SIZE, BLACK);
+    Vector2 a = CellPos(l.start), b = CellPos(l.end);
+    return fmaxf(a.x, b.x) >= lo.x && fminf(a.x, b.x) <= hi.x && fmaxf(a.y, b.y) >= lo.y && fminf(a.y, b.y) <= hi.y;
+}
+
+static void RedrawBoardLayer(void)
+{
+    //same camera, but the layer's corner is the view window's corner
+    Camera2D lc = camera;
+    lc.offset.x -= BOARD_OFFSET_X;
+    lc.offset.y -= BOARD_OFFSET_Y;
+    Vector2 lo = GetScreenToWorld2D((Vector2){ 0, 0 }, lc);
+    Vector2 hi = GetScreenToWorld2D((Vector2){ VIEW_SIZE, VIEW_SIZE }, lc);
+    int c0 = (int)floorf(lo.x / CELL_SIZE), c1 = (int)floorf(hi.x / CELL_SIZE);
+    int r0 = (int)floorf(lo.y / CELL_SIZE), r1 = (int)floorf(hi.y / CELL_SIZE);
+    if (c0 < 0) c0 = 0;
+    if (r0 < 0) r0 = 0;
+    if (c1 >= geoWidth) c1 = geoWidth - 1;
+    if (r1 >= geoHeight) r1 = geoHeight - 1;
+    float px = CELL_SIZE * camera.zoom; //a cell on screen
+
+    BeginTextureMode(boardLayer);
+    ClearBackground(BLANK);
+    BeginMode2D(lc);
+    if (c0 <= c1 && r0 <= r1) {
+        //Checks Color If ODD: WHITE IF EVEN: LIGHTGRAY, one texel per cell so a million cells are one quad
+        Rectangle src = { (float)c0, (float)r0, (float)(c1 - c0 + 1), (float)(r1 - r0 + 1) };
+        Rectangle dst = { (float)c0 * CELL_SIZE, (float)r0 * CELL_SIZE, src.width * CELL_SIZE, src.height * CELL_SIZE };
+        DrawTexturePro(checker, src, dst, (Vector2){ 0, 0 }, 0.f, WHITE);
+
+        if (px >= GRID_MIN_PX) {
+            for (int c = c0; c <= c1 + 1; c++) {
+                DrawLineV((Vector2){ (float)c * CELL_SIZE, dst.y }, (Vector2){ (float)c * CELL_SIZE, dst.y + dst.height }, BLACK);
+            }
+            for (int r = r0; r <= r1 + 1; r++) {
+                DrawLineV((Vector2){ dst.x, (float)r * CELL_SIZE }, (Vector2){ dst.x + dst.width, (float)r * CELL_SIZE }, BLACK);
+            }
+        }
+        if (px >= LABEL_MIN_PX) {
+            for (int r = r0; r <= r1; r++)
+                for (int c = c0; c <= c1; c++) {
+                    char t[8];
+                    sprintf(t, "%d", cellTile[r * geoWidth + c]);
+                    DrawText(t, c * CELL_SIZE + 8, r * CELL_SIZE + 6, 18, DARKGRAY);
+                }
         }
+    }
 
-    for (SnakeOrLadder* s = snakes; s; s = s->next) {
-        DrawLineEx(CellPos(s->start), CellPos(s->end), 5, RED);
+    //lines stay visible however far out the camera is
+    float thick = fmaxf(5.f, 2.f / camera.zoom);
+    for (int i = 0; i < game.board.snakeCount; i++) {
+        if (!LinkVisible(game.board.snakes[i], lo, hi)) continue;
+        DrawLineEx(CellPos(game.board.snakes[i].start), CellPos(game.board.snakes[i].end), thick, RED);
     }
-    for (SnakeOrLadder* l = ladders; l; l = l->next) {
-        DrawLineEx(CellPos(l->start), CellPos(l->end), 5, GREEN);
+    for (int i = 0; i < game.board.ladderCount; i++) {
+        if (!LinkVisible(game.board.ladders[i], lo, hi)) continue;
+        DrawLineEx(CellPos(game.board.ladders[i].start), CellPos(game.board.ladders[i].end), thick, GREEN);
     }
+    EndMode2D();
+    EndTextureMode();
+    boardDrawn = game.board;
+    cameraDrawn = camera;
+    boardLayerValid = true;
+}
+
+static void DrawBoard(void)
+{
+    if (!BuildGeometry(game.board.width, game.board.height)) {
+        DrawText("Out of memory for this board", BOARD_OFFSET_X, BOARD_OFFSET_Y, 30, RED);
+        return;
+    }
+    //the links, counts and size sit in front of the hash slots, comparing them is a few hundred
+    //bytes and catches every way the board can change without hooks in each one
+    if (!boardLayerValid || memcmp(&boardDrawn, &game.board, offsetof(Board, probe)) != 0 ||
+        memcmp(&cameraDrawn, &camera, sizeof(camera)) != 0) {
+        RedrawBoardLayer();
+    }
+    //render textures come out upside down, the negative height flips it back
+    Rectangle src = { 0, 0, (float)boardLayer.texture.width, -(float)boardLayer.texture.height };
+    DrawTextureRec(boardLayer.texture, src, (Vector2) { BOARD_OFFSET_X, BOARD_OFFSET_Y }, WHITE);
 }
 static void DrawPlayers(void)
 {
-    for (int i = 0; i < playerCount; i++)
+    BeginScissorMode(BOARD_OFFSET_X, BOARD_OFFSET_Y, VIEW_SIZE, VIEW_SIZE);
+    for (int i = 0; i < game.playerCount; i++)
     {
         /* 2*PI*i/player_count 
            *0.6f <<<--- to center them
         */
-        Vector2 p = CellPos(players[i].position); //gets pixel coordinates
+        Vector2 p = CellPos(game.position[i]); //gets world coordinates
+        if (state == PIECE_MOVING && i == game.currentPlayer) {
+            //part way to the tile the next step lands on
+            TokenWalk peek = walk;
+            int next = game.position[i];
+            WalkStep(&peek, &next, game.board.tiles);
+            float a = (stepTimer + tickAccum) / STEP_DELAY;
+            if (a > 1.f) a = 1.f;
+            Vector2 q = CellPos(next);
+            p.x += (q.x - p.x) * a;
+            p.y += (q.y - p.y) * a;
+        }
         float r = CELL_SIZE / 4.f; // radial distance to make sure it does not go outside bcz 80/4 is 20 and 4 players max so wow
-        p.x += cosf(2 * PI * i / playerCount) * r * 0.6f; //logic from before token images for cell position
-        p.y += sinf(2 * PI * i / playerCount) * r * 0.6f; 
-        DrawTexture(players[i].token, p.x - players[i].token.width / 2, p.y - players[i].token.height / 2, WHITE);
+        p.x += cosf(2 * PI * i / game.playerCount) * r * 0.6f; //logic from before token images for cell position
+        p.y += sinf(2 * PI * i / game.playerCount) * r * 0.6f; 
+        p = GetWorldToScreen2D(p, camera);
+        //tokens keep their size so they can still be found with the whole board in view
+        if (p.x < BOARD_OFFSET_X - CELL_SIZE || p.x > BOARD_OFFSET_X + VIEW_SIZE + CELL_SIZE ||
+            p.y < BOARD_OFFSET_Y - CELL_SIZE || p.y > BOARD_OFFSET_Y + VIEW_SIZE + CELL_SIZE) {
+            continue;
+        }
+        DrawTextureRec(atlas.texture, players[i].token, (Vector2){ p.x - players[i].token.width / 2, p.y - players[i].token.height / 2 }, WHITE);
     }
+    EndScissorMode();
+}
+
+//same players and settings on a fresh seed
+static void Rematch(void)
+{
+    Game last = game;
+    GameInit(&game, last.playerCount, last.diceCount, last.mode, NewSeed());
+    BoardInit(&game.board, last.board.width, last.board.height);
+    dieA = dieB = diceTotal = 1;
+    UndoClear(&undo);
+    BeginJournal();
+    StartStats();
+    state = GAME_ACTIVE;
 }
 
+//whole turns through the same rules and journal calls as clicking would make, chaos snakes
+//aren't placed. a move that's already on screen is finished first
+static void TurboTurns(void)
+{
+    if (state == GAME_OVER) {
+        turboWait += GetFrameTime();
+        if (turboWait >= TURBO_REMATCH) {
+            turboWait = 0.f;
+            Rematch();
+        }
+        return;
+    }
+    if (state != GAME_ACTIVE && state != DICE_ROLLING && state != PIECE_MOVING) {
+        return;
+    }
+    if (state == DICE_ROLLING) {
+        WalkBegin(&walk, diceTotal);
+    }
+    if (state != GAME_ACTIVE) {
+        int pos = game.position[game.currentPlayer];
+        while (!WalkStep(&walk, &pos, game.board.tiles));
+        CountMove(GameFinishMove(&game, pos), walk.bouncing);
+        JournalTurnDone(&journal, &game);
+    }
+    for (int t = 0; t < TURBO_TURNS && game.winner < 0; t++) {
+        diceTotal = RollDice(&game, &dieA, &dieB);
+        JournalRoll(&journal, dieA, dieB);
+        StatsRoll(&liveStats[1].s, diceTotal);
+        MoveInfo m = GameMove(&game, diceTotal);
+        CountMove(m, m.bounced);
+        JournalTurnDone(&journal, &game);
+    }
+    diceAnimating = false;
+    if (game.winner >= 0) {
+        JournalEnd(&journal, false);
+        state = GAME_OVER;
+    }
+    else {
+        state = GAME_ACTIVE;
+    }
+}
+
+//rects out of the atlas once it's up
 static void LoadAssets(void)
 {
-    bg = makeBtn("assets/buttons/background.png", SCREEN_WIDTH / 2 - 960, 0);
-    titleB = makeBtn("assets/buttons/title.png", SCREEN_WIDTH / 2 - 400, 140);
-    startB = makeBtn("assets/buttons/start_btn.png", SCREEN_WIDTH / 2 - 140, 620);
-    loadB = makeBtn("assets/buttons/load_btn.png", SCREEN_WIDTH / 2 - 140, 725);
-    exitB = makeBtn("assets/buttons/exit_btn.png", SCREEN_WIDTH / 2 - 140, 825);
+    bg = makeBtn("buttons/background.png", SCREEN_WIDTH / 2 - 960, 0);
+    titleB = makeBtn("buttons/title.png", SCREEN_WIDTH / 2 - 400, 140);
+    startB = makeBtn("buttons/start_btn.png", SCREEN_WIDTH / 2 - 140, 620);
+    loadB = makeBtn("buttons/load_btn.png", SCREEN_WIDTH / 2 - 140, 725);
+    exitB = makeBtn("buttons/exit_btn.png", SCREEN_WIDTH / 2 - 140, 825);
 
-    twoP = makeBtn("assets/buttons/2p.png", 1062, 304);
-    threeP = makeBtn("assets/buttons/3p.png", 1360, 304);
-    fourP = makeBtn("assets/buttons/4p.png", 1657, 304);
+    twoP = makeBtn("buttons/2p.png", 1062, 304);
+    threeP = makeBtn("buttons/3p.png", 1360, 304);
+    fourP = makeBtn("buttons/4p.png", 1657, 304);
 
-    oneDie = makeBtn("assets/buttons/one_die_btn.png", 1064, 468);
-    twoDice = makeBtn("assets/buttons/two_dice_btn.png", 1362, 468);
+    oneDie = makeBtn("buttons/one_die_btn.png", 1064, 468);
+    twoDice = makeBtn("buttons/two_dice_btn.png", 1362, 468);
 
-    classicBtn = makeBtn("assets/buttons/Classic_Mode_btn.png", 1064, 636);
-    chaosBtn = makeBtn("assets/buttons/Chaos_Mode_btn.png", 1361, 636);
+    classicBtn = makeBtn("buttons/Classic_Mode_btn.png", 1064, 636);
+    chaosBtn = makeBtn("buttons/Chaos_mode_btn.png", 1361, 636);
 
-    playB = makeBtn("assets/buttons/play_btn.png", SCREEN_WIDTH / 2 - 120, 760);
+    playB = makeBtn("buttons/play_btn.png", SCREEN_WIDTH / 2 - 120, 760);
 
-    rollB = makeBtn("assets/buttons/roll_btn.png", SCREEN_WIDTH - 300, SCREEN_HEIGHT - 150);
-    throwB = makeBtn("assets/buttons/throw_btn.png", SCREEN_WIDTH - 300, SCREEN_HEIGHT - 150);
-    leaveB = makeBtn("assets/buttons/exit_btn.png", 50, 400);
-    saveB = makeBtn("assets/buttons/save_btn.png", 50, 520);
-    placeSnakeB = makeBtn("assets/buttons/place_snake_btn.png", SCREEN_WIDTH - 320, 260);
+    rollB = makeBtn("buttons/roll_btn.png", SCREEN_WIDTH - 300, SCREEN_HEIGHT - 150);
+    throwB = makeBtn("buttons/throw_btn.png", SCREEN_WIDTH - 300, SCREEN_HEIGHT - 150);
+    leaveB = makeBtn("buttons/exit_btn.png", 50, 400);
+    saveB = makeBtn("buttons/save_btn.png", 50, 520);
+    placeSnakeB = makeBtn("buttons/place_snake_btn.png", SCREEN_WIDTH - 320, 260);
 
     for (int i = 0; i < 6; i++) { 
         char p[64];
-        sprintf(p, "assets/dice/dice%d.png", i + 1);
-        diceTex[i] = LoadTexture(p);
+        sprintf(p, "dice/dice%d.png", i + 1);
+        diceSrc[i] = AtlasRect(&atlas, p);
     }
     for (int i = 0; i < 4; i++) {
         char p[64];
-        sprintf(p, "assets/tokens/token%d.png", i + 1);
-        tokenTex[i] = LoadTexture(p);
+        sprintf(p, "tokens/token%d.png", i + 1);
+        tokenSrc[i] = AtlasRect(&atlas, p);
+        players[i].token = tokenSrc[i];
     }
 }
 
-int main(void)
+int main(int argc, char** argv)
 {
+    if (argc > 1 && strcmp(argv[1], "atlas") == 0) {
+        return AtlasTool(argc, argv, "assets", uiImages, UI_IMAGES);
+    }
+    if (argc > 1) {
+        return RunCli(argc, argv);
+    }
+
     InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Snakes & Ladders");
     SetTargetFPS(60);
 
-    srand((unsigned)time(NULL));
-    InitBoardNumbers();
-    InitSnakesLadders();
-    LoadAssets();
+    AtlasLoaderStart(&loader, ATLAS_PNG, ATLAS_MANIFEST, "assets", uiImages, UI_IMAGES);
+    boardLayer = LoadRenderTexture(VIEW_SIZE, VIEW_SIZE);
+    Image cells = GenImageChecked(2, 2, 1, 1, LIGHTGRAY, WHITE);
+    checker = LoadTextureFromImage(cells);
+    UnloadImage(cells);
+    SetTextureWrap(checker, TEXTURE_WRAP_REPEAT);
     ResetGame();
-    for (int i = 0; i < 4; i++) {
-        players[i].token = tokenTex[i];
-    }
+    IoStart(".");
+    BotInit(&bot, BOT_DEFAULT_MS, BOT_MAX_DEPTH, 0);
 
     while (!WindowShouldClose())
     {
+        ProfFrame((int)state);
+        if (IsKeyPressed(KEY_F3)) profOverlay = !profOverlay;
+        if (IsKeyPressed(KEY_F4)) {
+            if (ProfCsvActive()) {
+                ProfCsvStop();
+                ShowToast(DARKGREEN, "Frame profile saved");
+            }
+            else {
+                char path[64];
+                sprintf(path, "profile_%lld.csv", (long long)time(NULL));
+                if (ProfCsvStart(path)) ShowToast(DARKGREEN, TextFormat("Writing frame times to %s", path));
+                else ShowToast(RED, TextFormat("Could not write %s", path));
+            }
+        }
+        ProfSwitch(PROF_IO);
+        IoPoll(); //finished saves, loads and listings land here, between frames
+        ProfSwitch(PROF_INPUT);
+
+        tickAccum += GetFrameTime();
+        int ticks = (int)(tickAccum / TICK);
+        if (ticks > MAX_TICKS) {
+            ticks = MAX_TICKS;
+            tickAccum = 0.f;
+        }
+        else {
+            tickAccum -= ticks * TICK;
+        }
+        if (IsKeyPressed(KEY_F5)) {
+            turbo = !turbo;
+            turboWait = 0.f;
+            ShowToast(DARKGREEN, turbo ? "Turbo on" : "Turbo off");
+        }
+        if (IsKeyPressed(KEY_F6)) statsPanel = !statsPanel;
+        if (turbo) TurboTurns();
+        if (state == GAME_ACTIVE || state == DICE_ROLLING || state == PIECE_MOVING || state == PLACING_SNAKE) {
+            MoveCamera();
+        }
+
         switch (state)
         {
+        case LOADING_ASSETS: {
+            int got = AtlasLoaderPoll(&loader, &atlas);
+            if (got) {
+                if (got < 0) ShowToast(RED, "Could not load the ui images");
+                LoadAssets();
+                state = TITLE_SCREEN;
+            }
+        } break;
+
         case TITLE_SCREEN:
             if (hit(startB)) state = SELECT_PLAYERS;
             if (hit(loadB)) {
-                char p[64];
-                if (ChooseSave(p) && LoadBinary(p)) state = GAME_ACTIVE; 
+                OpenBrowser();
             }
             if (hit(exitB)) { 
+                JournalEnd(&journal, false);
+                IoStop();
                 CloseWindow(); 
                 exit(0); 
             }
             break;
 
         case SELECT_PLAYERS:
-            if (hit(twoP)) playerCount = 2;
-            if (hit(threeP)) playerCount = 3;
-            if (hit(fourP)) playerCount = 4;
+            if (hit(twoP)) game.playerCount = 2;
+            if (hit(threeP)) game.playerCount = 3;
+            if (hit(fourP)) game.playerCount = 4;
+
+            if (hit(oneDie)) game.diceCount = 1;
+            if (hit(twoDice)) game.diceCount = 2;
 
-            if (hit(oneDie)) diceCount = 1;
-            if (hit(twoDice)) diceCount = 2;
+            if (hit(classicBtn)) game.mode = MODE_CLASSIC;
+            if (hit(chaosBtn)) game.mode = MODE_CHAOS;
 
-            if (hit(classicBtn)) gMode = MODE_CLASSIC;
-            if (hit(chaosBtn)) gMode = MODE_CHAOS;
+            for (int i = 0; i < game.playerCount; i++) {
+                if (CheckCollisionPointRec(GetMousePosition(), BotToggle(i)) && IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) botSeats ^= 1u << i;
+            }
+            botSeats &= (1u << game.playerCount) - 1; //fewer players drops the bots past the last seat
+
+            {
+                int sizes = (int)(sizeof(boardSizes) / sizeof(boardSizes[0]));
+                if (IsKeyPressed(KEY_RIGHT)) boardPick = (boardPick + 1) % sizes;
+                if (IsKeyPressed(KEY_LEFT)) boardPick = (boardPick + sizes - 1) % sizes;
+            }
 
             if (hit(playB)) { 
+                BoardInit(&game.board, boardSizes[boardPick][0], boardSizes[boardPick][1]);
+                FitCamera();
                 state = ENTER_NAMES; 
                 nameIdx = 0; 
                 nameLen = 0; 
@@ -568,8 +1042,10 @@ int main(void)
                 players[nameIdx].name[31] = '\0';
                 nameIdx++; nameLen = 0;
                 nameBuf[0] = '\0';
-                if (nameIdx == playerCount) {
+                if (nameIdx == game.playerCount) {
                     state = GAME_ACTIVE;
+                    BeginJournal();
+                    StartStats();
                 }
             }
             if (IsKeyPressed(KEY_ESCAPE)) {
@@ -579,8 +1055,18 @@ int main(void)
         } break;
 
         case GAME_ACTIVE:
-            if (hit(rollB)) {
-                diceTotal = RollDice();      
+            if (IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL)) {
+                if (IsKeyPressed(KEY_Z)) StepHistory(false);
+                if (IsKeyPressed(KEY_Y)) StepHistory(true);
+            }
+            if (game.mode == MODE_CHAOS && game.canPlace[game.currentPlayer] && IsBot(game.currentPlayer) && botAsked != game.globalTurn) {
+                BotPlace();
+            }
+            if (hit(rollB) || BotGo()) {
+                RememberTurn();
+                diceTotal = RollDice(&game, &dieA, &dieB);
+                JournalRoll(&journal, dieA, dieB);
+                StatsRoll(&liveStats[1].s, diceTotal);
                 diceAnimating = true;
                     diceAnimTimer = 0.f;
                 animFaceA = 1;
@@ -588,7 +1074,7 @@ int main(void)
                 state = DICE_ROLLING;
             }
 
-            if (gMode == MODE_CHAOS && canPlace[currentPlayer] && hit(placeSnakeB))
+            if (game.mode == MODE_CHAOS && game.canPlace[game.currentPlayer] && hit(placeSnakeB))
             {
                 tileLen = 0; tileBuf[0] = '\0';
                 state = PLACING_SNAKE;
@@ -605,32 +1091,32 @@ int main(void)
                 state = TITLE_SCREEN; 
             }
             if (hit(exitB)) {
+                JournalEnd(&journal, false);
+                IoStop();
                 CloseWindow();
                 return 0;
             }
             break;
 
         case DICE_ROLLING:
-            if (diceAnimating) {
-                diceAnimTimer += GetFrameTime();
+            for (int t = 0; t < ticks && diceAnimating; t++) {
+                diceAnimTimer += TICK;
                 if (diceAnimTimer >= DICE_FRAME) {
                     diceAnimTimer -= DICE_FRAME;
                     animFaceA = (animFaceA % 6) + 1;
-                    if (diceCount == 2) {
+                    if (game.diceCount == 2) {
                         animFaceB = (animFaceB % 6) + 1; 
                     }
                 }
             }
-            if (hit(throwB)) {
+            if (hit(throwB) || BotGo()) {
                 diceAnimating = false;
                 animFaceA = dieA;
-                if (diceCount == 2) {
+                if (game.diceCount == 2) {
                     animFaceB = dieB;
                 }
-                stepsRemaining = diceTotal;
-                stepDir = 1;
+                WalkBegin(&walk, diceTotal);
                 stepTimer = 0.f;
-                bouncing = false;
                 state = PIECE_MOVING;
             }
             if (hit(saveB)) {
@@ -644,52 +1130,26 @@ int main(void)
                 state = TITLE_SCREEN; 
             }
             if (hit(exitB)) {
+                JournalEnd(&journal, false);
+                IoStop();
                 CloseWindow();
                 return 0;
             }
             break;
 
         case PIECE_MOVING:
-            stepTimer += GetFrameTime();
-            if (stepTimer >= STEP_DELAY) {
-                stepTimer = 0.f;
-                players[currentPlayer].position += stepDir;
-                stepsRemaining--;
-
-                if (!bouncing && stepDir == 1 && players[currentPlayer].position > 100)
-                {
-                    int overflow = players[currentPlayer].position - 100;  
-                    players[currentPlayer].position = 100;                 
-                    stepsRemaining += overflow;      
-                    stepDir  = -1;          
-                    bouncing = true;
-                    continue;      
-                }
-
-                if (stepsRemaining == 0) {
-             
-                    bouncing = false;
-                    stepDir = 1;
-                    players[currentPlayer].position = Slide(players[currentPlayer].position);
-
-                    personalTurn[currentPlayer]++;
-                    globalTurn++;
-
-                    if (gMode == MODE_CHAOS && personalTurn[currentPlayer] == 2) {
-                        personalTurn[currentPlayer] = 0;
-                        if (snakeCount < MAX_SNAKES) {
-                            canPlace[currentPlayer] = true;
-                        }
-                    }
-
-                    if (players[currentPlayer].position == 100) {
-                        winnerIdx = currentPlayer;
-                        state = GAME_OVER;
-                    }
-                    else {
-                        currentPlayer = (currentPlayer + 1) % playerCount;
-                        state = GAME_ACTIVE;
-                    }
+            for (int t = 0; t < ticks && state == PIECE_MOVING; t++) {
+                stepTimer += TICK;
+                if (stepTimer < STEP_DELAY) continue;
+                stepTimer -= STEP_DELAY;
+                int* pos = &game.position[game.currentPlayer];
+
+                //bounce and end of turn rules live in game.c
+                if (WalkStep(&walk, pos, game.board.tiles)) {
+                    CountMove(GameFinishMove(&game, *pos), walk.bouncing);
+                    JournalTurnDone(&journal, &game);
+                    if (game.winner >= 0) JournalEnd(&journal, false);
+                    state = (game.winner >= 0) ? GAME_OVER : GAME_ACTIVE;
                 }
             }
             if (hit(saveB)) {
@@ -708,45 +1168,46 @@ int main(void)
         {
             int ch = GetCharPressed();
             while (ch > 0) {
-                if (ch >= '0' && ch <= '9' && tileLen < 3) { 
+                if (ch >= '0' && ch <= '9' && tileLen < 7) { 
                     tileBuf[tileLen++] = (char)ch;
                     tileBuf[tileLen] = '\0';
                 }
                 ch = GetCharPressed();
             }
             if (IsKeyPressed(KEY_BACKSPACE) && tileLen > 0) tileBuf[--tileLen] = '\0';
+            int picked = IsMouseButtonPressed(MOUSE_LEFT_BUTTON) ? TileAt(GetMousePosition()) : 0;
+            if (picked) {
+                tileLen = snprintf(tileBuf, sizeof(tileBuf), "%d", picked); //clicking a tile fills it in
+            }
             if ((IsKeyPressed(KEY_ENTER) || hit(placeSnakeB)) && tileLen > 0) {
-                int head = atoi(tileBuf);
-                if (head > 1 && head < 100 && snakeCount < MAX_SNAKES && !TileOccupied(head)) 
+                SaveState before;
+                CaptureState(&before, GAME_ACTIVE);
+                PlaceResult placed = GamePlaceSnake(&game, atoi(tileBuf));
+                if (placed == PLACE_OK) 
                 {
-                    int tail;
-                    do {
-                        tail = head - GetRandomValue(5, 20);
-                        if (tail < 1) tail = 1;
-                    } while (TileOccupied(tail));
-
-                    PushLink(&snakes, head, tail);
-                    snakeCount++;
-                    canPlace[currentPlayer] = false;
+                    UndoPush(&undo, &before);
+                    JournalPlace(&journal, atoi(tileBuf), game.board.snakes[game.board.snakeCount - 1].end);
+                    StatsPlaced(&liveStats[1].s);
                     state = GAME_ACTIVE;
                 }
-                else if (TileOccupied(head)) {
-                    DrawText("That tile is already occupied", 40, 80, 24, RED);
-                    EndDrawing();
-                    WaitTime(0.6f);
-                    BeginDrawing();
+                else if (placed == PLACE_OCCUPIED) {
+                    ShowToast(RED, "That tile is already occupied");
+                }
+                else if (placed == PLACE_NO_TAIL) {
+                    ShowToast(RED, "No free tile below that head for the tail");
                 }
-                else if (head > 1 && head <100 && snakeCount>MAX_SNAKES) {
-                    canPlace[currentPlayer] = false;
-                    DrawText("YOU HAVE REACHED THE MAX SNAKESSSSS!", 40, 80, 24, RED);
-                    EndDrawing();
-                    WaitTime(0.6f);
-                    BeginDrawing();
+                else if (placed == PLACE_BAD_TILE) {
+                    ShowToast(RED, TextFormat("Pick a head tile between 2 and %d", game.board.tiles - 1));
+                }
+                else if (placed == PLACE_LIMIT) {
+                    ShowToast(RED, "YOU HAVE REACHED THE MAX SNAKESSSSS!");
+                    JournalSkip(&journal);
                     state = GAME_ACTIVE;
                 }
             }
             if (IsKeyPressed(KEY_ESCAPE)) {
-                canPlace[currentPlayer] = false;
+                game.canPlace[game.currentPlayer] = false;
+                JournalSkip(&journal);
                 state = GAME_ACTIVE;
             }
         } break;
@@ -774,6 +1235,74 @@ int main(void)
             }
         } break;
 
+        case LOAD_BROWSER:
+        {
+            int ch = GetCharPressed();
+            bool refilter = false;
+            while (ch > 0) {
+                if (ch > 32 && ch <= 126 && browserTextLen < 31) {
+                    browserText[browserTextLen++] = (char)ch;
+                    browserText[browserTextLen] = '\0';
+                    refilter = true;
+                }
+                ch = GetCharPressed();
+            }
+            if (IsKeyPressed(KEY_BACKSPACE) && browserTextLen > 0) {
+                browserText[--browserTextLen] = '\0';
+                refilter = true;
+            }
+            if (IsKeyPressed(KEY_TAB)) {
+                browserSort = (CatalogSort)((browserSort + 1) % CATALOG_SORTS);
+                refilter = true;
+            }
+            if (refilter) {
+                browserSel = browserFirst = 0;
+                RequestList(false);
+            }
+
+            int sel = browserSel;
+            if (IsKeyPressed(KEY_DOWN)) sel++;
+            if (IsKeyPressed(KEY_UP)) sel--;
+            if (IsKeyPressed(KEY_PAGE_DOWN)) sel += BROWSER_ROWS;
+            if (IsKeyPressed(KEY_PAGE_UP)) sel -= BROWSER_ROWS;
+            int first = browserFirst - (int)(GetMouseWheelMove() * 3);
+            if (sel != browserSel) {
+                if (sel < first) first = sel;
+                if (sel >= first + BROWSER_ROWS) first = sel - BROWSER_ROWS + 1;
+            }
+            if (first > browserTotal - BROWSER_ROWS) first = browserTotal - BROWSER_ROWS;
+            if (first < 0) first = 0;
+            if (sel >= browserTotal) sel = browserTotal - 1;
+            if (sel < 0) sel = 0;
+            browserSel = sel;
+            if (first != browserFirst) {
+                browserFirst = first;
+                if (!BrowserRowAt(first) || !BrowserRowAt(first + BROWSER_ROWS - 1 < browserTotal ? first + BROWSER_ROWS - 1 : browserTotal - 1)) {
+                    RequestList(false);
+                }
+            }
+
+            bool pick = IsKeyPressed(KEY_ENTER);
+            for (int r = 0; r < BROWSER_ROWS; r++) {
+                if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && CheckCollisionPointRec(GetMousePosition(), BrowserRow(r)) && BrowserRowAt(browserFirst + r)) {
+                    browserSel = browserFirst + r;
+                    pick = true;
+                }
+            }
+            const IoRow* row = BrowserRowAt(browserSel);
+            if (pick && row && !loadInFlight) {
+                IoJob* job = IoNew(IO_LOAD, OnLoaded);
+                if (job) {
+                    strcpy(job->file, row->info.file);
+                    loadInFlight = true;
+                    IoSubmit(job);
+                }
+            }
+            if (IsKeyPressed(KEY_ESCAPE) || hit(leaveB)) {
+                state = TITLE_SCREEN;
+            }
+        } break;
+
         case GAME_OVER:
             if (IsKeyPressed(KEY_ENTER)) {
                 ResetGame();
@@ -782,21 +1311,29 @@ int main(void)
             break;
         }
 
+        ProfSwitch(PROF_HUD);
         BeginDrawing();
         ClearBackground(RAYWHITE);
 
         switch (state)
         {
+        case LOADING_ASSETS: {
+            float done = AtlasLoaderProgress(&loader);
+            DrawText("Loading", SCREEN_WIDTH / 2 - 90, 460, 50, BLACK);
+            DrawRectangleLines(SCREEN_WIDTH / 2 - 300, 540, 600, 30, BLACK);
+            DrawRectangle(SCREEN_WIDTH / 2 - 298, 542, (int)(596 * done), 26, DARKGREEN);
+        } break;
+
         case TITLE_SCREEN:
-            DrawTexture(bg.texture, bg.bounds.x, bg.bounds.y, WHITE);
-            DrawTexture(titleB.texture, titleB.bounds.x, titleB.bounds.y, WHITE);
-            DrawTexture(startB.texture, startB.bounds.x, startB.bounds.y, WHITE);
-            DrawTexture(loadB.texture, loadB.bounds.x, loadB.bounds.y, WHITE);
-            DrawTexture(exitB.texture, exitB.bounds.x, exitB.bounds.y, WHITE);
+            DrawButton(bg);
+            DrawButton(titleB);
+            DrawButton(startB);
+            DrawButton(loadB);
+            DrawButton(exitB);
             break;
 
         case SELECT_PLAYERS:
-            DrawTexture(bg.texture, bg.bounds.x, bg.bounds.y, WHITE);
+            DrawButton(bg);
             DrawText("Setup Game", SCREEN_WIDTH / 2 - 160, 240, 60, BLACK);
 
             DrawText("Players", SCREEN_WIDTH / 2 - 100, 370, 38, DARKBLUE);
@@ -804,70 +1341,128 @@ int main(void)
             DrawText("Mode", SCREEN_WIDTH / 2 - 62, 610, 38, DARKBLUE);
 
             //players
-            DrawTexture(twoP.texture, twoP.bounds.x, twoP.bounds.y, WHITE);
-            DrawTexture(threeP.texture, threeP.bounds.x, threeP.bounds.y, WHITE);
-            DrawTexture(fourP.texture, fourP.bounds.x, fourP.bounds.y, WHITE);
+            DrawButton(twoP);
+            DrawButton(threeP);
+            DrawButton(fourP);
 
             //dice
-            DrawTexture(oneDie.texture, oneDie.bounds.x, oneDie.bounds.y, WHITE);
-            DrawTexture(twoDice.texture, twoDice.bounds.x, twoDice.bounds.y, WHITE);
+            DrawButton(oneDie);
+            DrawButton(twoDice);
 
             //gamemode
-            DrawTexture(classicBtn.texture, classicBtn.bounds.x, classicBtn.bounds.y, WHITE);
-            DrawTexture(chaosBtn.texture, chaosBtn.bounds.x, chaosBtn.bounds.y, WHITE);
+            DrawButton(classicBtn);
+            DrawButton(chaosBtn);
 
             //next
-            DrawTexture(playB.texture, playB.bounds.x, playB.bounds.y, WHITE);
+            DrawButton(playB);
 
             //HIGHLIGHTING things DrawRectangleLinesEx(bounds, thickness, & color)
-            DrawRectangleLinesEx(twoP.bounds, 3, (playerCount == 2) ? RED : BLACK);
-            DrawRectangleLinesEx(threeP.bounds, 3, (playerCount == 3) ? RED : BLACK);
-            DrawRectangleLinesEx(fourP.bounds, 3, (playerCount == 4) ? RED : BLACK);
-            DrawRectangleLinesEx(oneDie.bounds, 3, (diceCount == 1) ? RED : BLACK);
-            DrawRectangleLinesEx(twoDice.bounds, 3, (diceCount == 2) ? RED : BLACK);
-            DrawRectangleLinesEx(classicBtn.bounds, 4, (gMode == MODE_CLASSIC) ? GREEN : BLACK);
-            DrawRectangleLinesEx(chaosBtn.bounds, 4, (gMode == MODE_CHAOS) ? GREEN : BLACK);
+            DrawRectangleLinesEx(twoP.bounds, 3, (game.playerCount == 2) ? RED : BLACK);
+            DrawRectangleLinesEx(threeP.bounds, 3, (game.playerCount == 3) ? RED : BLACK);
+            DrawRectangleLinesEx(fourP.bounds, 3, (game.playerCount == 4) ? RED : BLACK);
+            DrawRectangleLinesEx(oneDie.bounds, 3, (game.diceCount == 1) ? RED : BLACK);
+            DrawRectangleLinesEx(twoDice.bounds, 3, (game.diceCount == 2) ? RED : BLACK);
+            DrawRectangleLinesEx(classicBtn.bounds, 4, (game.mode == MODE_CLASSIC) ? GREEN : BLACK);
+            DrawRectangleLinesEx(chaosBtn.bounds, 4, (game.mode == MODE_CHAOS) ? GREEN : BLACK);
+
+            //bot seats
+            for (int i = 0; i < game.playerCount; i++) {
+                Rectangle r = BotToggle(i);
+                DrawRectangleRec(r, IsBot(i) ? (Color){ 255, 220, 220, 255 } : RAYWHITE);
+                DrawRectangleLinesEx(r, 3, IsBot(i) ? RED : BLACK);
+                DrawText(TextFormat("P%d %s", i + 1, IsBot(i) ? "Bot" : "Human"), (int)r.x + 12, (int)r.y + 10, 26, BLACK);
+            }
+
+            DrawText(TextFormat("Board  < %d x %d >  (Left/Right)", boardSizes[boardPick][0], boardSizes[boardPick][1]),
+                SCREEN_WIDTH / 2 - 230, SCREEN_HEIGHT - 140, 32, DARKBLUE);
 
             //basic exit
-            DrawTexture(leaveB.texture, leaveB.bounds.x, leaveB.bounds.y, WHITE);
+            DrawButton(leaveB);
             break;
 
         case ENTER_NAMES:
-            DrawTexture(bg.texture, bg.bounds.x, bg.bounds.y, WHITE);
+            DrawButton(bg);
             DrawText(TextFormat("Enter name for Player %d", nameIdx + 1),
                 SCREEN_WIDTH / 2 - 280, 380, 48, BLACK);
             DrawRectangleLines(SCREEN_WIDTH / 2 - 300, 460, 600, 70, BLACK);
             DrawText(nameBuf, SCREEN_WIDTH / 2 - 290, 475, 40, BLACK);
             break;
 
+        case LOAD_BROWSER:
+        {
+            DrawButton(bg);
+            const char* sortName[CATALOG_SORTS] = { "newest", "most turns", "name" };
+            DrawText("Load Game", SCREEN_WIDTH / 2 - 150, 140, 60, BLACK);
+            DrawText(TextFormat("Sort: %s (Tab)    Filter: %s_    %d saves", sortName[browserSort], browserText, browserTotal),
+                SCREEN_WIDTH / 2 - 640, 240, 26, DARKGRAY);
+
+            for (int r = 0; r < BROWSER_ROWS; r++) {
+                int i = browserFirst + r;
+                if (i >= browserTotal) break;
+                Rectangle box = BrowserRow(r);
+                DrawRectangleRec(box, Fade(i == browserSel ? SKYBLUE : WHITE, 0.85f));
+                DrawRectangleLinesEx(box, 1, BLACK);
+                const IoRow* row = BrowserRowAt(i);
+                if (!row) {
+                    DrawText("...", box.x + 16, box.y + 12, 24, GRAY);
+                    continue;
+                }
+                time_t when = (time_t)(row->key.mtime / 1000000000LL);
+                char stamp[32];
+                strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M", localtime(&when));
+                char names[4 * 34] = "";
+                for (int p = 0; p < row->key.playerCount; p++) {
+                    if (p) strcat(names, ", ");
+                    strcat(names, row->info.names[p]);
+                }
+                DrawText(row->info.file, box.x + 16, box.y + 12, 24, BLACK);
+                DrawText(TextFormat("%s  %dp  turn %u", row->key.mode == MODE_CHAOS ? "Chaos" : "Classic", row->key.playerCount, row->key.turn),
+                    box.x + 420, box.y + 12, 24, DARKBLUE);
+                DrawText(names, box.x + 700, box.y + 12, 24, BLACK);
+                DrawText(stamp, box.x + 1060, box.y + 12, 24, DARKGRAY);
+            }
+            if (browserTotal == 0 && !listInFlight) {
+                DrawText("No save files", SCREEN_WIDTH / 2 - 110, 320, 32, DARKGRAY);
+            }
+            if (loadInFlight) {
+                DrawText("Loading...", SCREEN_WIDTH / 2 - 80, 300 + BROWSER_ROWS * 52 + 20, 30, DARKGRAY);
+            }
+            DrawButton(leaveB);
+        } break;
+
         default:
+            ProfSwitch(PROF_BOARD);
             DrawBoard();
+            ProfSwitch(PROF_PLAYERS);
             DrawPlayers();
+            ProfSwitch(PROF_HUD);
             break;
         }
 
         //player is playing with these conditions 
         if (state == GAME_ACTIVE || state == DICE_ROLLING || state == PIECE_MOVING)
         {
-            DrawTexture(rollB.texture, rollB.bounds.x, rollB.bounds.y, WHITE);
+            DrawButton(rollB);
             if (state != GAME_ACTIVE)
-                DrawTexture(throwB.texture, throwB.bounds.x, throwB.bounds.y, WHITE);
+                DrawButton(throwB);
 
-            DrawTexture(leaveB.texture, leaveB.bounds.x, leaveB.bounds.y, WHITE);
-            DrawTexture(saveB.texture, saveB.bounds.x, saveB.bounds.y, WHITE);
-            if (gMode == MODE_CHAOS && canPlace[currentPlayer]) {
-                DrawTexture(placeSnakeB.texture, placeSnakeB.bounds.x, placeSnakeB.bounds.y, WHITE);
+            DrawButton(leaveB);
+            DrawButton(saveB);
+            if (game.mode == MODE_CHAOS && game.canPlace[game.currentPlayer]) {
+                DrawButton(placeSnakeB);
             }
             //dice logicc
-            if (diceCount == 1)
-                DrawTexture(diceTex[DiceFaceA() - 1], 1653, 90, WHITE);
+            if (game.diceCount == 1)
+                DrawTextureRec(atlas.texture, diceSrc[DiceFaceA() - 1], (Vector2){ 1653, 90 }, WHITE);
             else {
-                DrawTexture(diceTex[DiceFaceA() - 1], 1506, 90, WHITE);
-                DrawTexture(diceTex[DiceFaceB() - 1], 1653, 90, WHITE);
+                DrawTextureRec(atlas.texture, diceSrc[DiceFaceA() - 1], (Vector2){ 1506, 90 }, WHITE);
+                DrawTextureRec(atlas.texture, diceSrc[DiceFaceB() - 1], (Vector2){ 1653, 90 }, WHITE);
             }
 
-            DrawText(TextFormat("%s's Turn", players[currentPlayer].name),  40, 40, 32, players[currentPlayer].color);
-            DrawText(TextFormat("Total Turn/s: %d", globalTurn), SCREEN_WIDTH - 260, 40, 28, BLACK);
+            DrawText(TextFormat(IsBot(game.currentPlayer) ? "%s's Turn (bot)" : "%s's Turn", players[game.currentPlayer].name),  40, 40, 32, players[game.currentPlayer].color);
+            DrawText(TextFormat("Total Turn/s: %d", game.globalTurn), SCREEN_WIDTH - 260, 40, 28, BLACK);
+            DrawText(TextFormat("Seed: %llu", (unsigned long long)game.seed), 40, SCREEN_HEIGHT - 40, 18, DARKGRAY);
+            if (turbo) DrawText("TURBO", SCREEN_WIDTH - 260, 80, 28, RED);
         }
 
         if (state == NAME_INPUT_SAVE) {
@@ -880,31 +1475,38 @@ int main(void)
         }
 
         else if (state == PLACING_SNAKE) {
-            DrawTexture(placeSnakeB.texture, placeSnakeB.bounds.x, placeSnakeB.bounds.y, WHITE);
+            DrawButton(placeSnakeB);
             DrawRectangle(SCREEN_WIDTH - 320, 120, 300, 140, WHITE);
             DrawRectangleLines(SCREEN_WIDTH - 320, 120, 300, 140, BLACK);
-            DrawText("Head tile (2-99):", SCREEN_WIDTH - 300, 135, 22, BLACK);
+            DrawText(TextFormat("Head tile (2-%d):", game.board.tiles - 1), SCREEN_WIDTH - 300, 135, 22, BLACK);
             DrawRectangleLines(SCREEN_WIDTH - 300, 170, 260, 40, BLACK);
             DrawText(tileBuf, SCREEN_WIDTH - 290, 178, 28, BLACK);
         }
         //last game over make better later
         else if (state == GAME_OVER) {
-            DrawTexture(bg.texture, bg.bounds.x, bg.bounds.y, WHITE);
-            DrawText(TextFormat("%s WINS! CONGRATULATIONS", players[winnerIdx].name), SCREEN_WIDTH / 2 - 240, 340, 60, players[winnerIdx].color);
-            DrawText("Press ENTER to return to title", SCREEN_WIDTH / 2 - 310, 440, 32, BLACK);
+            DrawButton(bg);
+            DrawText(TextFormat("%s WINS! CONGRATULATIONS", players[game.winner].name), SCREEN_WIDTH / 2 - 240, 340, 60, players[game.winner].color);
+            DrawText(turbo ? "Next game starts shortly, F5 stops turbo" : "Press ENTER to return to title", SCREEN_WIDTH / 2 - 310, 440, 32, BLACK);
         }
 
+        DrawToasts();
+        if (statsPanel) DrawStatsPanel();
+        if (profOverlay) DrawProfiler();
+        ProfSwitch(PROF_PRESENT);
         EndDrawing();
     }
 
+    ProfCsvStop();
     //just some unloading texture functions
-    for (int i = 0; i < 6; i++) {
-        UnloadTexture(diceTex[i]);
-    }
-    for (int i = 0; i < 4; i++) {
-         UnloadTexture(tokenTex[i]);
-    }
-    FreeSnakesAndLadders();
+    while (state == LOADING_ASSETS && !AtlasLoaderPoll(&loader, &atlas)); //closed mid load, let the workers finish
+    AtlasUnload(&atlas);
+    BotFree(&bot);
+    UnloadRenderTexture(boardLayer);
+    UnloadTexture(checker);
+    free(tileCenter);
+    free(cellTile);
+    JournalEnd(&journal, false);
+    IoStop();
     CloseWindow();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,320 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include "atlas.h"
+#include "sys.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void FreeImages(Image* images, int count)
+{
+    for (int i = 0; i < count; i++) {
+        if (images[i].data) UnloadImage(images[i]);
+    }
+    free(images);
+}
+
+//tries one square size, false if the images don't fit in it
+static bool Shelve(const Image* images, const int* order, int count, int side, Rectangle* out)
+{
+    int x = ATLAS_PAD, y = ATLAS_PAD, shelf = 0;
+    for (int k = 0; k < count; k++) {
+        const Image* im = &images[order[k]];
+        if (x + im->width + ATLAS_PAD > side) {
+            x = ATLAS_PAD;
+            y += shelf + ATLAS_PAD;
+            shelf = 0;
+        }
+        if (x + im->width + ATLAS_PAD > side || y + im->height + ATLAS_PAD > side) {
+            return false;
+        }
+        out[order[k]] = (Rectangle){ (float)x, (float)y, (float)im->width, (float)im->height };
+        x += im->width + ATLAS_PAD;
+        if (im->height > shelf) shelf = im->height;
+    }
+    return true;
+}
+
+static bool Decode(const char* dir, const char* name, Image* out)
+{
+    if (strlen(name) >= ATLAS_NAME_LEN || strchr(name, ' ')) {
+        return false; //the manifest is split on spaces
+    }
+    char path[512]; //not TextFormat, its buffers are shared and this runs on the pool
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    *out = LoadImage(path);
+    if (!out->data) {
+        fprintf(stderr, "atlas: can't read %s/%s\n", dir, name);
+        return false;
+    }
+    ImageFormat(out, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    return true;
+}
+
+//decoded images into atlas->image, the images are freed either way
+static bool Pack(Atlas* atlas, Image* images, const char* const* names, int count)
+{
+    int* order = (int*)malloc((size_t)count * sizeof(int));
+    Rectangle* at = (Rectangle*)malloc((size_t)count * sizeof(Rectangle));
+    AtlasEntry* entries = (AtlasEntry*)calloc((size_t)count, sizeof(AtlasEntry));
+    bool ok = order && at && entries;
+    for (int i = 0; ok && i < count; i++) order[i] = i;
+
+    //tallest first keeps the shelves tight, ties by width so the layout never depends on qsort
+    for (int i = 1; ok && i < count; i++) {
+        int v = order[i], j = i;
+        for (; j > 0; j--) {
+            const Image* a = &images[order[j - 1]];
+            if (a->height > images[v].height || (a->height == images[v].height && a->width >= images[v].width)) break;
+            order[j] = order[j - 1];
+        }
+        order[j] = v;
+    }
+
+    int side = 256;
+    while (ok && !Shelve(images, order, count, side, at)) {
+        side *= 2;
+        if (side > ATLAS_MAX_SIDE) {
+            fprintf(stderr, "atlas: images don't fit in %dx%d\n", ATLAS_MAX_SIDE, ATLAS_MAX_SIDE);
+            ok = false;
+        }
+    }
+
+    if (ok) {
+        atlas->image = GenImageColor(side, side, BLANK);
+        for (int i = 0; i < count; i++) {
+            Rectangle src = { 0, 0, (float)images[i].width, (float)images[i].height };
+            ImageDraw(&atlas->image, images[i], src, at[i], WHITE);
+            strcpy(entries[i].name, names[i]);
+            entries[i].src = at[i];
+        }
+        atlas->entries = entries;
+        atlas->count = count;
+        entries = NULL;
+    }
+    FreeImages(images, count);
+    free(order);
+    free(at);
+    free(entries);
+    return ok;
+}
+
+bool AtlasBuild(Atlas* atlas, const char* dir, const char* const* names, int count)
+{
+    memset(atlas, 0, sizeof(*atlas));
+    Image* images = (Image*)calloc((size_t)count, sizeof(Image));
+    if (!images) {
+        return false;
+    }
+    for (int i = 0; i < count; i++) {
+        if (!Decode(dir, names[i], &images[i])) {
+            FreeImages(images, count);
+            return false;
+        }
+    }
+    return Pack(atlas, images, names, count);
+}
+
+bool AtlasSave(const Atlas* atlas, const char* png, const char* manifest)
+{
+    if (!atlas->image.data || !ExportImage(atlas->image, png)) {
+        return false;
+    }
+    FILE* fp = fopen(manifest, "w");
+    if (!fp) {
+        return false;
+    }
+    fprintf(fp, "# packed %dx%d, %d images\n", atlas->image.width, atlas->image.height, atlas->count);
+    for (int i = 0; i < atlas->count; i++) {
+        const Rectangle* r = &atlas->entries[i].src;
+        fprintf(fp, "%s %d %d %d %d\n", atlas->entries[i].name, (int)r->x, (int)r->y, (int)r->width, (int)r->height);
+    }
+    return fclose(fp) == 0;
+}
+
+bool AtlasUpload(Atlas* atlas)
+{
+    if (!atlas->image.data) {
+        return false;
+    }
+    atlas->texture = LoadTextureFromImage(atlas->image);
+    UnloadImage(atlas->image);
+    atlas->image = (Image){ 0 };
+    return atlas->texture.id != 0;
+}
+
+//the packed png and manifest into atlas->image, false if either is missing, they don't
+//agree, or an image the game wants isn't in there
+static bool ReadPacked(Atlas* atlas, const char* png, const char* manifest, const char* const* names, int count)
+{
+    memset(atlas, 0, sizeof(*atlas));
+    FILE* fp = fopen(manifest, "r");
+    if (!fp) {
+        return false;
+    }
+    char line[256];
+    int cap = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), fp)) {
+        if (line[0] == '#' || line[0] == '\n') continue;
+        AtlasEntry e;
+        int x, y, w, h;
+        if (sscanf(line, "%63s %d %d %d %d", e.name, &x, &y, &w, &h) != 5 || x < 0 || y < 0 || w <= 0 || h <= 0) {
+            ok = false;
+            break;
+        }
+        e.src = (Rectangle){ (float)x, (float)y, (float)w, (float)h };
+        if (atlas->count == cap) {
+            cap = cap ? cap * 2 : 32;
+            AtlasEntry* grown = (AtlasEntry*)realloc(atlas->entries, (size_t)cap * sizeof(AtlasEntry));
+            if (!grown) {
+                ok = false;
+                break;
+            }
+            atlas->entries = grown;
+        }
+        atlas->entries[atlas->count++] = e;
+    }
+    fclose(fp);
+
+    for (int i = 0; ok && i < count; i++) {
+        ok = AtlasRect(atlas, names[i]).width > 0;
+    }
+    if (ok) {
+        atlas->image = LoadImage(png);
+        ok = atlas->image.data != NULL;
+    }
+    //a rect outside the image means the png and manifest come from different packs
+    for (int i = 0; ok && i < atlas->count; i++) {
+        const Rectangle* r = &atlas->entries[i].src;
+        if (r->x + r->width > atlas->image.width || r->y + r->height > atlas->image.height) ok = false;
+    }
+    if (!ok) {
+        AtlasUnload(atlas);
+    }
+    return ok;
+}
+
+//one helper of the pool: takes the next undecoded image until there are none left
+static void DecodeMain(void* arg)
+{
+    AtlasLoader* l = (AtlasLoader*)arg;
+    for (;;) {
+        int64_t i = SysAdd64(&l->next, 1);
+        if (i >= l->count) {
+            break;
+        }
+        if (!Decode(l->dir, l->names[i], &l->images[i])) SysStore64(&l->failed, 1);
+        SysAdd64(&l->decoded, 1);
+    }
+}
+
+//the packed pair is one decode; without it the loose pngs are spread over a pool and
+//packed here, so the main thread only ever does the upload
+static void LoaderMain(void* arg)
+{
+    AtlasLoader* l = (AtlasLoader*)arg;
+    if (ReadPacked(&l->atlas, l->png, l->manifest, l->names, l->count)) {
+        SysStore64(&l->decoded, l->count);
+        SysStore64(&l->state, 1);
+        return;
+    }
+
+    bool ok = true;
+    l->images = (Image*)calloc((size_t)l->count, sizeof(Image));
+    if (!l->images) {
+        ok = false;
+    }
+    SysThread pool[ATLAS_MAX_WORKERS];
+    int helpers = 0;
+    if (ok) {
+        int want = SysCpuCount() - 1; //this thread decodes too
+        if (want > ATLAS_MAX_WORKERS) want = ATLAS_MAX_WORKERS;
+        if (want > l->count - 1) want = l->count - 1;
+        for (; helpers < want; helpers++) {
+            if (!SysThreadStart(&pool[helpers], DecodeMain, l)) break;
+        }
+        DecodeMain(l);
+        for (int i = 0; i < helpers; i++) SysThreadJoin(&pool[i]);
+        ok = !SysLoad64(&l->failed);
+    }
+
+    if (ok) {
+        ok = Pack(&l->atlas, l->images, l->names, l->count);
+    }
+    else if (l->images) {
+        FreeImages(l->images, l->count);
+    }
+    l->images = NULL;
+    SysStore64(&l->state, ok ? 1 : -1);
+}
+
+bool AtlasLoaderStart(AtlasLoader* l, const char* png, const char* manifest, const char* dir, const char* const* names, int count)
+{
+    memset(l, 0, sizeof(*l));
+    l->png = png;
+    l->manifest = manifest;
+    l->dir = dir;
+    l->names = names;
+    l->count = count;
+    if (!SysThreadStart(&l->lead, LoaderMain, l)) {
+        return false;
+    }
+    l->started = true;
+    return true;
+}
+
+float AtlasLoaderProgress(AtlasLoader* l)
+{
+    return l->count ? (float)SysLoad64(&l->decoded) / (float)l->count : 1.0f;
+}
+
+int AtlasLoaderPoll(AtlasLoader* l, Atlas* out)
+{
+    if (!l->started) {
+        return -1;
+    }
+    int64_t state = SysLoad64(&l->state);
+    if (!state) {
+        return 0;
+    }
+    SysThreadJoin(&l->lead);
+    l->started = false;
+    *out = l->atlas;
+    memset(&l->atlas, 0, sizeof(l->atlas));
+    if (state < 0 || !AtlasUpload(out)) {
+        AtlasUnload(out);
+        return -1;
+    }
+    return 1;
+}
+
+void AtlasUnload(Atlas* atlas)
+{
+    if (atlas->image.data) UnloadImage(atlas->image);
+    if (atlas->texture.id) UnloadTexture(atlas->texture);
+    free(atlas->entries);
+    memset(atlas, 0, sizeof(*atlas));
+}
+
+Rectangle AtlasRect(const Atlas* atlas, const char* name)
+{
+    for (int i = 0; i < atlas->count; i++) {
+        if (strcmp(atlas->entries[i].name, name) == 0) return atlas->entries[i].src;
+    }
+    return (Rectangle){ 0, 0, 0, 0 };
+}
+
+int AtlasTool(int argc, char** argv, const char* dir, const char* const* names, int count)
+{
+    const char* png = (argc > 2) ? argv[2] : ATLAS_PNG;
+    const char* manifest = (argc > 3) ? argv[3] : ATLAS_MANIFEST;
+    Atlas a;
+    if (!AtlasBuild(&a, dir, names, count)) {
+        return 1;
+    }
+    bool ok = AtlasSave(&a, png, manifest);
+    if (ok) printf("packed %d images into %s (%dx%d), manifest %s\n", a.count, png, a.image.width, a.image.height, manifest);
+    else fprintf(stderr, "atlas: can't write %s or %s\n", png, manifest);
+    AtlasUnload(&a);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "raylib.h"
+#include "sys.h"
+
+//every ui image packed into one texture so buttons, dice and tokens draw from a single
+//texture and raylib keeps them in one batch. the manifest next to the png is one line per
+//image: "<name> <x> <y> <w> <h>", name being the source path relative to the assets folder
+
+#define ATLAS_PNG      "assets/atlas.png"
+#define ATLAS_MANIFEST "assets/atlas.txt"
+#define ATLAS_NAME_LEN 64
+#define ATLAS_PAD      2    //clear pixels around each image so filtering never picks up a neighbor
+#define ATLAS_MAX_SIDE 4096
+#define ATLAS_MAX_WORKERS 16 //decode threads when the loose pngs have to be packed at startup
+
+typedef struct {
+    char name[ATLAS_NAME_LEN];
+    Rectangle src;
+} AtlasEntry;
+
+typedef struct {
+    Image image;   //only kept between AtlasBuild and AtlasSave or AtlasUpload
+    Texture2D texture;
+    AtlasEntry* entries;
+    int count;
+} Atlas;
+
+//packs the images (paths relative to dir) into atlas->image, shelf by shelf tallest first,
+//in the smallest power of two square they fit
+bool AtlasBuild(Atlas* atlas, const char* dir, const char* const* names, int count);
+bool AtlasSave(const Atlas* atlas, const char* png, const char* manifest);
+bool AtlasUpload(Atlas* atlas); //image to texture, needs the window
+
+void AtlasUnload(Atlas* atlas);
+
+//loads the atlas off the main thread so the window can draw progress meanwhile. the packed
+//png and manifest are used when they agree and have every name, otherwise the loose pngs
+//are decoded on a pool and packed. only the upload in AtlasLoaderPoll touches the gpu
+typedef struct {
+    const char* png;
+    const char* manifest;
+    const char* dir;
+    const char* const* names;
+    int count;
+
+    Atlas atlas;    //built by the workers, handed out by AtlasLoaderPoll
+    Image* images;  //loose pngs while they decode
+    volatile int64_t next;
+    volatile int64_t decoded;
+    volatile int64_t failed;
+    volatile int64_t state; //0 working, 1 ready to upload, -1 failed
+    SysThread lead;
+    bool started;
+} AtlasLoader;
+
+bool  AtlasLoaderStart(AtlasLoader* l, const char* png, const char* manifest, const char* dir, const char* const* names, int count);
+float AtlasLoaderProgress(AtlasLoader* l); //0..1 of the images decoded
+int   AtlasLoaderPoll(AtlasLoader* l, Atlas* out); //main thread each frame: 0 still loading, 1 uploaded into out, -1 failed
+
+//where an image sits in the atlas, an empty rect if it wasn't packed
+Rectangle AtlasRect(const Atlas* atlas, const char* name);
+
+//"atlas [out.png] [out.txt]": packs names from dir the way the game loads them
+int AtlasTool(int argc, char** argv, const char* dir, const char* const* names, int count);
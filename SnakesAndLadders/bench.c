@@ -0,0 +1,330 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include "design.h"
+#include "game.h"
+#include "rules.h"
+#include "save.h"
+#include "simd.h"
+#include "sys.h"
+#include "traj.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+//micro and macro benchmarks of the headless code, one json document out:
+//
+//  bench [out.json|-] [name filter] [repeats]
+//
+//each case runs warmup batches until one takes BENCH_WARM_MS, sizes its batch from that to
+//take about BENCH_REP_MS, then times that same batch repeats times. the median is the number
+//to track, min and max show how noisy the box was. every input comes from a fixed seed so
+//two runs on two days do the same work
+
+#define BENCH_WARM_MS     20.0
+#define BENCH_REP_MS      50.0
+#define BENCH_REPEATS     9
+#define BENCH_MAX_REPEATS 99
+#define BENCH_TILES       4096 //lookup inputs, a power of two
+#define BENCH_SAVE_FILE   "bench_save.tmp"
+
+typedef uint64_t (*BenchFn)(uint64_t iterations); //returns something the work fed into so none of it is dropped
+
+typedef struct {
+    const char* name;
+    const char* unit; //what one iteration is
+    BenchFn fn;
+} BenchCase;
+
+static Board defaultBoard, bigBoard;
+static int smallTiles[BENCH_TILES], bigTiles[BENCH_TILES];
+static SaveState midGame;
+static volatile uint64_t sink;
+
+static void Setup(void)
+{
+    BoardInitDefault(&defaultBoard);
+    BoardInit(&bigBoard, BOARD_MAX_SIDE, BOARD_MAX_SIDE);
+    Rng rng = RngAt(0xBE4C, 0, RNG_POLICY);
+    for (int i = 0; i < BENCH_TILES; i++) {
+        smallTiles[i] = RngRange(&rng, 1, defaultBoard.tiles);
+        bigTiles[i] = RngRange(&rng, 1, bigBoard.tiles);
+    }
+    //linked tiles get their share so the hit path is timed too
+    for (int i = 0; i < BENCH_TILES; i += 8) {
+        smallTiles[i] = defaultBoard.taken[(i / 8) % defaultBoard.takenCount];
+        bigTiles[i] = bigBoard.taken[(i / 8) % bigBoard.takenCount];
+    }
+
+    //a chaos game part way through, with snakes put down, for the save round trips
+    memset(&midGame, 0, sizeof(midGame));
+    GameInit(&midGame.game, 4, 2, MODE_CHAOS, 0xBE4C);
+    Game* g = &midGame.game;
+    while (g->globalTurn < 40 && g->winner < 0) {
+        if (g->canPlace[g->currentPlayer]) {
+            Rng pick = RngAt(g->seed, (uint64_t)g->globalTurn, RNG_POLICY);
+            GamePlaceSnake(g, RandomSnakePolicy(g, &pick, NULL));
+        }
+        int a, b;
+        GameMove(g, RollDice(g, &a, &b));
+    }
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        sprintf(midGame.players[i].name, "Bench %d", i + 1);
+        midGame.players[i].playerNumber = i + 1;
+    }
+    midGame.version = SAVE_VERSION;
+}
+
+static uint64_t BenchSlideDefault(uint64_t n)
+{
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < n; i++) sum += (uint64_t)Slide(&defaultBoard, smallTiles[i & (BENCH_TILES - 1)]);
+    return sum;
+}
+
+static uint64_t BenchSlideBig(uint64_t n)
+{
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < n; i++) sum += (uint64_t)Slide(&bigBoard, bigTiles[i & (BENCH_TILES - 1)]);
+    return sum;
+}
+
+static uint64_t BenchOccupied(uint64_t n)
+{
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < n; i++) sum += TileOccupied(&defaultBoard, smallTiles[i & (BENCH_TILES - 1)]);
+    return sum;
+}
+
+static uint64_t BenchRollOne(uint64_t n)
+{
+    uint64_t sum = 0;
+    int a, b;
+    for (uint64_t i = 0; i < n; i++) sum += (uint64_t)DiceAt(0xBE4C, (int)i, 1, &a, &b);
+    return sum;
+}
+
+static uint64_t BenchRollTwo(uint64_t n)
+{
+    uint64_t sum = 0;
+    int a, b;
+    for (uint64_t i = 0; i < n; i++) sum += (uint64_t)DiceAt(0xBE4C, (int)i, 2, &a, &b);
+    return sum;
+}
+
+//the numbering behind the window's CellPos table
+static uint64_t BenchTileCell(uint64_t n)
+{
+    uint64_t sum = 0;
+    int c, r;
+    for (uint64_t i = 0; i < n; i++) {
+        TileCell(BOARD_MAX_SIDE, BOARD_MAX_SIDE, bigTiles[i & (BENCH_TILES - 1)], &c, &r);
+        sum += (uint64_t)(c ^ r);
+    }
+    return sum;
+}
+
+static uint64_t PlayGames(uint64_t n, int players, int dice, Mode mode)
+{
+    SimConfig cfg = { players, dice, mode, RandomSnakePolicy, NULL, 0 };
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        GameResult r;
+        SimulateGame(&cfg, GameSeed(0xBE4C, i), &r);
+        sum += (uint64_t)r.turns;
+    }
+    return sum;
+}
+
+static uint64_t BenchClassic(uint64_t n) { return PlayGames(n, 2, 1, MODE_CLASSIC); }
+static uint64_t BenchChaos(uint64_t n) { return PlayGames(n, 4, 2, MODE_CHAOS); }
+
+//the same classic games in vector lanes, lanes capped as SimdLimit takes them: the widest the
+//cpu has, then avx2 alone. against game/classic_2p_1d that's the lane speedup on one core
+static uint64_t PlayLanes(uint64_t n, int lanes)
+{
+    static SimSummary sum;
+    SimConfig cfg = { 2, 1, MODE_CLASSIC, RandomSnakePolicy, NULL, 0 };
+    memset(&sum, 0, sizeof(sum));
+    SimdLimit(lanes);
+    SimdClassicRange(&cfg, 0xBE4C, 0, n, &sum, NULL);
+    SimdLimit(16);
+    return sum.turns;
+}
+
+static uint64_t BenchLanes(uint64_t n) { return PlayLanes(n, 16); }
+static uint64_t BenchLanesAvx2(uint64_t n) { return PlayLanes(n, 8); }
+
+//the rule variant loops, to hold against the hand-written ones above
+static uint64_t PlayRules(uint64_t n, int players, int dice, Mode mode, uint32_t rules)
+{
+    SimConfig cfg = { players, dice, mode, RandomSnakePolicy, NULL, rules };
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        GameResult r;
+        RulesSimulateGame(&cfg, GameSeed(0xBE4C, i), &r);
+        sum += (uint64_t)r.turns;
+    }
+    return sum;
+}
+
+static uint64_t BenchRulesClassic(uint64_t n) { return PlayRules(n, 2, 1, MODE_CLASSIC, 0); }
+static uint64_t BenchRulesChaos(uint64_t n) { return PlayRules(n, 4, 2, MODE_CHAOS, 0); }
+static uint64_t BenchRulesAll(uint64_t n) { return PlayRules(n, 4, 2, MODE_CHAOS, RULE_ALL); }
+
+//the same games through the counting loop, what turning stats on costs a batch
+static uint64_t BenchStats(uint64_t n)
+{
+    static StatsShard shard;
+    static SimSummary sum;
+    SimConfig cfg = { 4, 2, MODE_CHAOS, RandomSnakePolicy, NULL, 0 };
+    RulesRange(&cfg, 0xBE4C, 0, n, &sum, &shard.s, NULL);
+    return (uint64_t)SysPeek64(&shard.s.moves);
+}
+
+//the same games recorded move by move, a chunk's worth at a time as sim hands them out. the
+//packing and the write aren't in it
+static uint64_t BenchTraj(uint64_t n)
+{
+    static TrajBuf buf;
+    static SimSummary sum;
+    SimConfig cfg = { 4, 2, MODE_CHAOS, RandomSnakePolicy, NULL, 0 };
+    uint64_t moves = 0;
+    for (uint64_t first = 0; first < n; first += 1024) {
+        TrajBufBegin(&buf, first);
+        RulesRange(&cfg, 0xBE4C, first, first + 1024 < n ? first + 1024 : n, &sum, NULL, &buf);
+        moves += buf.moves;
+    }
+    return moves;
+}
+
+//draw, check and score layouts on one thread, every one of them new to the cache
+static uint64_t BenchDesign(uint64_t n)
+{
+    DesignConfig cfg = { BOARD_SIZE, BOARD_SIZE, 1, 5, 5, 4, 50, 25.0, 0.25, 5, n, 0xBE4C, 1, NULL };
+    DesignResult r;
+    RunDesign(&cfg, &r);
+    return r.solved;
+}
+
+//SaveBinary and LoadBinary without the io worker around them: encode, check and decode
+static uint64_t BenchSaveMemory(uint64_t n)
+{
+    uint8_t buf[SAVE_MAX_LEN];
+    SaveState back;
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        uint32_t len = SaveEncode(&midGame, buf);
+        sum += (uint64_t)SaveDecode(buf, len, &back) + (uint64_t)back.game.globalTurn;
+    }
+    return sum;
+}
+
+//the same through the disk, write to a temp file and rename, then map and read
+static uint64_t BenchSaveFile(uint64_t n)
+{
+    SaveState back;
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < n; i++) {
+        sum += (uint64_t)SaveWrite(BENCH_SAVE_FILE, &midGame);
+        sum += (uint64_t)SaveRead(BENCH_SAVE_FILE, &back);
+    }
+    remove(BENCH_SAVE_FILE);
+    return sum;
+}
+
+static const BenchCase cases[] = {
+    { "slide/10x10",          "lookup", BenchSlideDefault },
+    { "slide/1000x1000",      "lookup", BenchSlideBig },
+    { "tile_occupied/10x10",  "lookup", BenchOccupied },
+    { "roll_dice/one",        "roll",   BenchRollOne },
+    { "roll_dice/two",        "roll",   BenchRollTwo },
+    { "cell_pos/1000x1000",   "tile",   BenchTileCell },
+    { "game/classic_2p_1d",   "game",   BenchClassic },
+    { "game/chaos_4p_2d",     "game",   BenchChaos },
+    { "simd/classic_2p_1d",   "game",   BenchLanes },
+    { "simd/classic_2p_1d_8", "game",   BenchLanesAvx2 },
+    { "rules/classic_2p_1d",  "game",   BenchRulesClassic },
+    { "rules/chaos_4p_2d",    "game",   BenchRulesChaos },
+    { "rules/all_chaos_4p_2d", "game",  BenchRulesAll },
+    { "stats/chaos_4p_2d",    "game",   BenchStats },
+    { "traj/chaos_4p_2d",     "game",   BenchTraj },
+    { "design/10x10",         "layout", BenchDesign },
+    { "save_roundtrip/memory", "save",  BenchSaveMemory },
+    { "save_roundtrip/file",  "save",   BenchSaveFile },
+};
+#define BENCH_CASES ((int)(sizeof(cases) / sizeof(cases[0])))
+
+static double TimeBatch(const BenchCase* c, uint64_t n)
+{
+    double start = SysNow();
+    sink += c->fn(n);
+    return SysNow() - start;
+}
+
+static int CompareDouble(const void* a, const void* b)
+{
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static void RunCase(FILE* out, const BenchCase* c, int repeats, bool first)
+{
+    uint64_t n = 1;
+    double t;
+    while ((t = TimeBatch(c, n)) < BENCH_WARM_MS / 1000.0) n *= 2;
+    double want = (double)n * (BENCH_REP_MS / 1000.0) / (t > 0 ? t : 1e-9);
+    n = want < 1.0 ? 1 : (uint64_t)want;
+
+    double ns[BENCH_MAX_REPEATS];
+    for (int r = 0; r < repeats; r++) ns[r] = TimeBatch(c, n) * 1e9 / (double)n;
+    qsort(ns, (size_t)repeats, sizeof(double), CompareDouble);
+    double median = ns[repeats / 2];
+
+    fprintf(out, "%s    {\"name\": \"%s\", \"unit\": \"%s\", \"iterations\": %llu, \"repeats\": %d, "
+        "\"median_ns\": %.3f, \"min_ns\": %.3f, \"max_ns\": %.3f, \"per_sec\": %.1f}",
+        first ? "" : ",\n", c->name, c->unit, (unsigned long long)n, repeats, median, ns[0], ns[repeats - 1], 1e9 / median);
+    fprintf(stderr, "%-24s %12.3f ns/%s (min %.3f, max %.3f)\n", c->name, median, c->unit, ns[0], ns[repeats - 1]);
+}
+
+static const char* Compiler(void)
+{
+#if defined(__clang__)
+    return "clang " __clang_version__;
+#elif defined(__GNUC__)
+    return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+    static char v[32];
+    sprintf(v, "msvc %d", _MSC_VER);
+    return v;
+#else
+    return "unknown";
+#endif
+}
+
+int main(int argc, char** argv)
+{
+    const char* path = (argc > 1) ? argv[1] : "-";
+    const char* filter = (argc > 2) ? argv[2] : "";
+    int repeats = (argc > 3) ? atoi(argv[3]) : BENCH_REPEATS;
+    if (repeats < 1 || repeats > BENCH_MAX_REPEATS) {
+        fprintf(stderr, "repeats must be 1 to %d\n", BENCH_MAX_REPEATS);
+        return 1;
+    }
+    FILE* out = strcmp(path, "-") == 0 ? stdout : fopen(path, "w");
+    if (!out) {
+        fprintf(stderr, "can't write %s\n", path);
+        return 1;
+    }
+
+    Setup();
+    fprintf(out, "{\n  \"suite\": \"snakes-bench\",\n  \"format\": 1,\n  \"time\": %lld,\n", (long long)time(NULL));
+    fprintf(out, "  \"compiler\": \"%s\",\n  \"cpus\": %d,\n  \"results\": [\n", Compiler(), SysCpuCount());
+    bool first = true;
+    for (int i = 0; i < BENCH_CASES; i++) {
+        if (!strstr(cases[i].name, filter)) continue;
+        RunCase(out, &cases[i], repeats, first);
+        first = false;
+    }
+    fprintf(out, "\n  ]\n}\n");
+    return (out == stdout || fclose(out) == 0) ? 0 : 1;
+}
@@ -0,0 +1,331 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include "bot.h"
+#include "sys.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BOT_TABLE_SIZE (1 << BOT_TABLE_BITS)
+#define BOT_GUESS_KEY  0xB07u //tail guesses come from their own key, never the game's seed
+#define BOT_SPREAD     2.0f   //how many turns of lead it takes to be sure of a win, times sqrt(turns to go)
+
+static uint64_t Mix(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+//links are xored in so the order they went down in doesn't matter
+static uint64_t BoardKey(const Game* g)
+{
+    const Board* b = &g->board;
+    uint64_t h = Mix((uint64_t)b->tiles << 8 | (uint64_t)g->diceCount << 4 | (uint64_t)g->playerCount);
+    for (int i = 0; i < b->snakeCount; i++) h ^= Mix((uint64_t)b->snakes[i].start << 32 | (uint64_t)b->snakes[i].end);
+    for (int i = 0; i < b->ladderCount; i++) h ^= Mix((uint64_t)b->ladders[i].start << 32 | (uint64_t)b->ladders[i].end | 1ull << 63);
+    return h;
+}
+
+static uint64_t StateKey(const Bot* b, const Game* g)
+{
+    uint64_t h = BoardKey(g) ^ b->togoKey ^ Mix(b->epoch);
+    for (int s = 0; s < g->playerCount; s++) {
+        uint64_t seat = (uint64_t)g->position[s] | (uint64_t)g->personalTurn[s] << 32 | (uint64_t)g->canPlace[s] << 40;
+        h = Mix(h ^ seat ^ (uint64_t)s << 48);
+    }
+    return Mix(h ^ (uint64_t)g->currentPlayer);
+}
+
+static float RollChance(int diceCount, int total)
+{
+    if (diceCount == 1) return 1.0f / 6.0f;
+    return (float)(6 - abs(total - 7)) / 36.0f;
+}
+
+static float MeanRoll(const Game* g)
+{
+    return 3.5f * (float)g->diceCount;
+}
+
+//expected own turns to finish from every tile of g's board, solved in place from the top
+//down so a sweep mostly reads tiles it already has. snakes and the bounce loop back, so it
+//sweeps until nothing moves
+static bool Togo(Bot* b, const Game* g)
+{
+    int tiles = g->board.tiles;
+    uint64_t key = BoardKey(g);
+    if (tiles > BOT_TABLE_TILES || (key == b->togoKey && b->togo)) {
+        b->togoKey = key;
+        return true;
+    }
+    if (tiles + 1 > b->togoCap) {
+        float* grown = (float*)realloc(b->togo, ((size_t)tiles + 1) * sizeof(float));
+        if (!grown) {
+            return false;
+        }
+        b->togo = grown;
+        b->togoCap = tiles + 1;
+    }
+    float* e = b->togo;
+    float mean = MeanRoll(g);
+    for (int t = 0; t <= tiles; t++) e[t] = (float)(tiles - t) / mean;
+
+    int lo = g->diceCount, hi = 6 * g->diceCount;
+    for (int sweep = 0; sweep < 1000; sweep++) {
+        float moved = 0.0f;
+        for (int t = tiles - 1; t >= 1; t--) {
+            float sum = 1.0f;
+            for (int r = lo; r <= hi; r++) sum += RollChance(g->diceCount, r) * e[Slide(&g->board, BounceTarget(t, r, tiles))];
+            float d = fabsf(sum - e[t]);
+            if (d > moved) moved = d;
+            e[t] = sum;
+        }
+        if (moved < 1e-3f) break;
+    }
+    b->togoKey = key;
+    return true;
+}
+
+static float ToGo(const Bot* b, const Game* g, int tile)
+{
+    if (g->board.tiles > BOT_TABLE_TILES) return (float)(g->board.tiles - tile) / MeanRoll(g);
+    return b->togo[tile];
+}
+
+//a winner takes it all
+static void Won(const Game* g, float* out)
+{
+    for (int s = 0; s < MAX_PLAYERS; s++) out[s] = (s == g->winner) ? 1.0f : 0.0f;
+}
+
+//odds from how far each seat has to go. snakes placed inside the search aren't in the
+//table, a seat still below one pays its length times the chance of landing on a tile it
+//passes, which is one over the mean roll. seats that move later this round are that
+//much of a turn behind
+static void Leaf(const Bot* b, const Game* g, float* out)
+{
+    int n = g->playerCount, cur = g->currentPlayer;
+    float landing = 1.0f / MeanRoll(g), e[MAX_PLAYERS] = { 0 }, mean = 0.0f;
+    for (int s = 0; s < n; s++) {
+        int pos = g->position[s];
+        e[s] = ToGo(b, g, pos) + (float)((s - cur + n) % n) / (float)n;
+        for (int k = b->rootSnakes; k < g->board.snakeCount; k++) {
+            const SnakeOrLadder* sn = &g->board.snakes[k];
+            if (pos < sn->start) e[s] += landing * (ToGo(b, g, sn->end) - ToGo(b, g, sn->start));
+        }
+        mean += e[s] / (float)n;
+    }
+    float spread = BOT_SPREAD * sqrtf(mean > 1.0f ? mean : 1.0f), lead = e[0], sum = 0.0f;
+    for (int s = 1; s < n; s++) {
+        if (e[s] < lead) lead = e[s];
+    }
+    for (int s = 0; s < MAX_PLAYERS; s++) {
+        out[s] = (s < n) ? expf((lead - e[s]) / spread) : 0.0f;
+        sum += out[s];
+    }
+    for (int s = 0; s < n; s++) out[s] /= sum;
+}
+
+//GamePlaceSnake with a guessed tail
+static bool PlaceGuess(Game* g, int head)
+{
+    Board* b = &g->board;
+    if (head <= 1 || head >= b->tiles || TileOccupied(b, head) || b->snakeCount >= MAX_SNAKES) {
+        return false;
+    }
+    Rng rng = RngAt(BOT_GUESS_KEY, (uint64_t)head, RNG_TAIL);
+    int tail = BoardPickFree(b, head - 20, head - 5 > 1 ? head - 5 : 1, &rng);
+    if (!tail) {
+        return false;
+    }
+    BoardAddSnake(b, head, tail);
+    g->canPlace[g->currentPlayer] = false;
+    return true;
+}
+
+//heads worth trying for the current seat: the tiles the others can land on with their
+//next roll, by how likely, less the chance the seat lands there itself straight after
+static int Candidates(const Game* g, int* heads, int max)
+{
+    int tiles[MAX_PLAYERS * 11];
+    float score[MAX_PLAYERS * 11];
+    int count = 0, cur = g->currentPlayer;
+    int lo = g->diceCount, hi = 6 * g->diceCount;
+    for (int s = 0; s < g->playerCount; s++) {
+        for (int r = lo; r <= hi; r++) {
+            int t = BounceTarget(g->position[s], r, g->board.tiles);
+            float p = (s == cur) ? -RollChance(g->diceCount, r) : RollChance(g->diceCount, r);
+            int i = 0;
+            while (i < count && tiles[i] != t) i++;
+            if (i == count) {
+                tiles[count] = t;
+                score[count++] = 0.0f;
+            }
+            score[i] += p;
+        }
+    }
+
+    int kept = 0;
+    for (int i = 0; i < count; i++) {
+        int t = tiles[i];
+        float sc = score[i];
+        if (sc <= 0.0f || t <= 1 || t >= g->board.tiles || TileOccupied(&g->board, t)) continue;
+        int j = kept;
+        for (; j > 0 && (score[j - 1] < sc || (score[j - 1] == sc && tiles[j - 1] > t)); j--) {
+            tiles[j] = tiles[j - 1];
+            score[j] = score[j - 1];
+        }
+        tiles[j] = t;
+        score[j] = sc;
+        kept++;
+    }
+    if (kept > max) kept = max;
+    memcpy(heads, tiles, (size_t)kept * sizeof(int));
+    return kept;
+}
+
+static void Turn(Bot* b, const Game* g, int depth, float* out);
+
+//chance node, every roll of the current seat by its odds
+static void Roll(Bot* b, const Game* g, int depth, float* out)
+{
+    memset(out, 0, MAX_PLAYERS * sizeof(float));
+    for (int r = g->diceCount; r <= 6 * g->diceCount; r++) {
+        Game next = *g;
+        GameMove(&next, r);
+        float v[MAX_PLAYERS], p = RollChance(g->diceCount, r);
+        Turn(b, &next, depth - 1, v);
+        for (int s = 0; s < MAX_PLAYERS; s++) out[s] += p * v[s];
+    }
+}
+
+//the start of a turn: the seat keeps its right or places wherever suits it best, then rolls
+static void Turn(Bot* b, const Game* g, int depth, float* out)
+{
+    if (g->winner >= 0) {
+        Won(g, out);
+        return;
+    }
+    if (depth == 0) {
+        Leaf(b, g, out);
+        return;
+    }
+    if ((++b->nodes & 255) == 0 && b->budgetMs > 0 && SysNow() > b->deadline) b->stop = true;
+    if (b->stop) {
+        memset(out, 0, MAX_PLAYERS * sizeof(float));
+        return;
+    }
+
+    uint64_t key = StateKey(b, g);
+    BotEntry* e = &b->table[key & (BOT_TABLE_SIZE - 1)];
+    if (e->key == key && e->depth >= depth) {
+        memcpy(out, e->value, sizeof(e->value));
+        return;
+    }
+
+    int cur = g->currentPlayer;
+    Roll(b, g, depth, out);
+    if (g->mode == MODE_CHAOS && g->canPlace[cur]) {
+        int heads[BOT_INNER_CANDIDATES];
+        int count = Candidates(g, heads, BOT_INNER_CANDIDATES);
+        for (int i = 0; i < count && !b->stop; i++) {
+            Game next = *g;
+            float v[MAX_PLAYERS];
+            if (!PlaceGuess(&next, heads[i])) continue;
+            Roll(b, &next, depth, v);
+            if (v[cur] > out[cur]) memcpy(out, v, sizeof(v));
+        }
+    }
+    if (!b->stop) {
+        e->key = key;
+        e->depth = depth;
+        memcpy(e->value, out, sizeof(e->value));
+    }
+}
+
+bool BotInit(Bot* b, double budgetMs, int maxDepth, uint32_t seats)
+{
+    memset(b, 0, sizeof(*b));
+    b->budgetMs = budgetMs;
+    b->maxDepth = (maxDepth < 1) ? 1 : (maxDepth > BOT_MAX_DEPTH ? BOT_MAX_DEPTH : maxDepth);
+    b->seats = seats;
+    b->table = (BotEntry*)calloc(BOT_TABLE_SIZE, sizeof(BotEntry));
+    return b->table != NULL;
+}
+
+void BotFree(Bot* b)
+{
+    free(b->table);
+    free(b->togo);
+    memset(b, 0, sizeof(*b));
+}
+
+void BotForget(Bot* b)
+{
+    b->epoch++;
+}
+
+//one turn deeper at a time, the first depth never looks at the clock so there's always an answer
+int BotChooseHead(Bot* b, const Game* g)
+{
+    double start = SysNow();
+    int cur = g->currentPlayer;
+    b->nodes = 0;
+    b->depth = 0;
+    b->ms = 0.0;
+    if (g->winner >= 0 || g->mode != MODE_CHAOS || !g->canPlace[cur] || !b->table || !Togo(b, g)) {
+        return 0;
+    }
+    //the root board is in every key, the table's leaves are only good for the board they were scored on
+    b->rootSnakes = g->board.snakeCount;
+    b->deadline = start + b->budgetMs / 1000.0;
+    b->stop = false;
+
+    int heads[BOT_CANDIDATES + 1];
+    int count = 1 + Candidates(g, heads + 1, BOT_CANDIDATES);
+    heads[0] = 0;
+    int best = 0;
+    for (int depth = 1; depth <= b->maxDepth; depth++) {
+        int pick = 0;
+        float pickValue = -1.0f;
+        for (int i = 0; i < count && !b->stop; i++) {
+            Game next = *g;
+            float v[MAX_PLAYERS];
+            if (heads[i] && !PlaceGuess(&next, heads[i])) continue;
+            Roll(b, &next, depth, v);
+            if (v[cur] > pickValue) {
+                pickValue = v[cur];
+                pick = heads[i];
+            }
+        }
+        if (b->stop) {
+            break;
+        }
+        best = pick;
+        b->depth = depth;
+        if (b->budgetMs > 0 && SysNow() > b->deadline) {
+            break;
+        }
+    }
+    b->ms = (SysNow() - start) * 1000.0;
+    return best;
+}
+
+int BotSnakePolicy(const Game* g, Rng* rng, void* ctx)
+{
+    Bot* b = (Bot*)ctx;
+    if (!(b->seats >> g->currentPlayer & 1)) {
+        return RandomSnakePolicy(g, rng, NULL);
+    }
+    return BotChooseHead(b, g);
+}
+
+int GreedySnakePolicy(const Game* g, Rng* rng, void* ctx)
+{
+    (void)rng;
+    (void)ctx;
+    int head;
+    return Candidates(g, &head, 1) ? head : 0;
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include "game.h"
+
+//computer seats for chaos mode. a bot picks the snake head that leaves it the best odds,
+//which with the odds summing to one is the head that costs the other seats the most.
+//expectimax over the dice: every seat takes whatever placement is best for itself and
+//every roll counts by its chance. the search goes one more turn deep at a time until the
+//budget runs out and the last depth that finished gives the answer.
+//
+//a bot never peeks at the seed: rolls are chances and the tail of a snake it thinks about
+//is a guess, the real one is only drawn when GamePlaceSnake runs
+
+#define BOT_TABLE_BITS  16   //transposition table entries, keyed on the board and the seats
+#define BOT_MAX_DEPTH   12   //turns
+#define BOT_CANDIDATES  12   //heads tried where the bot places, the best by how likely the others land there
+#define BOT_INNER_CANDIDATES 4 //heads tried for a placement further down the tree
+#define BOT_TABLE_TILES 4096 //bigger boards estimate turns to go from the distance alone
+#define BOT_DEFAULT_MS  3.0
+
+typedef struct {
+    uint64_t key;
+    float value[MAX_PLAYERS];
+    int depth;
+} BotEntry;
+
+typedef struct {
+    double budgetMs; //0 searches to maxDepth whatever it takes, which is also repeatable
+    int maxDepth;
+    uint32_t seats;  //as a SnakePolicy, seats not in the mask place at random
+
+    BotEntry* table;
+    float* togo;     //expected own turns to finish from each tile of the board the search started on
+    int togoCap;
+    uint64_t togoKey;
+    int rootSnakes;  //snakes on that board, any after these were placed inside the search
+    uint64_t epoch;  //in every key, BotForget moves it on
+    double deadline;
+    bool stop;
+
+    //the last decision
+    uint64_t nodes;
+    int depth;
+    double ms;
+} Bot;
+
+bool BotInit(Bot* b, double budgetMs, int maxDepth, uint32_t seats);
+void BotFree(Bot* b);
+//drops what the table learned, so a decision doesn't depend on the games searched before it
+void BotForget(Bot* b);
+
+//the head g's current seat should place on now, 0 to keep the right for a later turn
+int  BotChooseHead(Bot* b, const Game* g);
+int  BotSnakePolicy(const Game* g, Rng* rng, void* ctx); //ctx is a Bot, one per thread
+
+//no search: the free tile the other seats are likeliest to land on with their next roll,
+//less the chance the placer lands there itself. ctx is unused
+int  GreedySnakePolicy(const Game* g, Rng* rng, void* ctx);
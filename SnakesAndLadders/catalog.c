@@ -0,0 +1,730 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include "catalog.h"
+#include "sys.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CATALOG_MAGIC   0x54434C53u //"SLCT"
+#define CATALOG_VERSION 2
+#define HEADER_LEN      16
+#define RECORD_LEN      252
+#define REC_REMOVED     1
+#define GONE_MTIME      INT64_MIN //never matches a real file, so a name that comes back is read again
+#define TEXT_MAX        (CATALOG_NAME_LEN + MAX_PLAYERS * (SAVE_NAME_LEN + 1)) //an entry's packed names, terminator included
+
+static uint32_t Rd32(const uint8_t* p) { return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24; }
+static uint64_t Rd64(const uint8_t* p) { return (uint64_t)Rd32(p) | (uint64_t)Rd32(p + 4) << 32; }
+static void Wr32(uint8_t* p, uint32_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); p[2] = (uint8_t)(v >> 16); p[3] = (uint8_t)(v >> 24); }
+static void Wr64(uint8_t* p, uint64_t v) { Wr32(p, (uint32_t)v); Wr32(p + 4, (uint32_t)(v >> 32)); }
+
+static uint32_t HashName(const char* s)
+{
+    uint32_t h = 2166136261u;
+    while (*s) h = (h ^ (uint8_t)*s++) * 16777619u;
+    return h;
+}
+
+static int Find(const Catalog* c, const char* name)
+{
+    if (!c->slotCap) {
+        return -1;
+    }
+    for (uint32_t i = HashName(name) & (c->slotCap - 1);; i = (i + 1) & (c->slotCap - 1)) {
+        int32_t idx = c->slots[i];
+        if (idx < 0) return -1;
+        if (strcmp(c->info[idx].file, name) == 0) return idx;
+    }
+}
+
+static int Rehash(Catalog* c, int slotCap)
+{
+    int32_t* slots = (int32_t*)malloc((size_t)slotCap * sizeof(int32_t));
+    if (!slots) {
+        return 0;
+    }
+    memset(slots, 0xFF, (size_t)slotCap * sizeof(int32_t));
+    for (int idx = 0; idx < c->count; idx++) {
+        uint32_t i = HashName(c->info[idx].file) & (slotCap - 1);
+        while (slots[i] >= 0) i = (i + 1) & (slotCap - 1);
+        slots[i] = idx;
+    }
+    free(c->slots);
+    c->slots = slots;
+    c->slotCap = slotCap;
+    return 1;
+}
+
+//new entry for name, or the one it already has
+static int Slot(Catalog* c, const char* name)
+{
+    int idx = Find(c, name);
+    if (idx >= 0) {
+        return idx;
+    }
+    if (c->count == c->cap) {
+        int cap = c->cap ? c->cap * 2 : 256;
+        CatalogKey* keys = (CatalogKey*)realloc(c->keys, (size_t)cap * sizeof(CatalogKey));
+        if (keys) c->keys = keys;
+        CatalogInfo* info = (CatalogInfo*)realloc(c->info, (size_t)cap * sizeof(CatalogInfo));
+        if (info) c->info = info;
+        uint8_t* seen = (uint8_t*)realloc(c->seen, (size_t)cap);
+        if (seen) c->seen = seen;
+        uint32_t* textAt = (uint32_t*)realloc(c->textAt, (size_t)cap * sizeof(uint32_t));
+        if (textAt) c->textAt = textAt;
+        CatalogGrams* grams = (CatalogGrams*)realloc(c->grams, (size_t)cap * sizeof(CatalogGrams));
+        if (grams) c->grams = grams;
+        if (!keys || !info || !seen || !textAt || !grams) {
+            return -1;
+        }
+        c->cap = cap;
+        c->orderStale = true; //order arrays are sized to cap
+    }
+    idx = c->count++;
+    memset(&c->keys[idx], 0, sizeof(CatalogKey));
+    memset(&c->info[idx], 0, sizeof(CatalogInfo));
+    strcpy(c->info[idx].file, name);
+    c->seen[idx] = 0;
+    c->textAt[idx] = CATALOG_TEXT_STALE;
+    memset(&c->grams[idx], 0, sizeof(CatalogGrams));
+    c->textStale = true;
+    if (c->count * 2 > c->slotCap) {
+        if (!Rehash(c, c->slotCap ? c->slotCap * 2 : 512)) {
+            c->count--;
+            return -1;
+        }
+    }
+    else {
+        uint32_t i = HashName(name) & (c->slotCap - 1);
+        while (c->slots[i] >= 0) i = (i + 1) & (c->slotCap - 1);
+        c->slots[i] = idx;
+    }
+    return idx;
+}
+
+//the names changed, the next query packs them again and the old copy is dead weight until
+//the blob is packed afresh
+static void MarkText(Catalog* c, int idx)
+{
+    if (c->textAt[idx] != CATALOG_TEXT_STALE) {
+        c->textDead += (uint32_t)strlen(c->text + c->textAt[idx]) + 1;
+        c->textAt[idx] = CATALOG_TEXT_STALE;
+    }
+    c->textStale = true;
+}
+
+static void Fill(Catalog* c, int idx, int64_t mtime, uint64_t size, const SaveState* s)
+{
+    CatalogKey* k = &c->keys[idx];
+    CatalogInfo* in = &c->info[idx];
+    char file[CATALOG_NAME_LEN];
+    strcpy(file, in->file);
+    memset(k, 0, sizeof(*k));
+    memset(in, 0, sizeof(*in));
+    strcpy(in->file, file);
+    k->mtime = mtime;
+    in->size = size;
+    in->winner = -1;
+    MarkText(c, idx);
+    if (!s) {
+        return; //not a save we can read, kept so the next sync doesn't try again
+    }
+
+    const Game* g = &s->game;
+    k->turn = (uint32_t)g->globalTurn;
+    k->mode = (uint8_t)g->mode;
+    k->playerCount = (uint8_t)g->playerCount;
+    k->diceCount = (uint8_t)g->diceCount;
+    for (int i = 0; i < g->playerCount; i++) {
+        memcpy(in->names[i], s->players[i].name, SAVE_NAME_LEN);
+        in->position[i] = (uint32_t)g->position[i];
+        if (in->position[i] > k->best) k->best = in->position[i];
+    }
+    in->winner = (int8_t)g->winner;
+    in->currentPlayer = (uint8_t)g->currentPlayer;
+    in->phase = (uint8_t)s->phase;
+    in->version = (uint8_t)s->version;
+}
+
+static void EncodeRecord(const Catalog* c, int idx, uint32_t flags, uint8_t* r)
+{
+    const CatalogKey* k = &c->keys[idx];
+    const CatalogInfo* in = &c->info[idx];
+    memset(r, 0, RECORD_LEN);
+    Wr32(r + 4, flags);
+    Wr64(r + 8, (uint64_t)k->mtime);
+    Wr64(r + 16, in->size);
+    Wr32(r + 24, k->turn);
+    r[28] = k->mode; r[29] = k->playerCount; r[30] = k->diceCount;
+    r[36] = (uint8_t)in->winner; r[37] = in->currentPlayer; r[38] = in->phase; r[39] = in->version;
+    memcpy(r + 40, in->file, CATALOG_NAME_LEN);
+    memcpy(r + 104, in->names, sizeof(in->names));
+    for (int i = 0; i < MAX_PLAYERS; i++) Wr32(r + 232 + 4 * i, in->position[i]);
+    Wr32(r + 248, k->best);
+    Wr32(r, Crc32(0, r + 4, RECORD_LEN - 4));
+}
+
+static int ApplyRecord(Catalog* c, const uint8_t* r)
+{
+    if (Crc32(0, r + 4, RECORD_LEN - 4) != Rd32(r) || !memchr(r + 40, 0, CATALOG_NAME_LEN)) {
+        return 0;
+    }
+    int idx = Slot(c, (const char*)(r + 40));
+    if (idx < 0) {
+        return 0;
+    }
+    CatalogKey* k = &c->keys[idx];
+    CatalogInfo* in = &c->info[idx];
+    if (Rd32(r + 4) & REC_REMOVED) {
+        Fill(c, idx, GONE_MTIME, 0, NULL);
+        return 1;
+    }
+    k->mtime = (int64_t)Rd64(r + 8);
+    in->size = Rd64(r + 16);
+    k->turn = Rd32(r + 24);
+    k->mode = r[28]; k->playerCount = r[29]; k->diceCount = r[30]; k->best = Rd32(r + 248);
+    for (int i = 0; i < MAX_PLAYERS; i++) in->position[i] = Rd32(r + 232 + 4 * i);
+    in->winner = (int8_t)r[36]; in->currentPlayer = r[37]; in->phase = r[38]; in->version = r[39];
+    memcpy(in->names, r + 104, sizeof(in->names));
+    for (int i = 0; i < MAX_PLAYERS; i++) in->names[i][SAVE_NAME_LEN - 1] = '\0';
+    if (k->playerCount > MAX_PLAYERS) k->playerCount = 0;
+    MarkText(c, idx);
+    return 1;
+}
+
+static void IndexPath(const Catalog* c, char* out, size_t len, const char* suffix)
+{
+    snprintf(out, len, "%s/%s%s", c->dir, CATALOG_FILE, suffix);
+}
+
+static void EncodeHeader(uint8_t* h)
+{
+    memset(h, 0, HEADER_LEN);
+    Wr32(h, CATALOG_MAGIC);
+    h[4] = CATALOG_VERSION;
+    h[6] = RECORD_LEN & 0xFF;
+    h[7] = RECORD_LEN >> 8;
+    Wr32(h + 12, Crc32(0, h, 12));
+}
+
+int CatalogOpen(Catalog* c, const char* dir)
+{
+    memset(c, 0, sizeof(*c));
+    snprintf(c->dir, sizeof(c->dir), "%s", dir);
+    c->orderStale = true;
+
+    char path[300];
+    IndexPath(c, path, sizeof(path), "");
+    SysMap m;
+    if (!SysMapFile(path, &m)) {
+        c->rewrite = true; //no index yet, the first sync writes one
+        return 1;
+    }
+    uint8_t h[HEADER_LEN];
+    EncodeHeader(h);
+    if (m.size < HEADER_LEN || memcmp(m.data, h, HEADER_LEN) != 0) {
+        c->rewrite = true;
+        SysUnmapFile(&m);
+        return 1;
+    }
+    size_t n = (m.size - HEADER_LEN) / RECORD_LEN;
+    for (size_t i = 0; i < n; i++) {
+        if (!ApplyRecord(c, m.data + HEADER_LEN + i * RECORD_LEN)) {
+            c->rewrite = true; //torn or damaged tail, everything after it is dropped
+            break;
+        }
+        c->records++;
+    }
+    if ((m.size - HEADER_LEN) % RECORD_LEN) c->rewrite = true;
+    SysUnmapFile(&m);
+    return 1;
+}
+
+void CatalogClose(Catalog* c)
+{
+    free(c->keys);
+    free(c->info);
+    free(c->seen);
+    free(c->slots);
+    free(c->match);
+    free(c->text);
+    free(c->textAt);
+    free(c->grams);
+    for (int s = 0; s < CATALOG_SORTS; s++) free(c->order[s]);
+    memset(c, 0, sizeof(*c));
+}
+
+static int AppendRecords(Catalog* c, const uint8_t* recs, int n)
+{
+    char path[300];
+    IndexPath(c, path, sizeof(path), "");
+    FILE* fp = fopen(path, "ab");
+    if (!fp) {
+        return 0;
+    }
+    int ok = fwrite(recs, RECORD_LEN, (size_t)n, fp) == (size_t)n;
+    ok = (fclose(fp) == 0) && ok;
+    c->records += n;
+    return ok;
+}
+
+//drops gone entries and writes the log fresh with one record per file
+static int Compact(Catalog* c)
+{
+    int kept = 0;
+    for (int i = 0; i < c->count; i++) {
+        if (c->keys[i].mtime == GONE_MTIME) continue;
+        c->keys[kept] = c->keys[i];
+        c->info[kept] = c->info[i];
+        kept++;
+    }
+    c->count = kept;
+    for (int i = 0; i < c->count; i++) c->textAt[i] = CATALOG_TEXT_STALE; //moved, the blob starts over
+    c->textLen = c->textDead = 0;
+    c->textStale = true;
+    if (!Rehash(c, c->slotCap ? c->slotCap : 512)) {
+        return 0;
+    }
+    c->orderStale = true;
+
+    char path[300], tmp[300];
+    IndexPath(c, path, sizeof(path), "");
+    IndexPath(c, tmp, sizeof(tmp), ".tmp");
+    FILE* fp = fopen(tmp, "wb");
+    if (!fp) {
+        return 0;
+    }
+    uint8_t buf[HEADER_LEN > RECORD_LEN ? HEADER_LEN : RECORD_LEN];
+    EncodeHeader(buf);
+    int ok = fwrite(buf, HEADER_LEN, 1, fp) == 1;
+    for (int i = 0; i < c->count && ok; i++) {
+        EncodeRecord(c, i, 0, buf);
+        ok = fwrite(buf, RECORD_LEN, 1, fp) == 1;
+    }
+    ok = (fclose(fp) == 0) && ok;
+    if (!ok || !SysReplaceFile(tmp, path)) {
+        remove(tmp);
+        return 0;
+    }
+    c->records = c->count;
+    c->rewrite = false;
+    return 1;
+}
+
+typedef struct {
+    Catalog* c;
+    uint8_t* pending; //records to append
+    int pendingCount, pendingCap;
+    bool failed;
+} SyncCtx;
+
+static void Queue(SyncCtx* x, int idx, uint32_t flags)
+{
+    if (x->pendingCount == x->pendingCap) {
+        int cap = x->pendingCap ? x->pendingCap * 2 : 64;
+        uint8_t* p = (uint8_t*)realloc(x->pending, (size_t)cap * RECORD_LEN);
+        if (!p) {
+            x->failed = true;
+            return;
+        }
+        x->pending = p;
+        x->pendingCap = cap;
+    }
+    EncodeRecord(x->c, idx, flags, x->pending + (size_t)x->pendingCount++ * RECORD_LEN);
+}
+
+static void SyncFile(const char* name, int64_t mtime, uint64_t size, void* ctx)
+{
+    SyncCtx* x = (SyncCtx*)ctx;
+    Catalog* c = x->c;
+    if (strlen(name) >= CATALOG_NAME_LEN) {
+        return;
+    }
+    int idx = Slot(c, name);
+    if (idx < 0) {
+        x->failed = true;
+        return;
+    }
+    c->seen[idx] = 1;
+    if (c->keys[idx].mtime == mtime && c->info[idx].size == size) {
+        return; //unchanged since it was indexed
+    }
+
+    char path[400];
+    snprintf(path, sizeof(path), "%s/%s", c->dir, name);
+    SaveState s;
+    Fill(c, idx, mtime, size, SaveRead(path, &s) ? &s : NULL);
+    Queue(x, idx, 0);
+    c->orderStale = true;
+}
+
+static int BuildOrders(Catalog* c);
+
+int CatalogSync(Catalog* c)
+{
+    SyncCtx x = { c, NULL, 0, 0, false };
+    if (c->count) memset(c->seen, 0, (size_t)c->count);
+    if (!SysListDir(c->dir, ".sav", SyncFile, &x)) {
+        free(x.pending);
+        return 0;
+    }
+
+    int gone = 0;
+    for (int i = 0; i < c->count; i++) {
+        if (c->seen[i] || c->keys[i].mtime == GONE_MTIME) continue;
+        Queue(&x, i, REC_REMOVED);
+        Fill(c, i, GONE_MTIME, 0, NULL);
+        c->orderStale = true;
+        gone++;
+    }
+
+    int ok = !x.failed;
+    if (c->rewrite || c->records + x.pendingCount > 2 * c->count + 1024) {
+        ok = Compact(c) && ok;
+    }
+    else if (x.pendingCount) {
+        ok = AppendRecords(c, x.pending, x.pendingCount) && ok;
+    }
+    free(x.pending);
+    if (c->orderStale) {
+        ok = BuildOrders(c) && ok; //the sort is paid here so listing never waits on it
+    }
+    return ok;
+}
+
+static int Compare(const Catalog* c, CatalogSort sort, int a, int b)
+{
+    const CatalogKey* ka = &c->keys[a];
+    const CatalogKey* kb = &c->keys[b];
+    int d = 0;
+    if (sort == CATALOG_BY_TIME) d = (ka->mtime > kb->mtime) - (ka->mtime < kb->mtime);
+    else if (sort == CATALOG_BY_TURN) d = (ka->turn > kb->turn) - (ka->turn < kb->turn);
+    else d = strcmp(c->info[a].file, c->info[b].file);
+    return d ? d : (a > b) - (a < b); //index breaks ties so every entry has one exact spot
+}
+
+//bottom up merge sort, qsort has no way to pass the catalog along. only used on runs of
+//names that share their first 8 bytes
+static void SortOrder(const Catalog* c, CatalogSort sort, int* a, int* tmp, int n)
+{
+    for (int width = 1; width < n; width *= 2) {
+        for (int lo = 0; lo < n; lo += 2 * width) {
+            int mid = lo + width < n ? lo + width : n;
+            int hi = lo + 2 * width < n ? lo + 2 * width : n;
+            int i = lo, j = mid, k = lo;
+            while (i < mid && j < hi) tmp[k++] = Compare(c, sort, a[i], a[j]) <= 0 ? a[i++] : a[j++];
+            while (i < mid) tmp[k++] = a[i++];
+            while (j < hi) tmp[k++] = a[j++];
+        }
+        memcpy(a, tmp, (size_t)n * sizeof(int));
+    }
+}
+
+typedef struct {
+    uint64_t key;
+    int idx;
+} SortItem;
+
+//the sort key as one unsigned number in the same order Compare gives, names only by their first 8 bytes
+static uint64_t SortKey(const Catalog* c, CatalogSort sort, int idx)
+{
+    if (sort == CATALOG_BY_TIME) return (uint64_t)c->keys[idx].mtime ^ (1ull << 63);
+    if (sort == CATALOG_BY_TURN) return c->keys[idx].turn;
+    uint64_t k = 0;
+    const char* name = c->info[idx].file;
+    for (int i = 0; i < 8; i++) {
+        k <<= 8;
+        if (*name) k |= (uint8_t)*name++;
+    }
+    return k;
+}
+
+//lsd radix, a byte a time, skipping bytes every key shares. stable, so ties stay in index order
+static SortItem* RadixSort(SortItem* a, SortItem* tmp, int n)
+{
+    for (int shift = 0; shift < 64; shift += 8) {
+        int count[257] = { 0 };
+        for (int i = 0; i < n; i++) count[((a[i].key >> shift) & 0xFF) + 1]++;
+        if (n == 0 || count[((a[0].key >> shift) & 0xFF) + 1] == n) {
+            continue;
+        }
+        for (int b = 0; b < 256; b++) count[b + 1] += count[b];
+        for (int i = 0; i < n; i++) tmp[count[(a[i].key >> shift) & 0xFF]++] = a[i];
+        SortItem* t = a; a = tmp; tmp = t;
+    }
+    return a;
+}
+
+static int BuildOrders(Catalog* c)
+{
+    size_t cap = (size_t)(c->cap ? c->cap : 1);
+    SortItem* items = (SortItem*)malloc(2 * cap * sizeof(SortItem));
+    int* tmp = (int*)malloc(cap * sizeof(int));
+    if (!items || !tmp) {
+        free(items); free(tmp);
+        return 0;
+    }
+    c->orderCount = 0;
+    for (int s = 0; s < CATALOG_SORTS; s++) {
+        int* o = (int*)realloc(c->order[s], cap * sizeof(int));
+        if (!o) {
+            free(items); free(tmp);
+            return 0;
+        }
+        c->order[s] = o;
+        int n = 0;
+        for (int i = 0; i < c->count; i++) {
+            if (c->keys[i].playerCount) items[n++] = (SortItem){ SortKey(c, (CatalogSort)s, i), i };
+        }
+        SortItem* sorted = RadixSort(items, items + cap, n);
+        for (int i = 0; i < n; i++) o[i] = sorted[i].idx;
+
+        //names with the same first 8 bytes still need a real compare
+        for (int lo = 0, hi; s == CATALOG_BY_NAME && lo < n; lo = hi) {
+            for (hi = lo + 1; hi < n && sorted[hi].key == sorted[lo].key; hi++);
+            if (hi - lo > 1) SortOrder(c, (CatalogSort)s, o + lo, tmp, hi - lo);
+        }
+        c->orderCount = n;
+    }
+    free(items);
+    free(tmp);
+    c->orderStale = false;
+    return 1;
+}
+
+//first spot in order s where idx is not below, the index tie break makes it exact
+static int Lower(const Catalog* c, CatalogSort s, int idx)
+{
+    int lo = 0, hi = c->orderCount;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (Compare(c, s, c->order[s][mid], idx) < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static void OrderRemove(Catalog* c, int idx)
+{
+    for (int s = 0; s < CATALOG_SORTS; s++) {
+        int at = Lower(c, (CatalogSort)s, idx);
+        memmove(&c->order[s][at], &c->order[s][at + 1], (size_t)(c->orderCount - at - 1) * sizeof(int));
+    }
+    c->orderCount--;
+}
+
+static void OrderInsert(Catalog* c, int idx)
+{
+    for (int s = 0; s < CATALOG_SORTS; s++) {
+        int at = Lower(c, (CatalogSort)s, idx);
+        memmove(&c->order[s][at + 1], &c->order[s][at], (size_t)(c->orderCount - at) * sizeof(int));
+        c->order[s][at] = idx;
+    }
+    c->orderCount++;
+}
+
+static const char* BaseName(const char* path)
+{
+    const char* b = path;
+    for (const char* p = path; *p; p++) {
+        if (*p == '/' || *p == '\\') b = p + 1;
+    }
+    return b;
+}
+
+//one save changed, so one record is appended and the sorted lists are patched in place
+int CatalogNote(Catalog* c, const char* path, const SaveState* s)
+{
+    const char* name = BaseName(path);
+    int64_t mtime;
+    uint64_t size;
+    if (strlen(name) >= CATALOG_NAME_LEN || !SysStat(path, &mtime, &size)) {
+        return 0;
+    }
+    int existing = Find(c, name);
+    bool patch = !c->orderStale;
+    if (patch && existing >= 0 && c->keys[existing].playerCount) {
+        OrderRemove(c, existing);
+    }
+    int idx = Slot(c, name);
+    if (idx < 0) {
+        return 0;
+    }
+    Fill(c, idx, mtime, size, s);
+    if (patch && !c->orderStale && c->keys[idx].playerCount) {
+        OrderInsert(c, idx);
+    }
+
+    uint8_t r[RECORD_LEN];
+    EncodeRecord(c, idx, 0, r);
+    if (c->rewrite) {
+        return Compact(c);
+    }
+    return AppendRecords(c, r, 1);
+}
+
+static char LowerCase(char ch)
+{
+    return (ch >= 'A' && ch <= 'Z') ? (char)(ch - 'A' + 'a') : ch;
+}
+
+static uint64_t GramBit(uint32_t h)
+{
+    return 1ull << ((h * 0x9E3779B1u) >> 26);
+}
+
+static CatalogGrams Grams(const char* s)
+{
+    CatalogGrams g = { 0 };
+    for (; s[0]; s++) {
+        g.letters |= GramBit((uint8_t)s[0]);
+        if (!s[1]) break;
+        uint32_t h = (uint8_t)s[0] * 131u + (uint8_t)s[1];
+        uint32_t m = h * 0x85EBCA6Bu;
+        g.pairs[m >> 31] |= GramBit(h);
+        if (s[2]) g.triples |= GramBit(h * 131u + (uint8_t)s[2]);
+    }
+    return g;
+}
+
+static int Bits(uint64_t x)
+{
+#if defined(_MSC_VER)
+    x = x - ((x >> 1) & 0x5555555555555555ull);
+    x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return (int)((x * 0x0101010101010101ull) >> 56);
+#else
+    return __builtin_popcountll(x);
+#endif
+}
+
+//strstr without its setup, which costs more than the search on names this short. q is
+//lowercase and s is packed text, so neither holds a capital to trip on
+static bool Holds(const char* s, const char* q, size_t len)
+{
+    for (; *s; s++) {
+        if (s[0] == q[0] && (len == 1 || (s[1] == q[1] && strncmp(s + 2, q + 2, len - 2) == 0))) return true;
+    }
+    return false;
+}
+
+//file and player names lowercased, one line each
+static int PackText(Catalog* c, int idx)
+{
+    char buf[TEXT_MAX];
+    const CatalogInfo* in = &c->info[idx];
+    int n = 0;
+    for (const char* s = in->file; *s; s++) buf[n++] = LowerCase(*s);
+    for (int p = 0; p < c->keys[idx].playerCount; p++) {
+        buf[n++] = '\n';
+        for (const char* s = in->names[p]; *s; s++) buf[n++] = LowerCase(*s);
+    }
+    buf[n++] = '\0';
+    if (c->textLen + (uint32_t)n > c->textCap) {
+        uint64_t cap = c->textCap ? 2ull * c->textCap : 65536;
+        while (cap < (uint64_t)c->textLen + (uint64_t)n) cap *= 2;
+        char* text = cap <= UINT32_MAX ? (char*)realloc(c->text, (size_t)cap) : NULL;
+        if (!text) {
+            return 0;
+        }
+        c->text = text;
+        c->textCap = (uint32_t)cap;
+    }
+    memcpy(c->text + c->textLen, buf, (size_t)n);
+    c->textAt[idx] = c->textLen;
+    c->grams[idx] = Grams(buf);
+    c->textLen += (uint32_t)n;
+    return 1;
+}
+
+//packs what changed since the last query, or everything once half the blob is dead
+static int RefreshText(Catalog* c)
+{
+    if (!c->textStale) {
+        return 1;
+    }
+    if (c->textDead > c->textLen / 2) {
+        for (int i = 0; i < c->count; i++) c->textAt[i] = CATALOG_TEXT_STALE;
+        c->textLen = c->textDead = 0;
+    }
+    for (int i = 0; i < c->count; i++) {
+        if (c->textAt[i] == CATALOG_TEXT_STALE && !PackText(c, i)) return 0;
+    }
+    c->textStale = false;
+    return 1;
+}
+
+int CatalogQuery(Catalog* c, CatalogSort sort, bool descending, const CatalogFilter* f, int skip, int* out, int max, int* rows)
+{
+    *rows = 0;
+    if (c->orderStale && !BuildOrders(c)) {
+        return 0;
+    }
+    const int* o = c->order[sort];
+    int n = c->orderCount;
+
+    if (!f) {
+        //no filter, the page is a straight copy out of the sorted list
+        for (int i = 0; i < max && skip + i < n; i++) {
+            out[i] = o[descending ? n - 1 - (skip + i) : skip + i];
+            (*rows)++;
+        }
+        return n;
+    }
+
+    //keys are scanned in storage order into a bitmap, then the sorted walk only tests bits
+    size_t words = (size_t)c->count / 64 + 1;
+    if (words > c->matchWords) {
+        uint64_t* m = (uint64_t*)realloc(c->match, words * sizeof(uint64_t));
+        if (!m) {
+            return 0;
+        }
+        c->match = m;
+        c->matchWords = words;
+    }
+    //text is lowercased once and turned into grams, an entry missing any of them is out before
+    //its names are read
+    bool text = f->text && f->text[0];
+    char q[TEXT_MAX];
+    CatalogGrams want = { 0 };
+    size_t len = 0;
+    if (text) {
+        len = strlen(f->text);
+        if (len >= sizeof(q) || !RefreshText(c)) {
+            return 0; //longer than any entry's names, or no memory to pack them
+        }
+        for (size_t i = 0; i < len; i++) q[i] = LowerCase(f->text[i]);
+        q[len] = '\0';
+        want = Grams(q);
+    }
+    uint32_t minTurn = (uint32_t)f->minTurn, maxTurn = f->maxTurn ? (uint32_t)f->maxTurn : UINT32_MAX;
+    int total = 0;
+    for (size_t w = 0; w < words; w++) {
+        uint64_t bits = 0;
+        int first = (int)(w * 64), last = first + 64 < c->count ? first + 64 : c->count;
+        for (int i = first; i < last; i++) {
+            const CatalogKey* k = &c->keys[i];
+            //an empty key is a removed or unreadable file, it holds no names and isn't in order
+            int hit = (k->playerCount != 0) & (f->mode < 0 || k->mode == f->mode) & (!f->playerCount || k->playerCount == f->playerCount) &
+                      (k->turn >= minTurn) & (k->turn <= maxTurn) &
+                      ((c->grams[i].letters & want.letters) == want.letters) & ((c->grams[i].pairs[0] & want.pairs[0]) == want.pairs[0]) &
+                      ((c->grams[i].pairs[1] & want.pairs[1]) == want.pairs[1]) &
+                      ((c->grams[i].triples & want.triples) == want.triples);
+            if (hit && text) hit = Holds(c->text + c->textAt[i], q, len);
+            bits |= (uint64_t)hit << (i - first);
+        }
+        c->match[w] = bits;
+        total += Bits(bits);
+    }
+
+    //the count came out of the bitmap, so the walk stops once the page is full
+    int seen = 0;
+    for (int i = 0; i < n && seen < skip + max; i++) {
+        int idx = o[descending ? n - 1 - i : i];
+        if (!((c->match[idx >> 6] >> (idx & 63)) & 1)) continue;
+        if (seen >= skip) out[(*rows)++] = idx;
+        seen++;
+    }
+    return total;
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <stdbool.h>
+#include "save.h"
+
+//index of the saves in a folder, kept in <dir>/saves.idx so the load list never opens a save.
+//the index file is an append only log of fixed size records and the last record for a name
+//wins, so a save appends one record and a torn write loses at most that one.
+//CatalogSync squares it with the folder by mtime and size and only reads saves that changed
+
+#define CATALOG_FILE     "saves.idx"
+#define CATALOG_NAME_LEN 64 //longer file names are left out
+#define CATALOG_TEXT_STALE UINT32_MAX
+
+typedef enum {
+    CATALOG_BY_TIME,
+    CATALOG_BY_TURN,
+    CATALOG_BY_NAME,
+    CATALOG_SORTS
+} CatalogSort;
+
+//the fields the list sorts and filters on, kept apart from the rest so a scan stays in cache
+typedef struct {
+    int64_t mtime;
+    uint32_t turn;
+    uint8_t mode;
+    uint8_t playerCount; //0 for files that aren't saves or are gone, those never list
+    uint8_t diceCount;
+    uint32_t best;       //furthest tile anyone is on
+} CatalogKey;
+
+typedef struct {
+    char file[CATALOG_NAME_LEN];
+    char names[MAX_PLAYERS][SAVE_NAME_LEN];
+    uint32_t position[MAX_PLAYERS];
+    uint64_t size;
+    int8_t winner;
+    uint8_t currentPlayer;
+    uint8_t phase;
+    uint8_t version;
+} CatalogInfo;
+
+typedef struct {
+    int mode;             //-1 for any
+    int playerCount;      //0 for any
+    int minTurn, maxTurn; //maxTurn 0 for no limit
+    const char* text;     //part of the file name or a player name, any case, NULL for any
+} CatalogFilter;
+
+//the letters, runs of two and runs of three in an entry's names, each hashed to a bit. an entry
+//holds a text only if it has every bit the text has, so most are ruled out without reading names
+typedef struct {
+    uint64_t letters;
+    uint64_t pairs[2];  //two words, a short text leans on its pairs alone
+    uint64_t triples;
+} CatalogGrams;
+
+typedef struct {
+    char dir[260];
+    CatalogKey* keys;
+    CatalogInfo* info;
+    uint8_t* seen;
+    int count, cap;
+    int32_t* slots; //open addressing on the file name, -1 is empty
+    int slotCap;
+    int* order[CATALOG_SORTS]; //listed entries in ascending order for each sort
+    int orderCount;
+    bool orderStale;
+    uint64_t* match; //filter hits by entry, reused between queries
+    size_t matchWords;
+    char* text;      //each entry's file and player names lowercased, packed end to end
+    uint32_t textLen, textCap, textDead;
+    uint32_t* textAt; //entry's names in text, CATALOG_TEXT_STALE until the next query packs them
+    CatalogGrams* grams;
+    bool textStale;
+    int records;    //records in the log, replaced ones included
+    bool rewrite;   //log had a torn tail or a bad header
+} Catalog;
+
+int  CatalogOpen(Catalog* c, const char* dir); //reads the index only, no folder scan
+void CatalogClose(Catalog* c);
+int  CatalogSync(Catalog* c);
+int  CatalogNote(Catalog* c, const char* path, const SaveState* s); //call after every successful save
+
+//returns how many entries match, out gets up to max of them starting at match number skip and
+//rows how many it got. removed and unreadable files never match
+int  CatalogQuery(Catalog* c, CatalogSort sort, bool descending, const CatalogFilter* f, int skip, int* out, int max, int* rows);
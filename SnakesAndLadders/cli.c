@@ -0,0 +1,705 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include "cli.h"
+#include "bot.h"
+#include "catalog.h"
+#include "design.h"
+#include "game.h"
+#include "journal.h"
+#include "rules.h"
+#include "server.h"
+#include "sim.h"
+#include "solver.h"
+#include "sys.h"
+#include "tourney.h"
+#include "traj.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static void Usage(void)
+{
+    puts("usage:");
+    puts("  SnakesAndLadders sim [games] [seed] [players 2-4] [dice 1-2] [classic|chaos] [threads] [rules] [stats every sec] [trajectory file]");
+    puts("  SnakesAndLadders traj <trajectory file> [from tile] [to tile] [threads]");
+    puts("  SnakesAndLadders bot [games] [seed] [ms per move] [players 2-4] [dice 1-2]");
+    puts("  SnakesAndLadders tourney <a,b,...> [matches per seating] [seed] [players 2-4] [dice 1-2] [rr|swiss] [rounds] [threads] [csv]");
+    puts("  SnakesAndLadders solve [players 1-4] [dice 1-2] [width] [height] [max turns]");
+    puts("  SnakesAndLadders design [layouts] [seed] [target turns,...] [snakes] [ladders] [dice 1-2] [players 1-4] [top] [spread weight] [side] [threads]");
+    puts("  SnakesAndLadders roll <seed> <turn> [dice 1-2]");
+    puts("  SnakesAndLadders saves [dir] [time|turn|name] [text]");
+    puts("  SnakesAndLadders record <journal> [seed] [players 2-4] [dice 1-2] [classic|chaos]");
+    puts("  SnakesAndLadders replay <journal> [turn]");
+    puts("  SnakesAndLadders serve [addr] [max sessions] [seconds] [dir]");
+    puts("  SnakesAndLadders load [addr] [connections] [sessions each] [seconds]");
+}
+
+//parses the optional game setup shared by the tools, from argv[first] on
+static int ParseSetup(int argc, char** argv, int first, SimConfig* cfg)
+{
+    cfg->playerCount = 2;
+    cfg->diceCount = 1;
+    cfg->mode = MODE_CLASSIC;
+    cfg->policy = RandomSnakePolicy;
+    cfg->policyCtx = NULL;
+    cfg->rules = 0;
+
+    if (argc > first) cfg->playerCount = atoi(argv[first]);
+    if (argc > first + 1) cfg->diceCount = atoi(argv[first + 1]);
+    if (argc > first + 2) cfg->mode = strcmp(argv[first + 2], "chaos") == 0 ? MODE_CHAOS : MODE_CLASSIC;
+
+    if (cfg->playerCount < 2 || cfg->playerCount > MAX_PLAYERS || cfg->diceCount < 1 || cfg->diceCount > 2) {
+        fprintf(stderr, "bad players/dice\n");
+        return 0;
+    }
+    return 1;
+}
+
+static void DumpStats(const Stats* sofar, double seconds, void* ctx)
+{
+    (void)ctx;
+    StatsWriteJson(stderr, sofar, seconds);
+}
+
+//the n most hit tiles of counts, tiles numbered from 1
+static void PrintHot(const char* label, const int64_t* counts, double games, int n)
+{
+    bool taken[STATS_TILES] = { false };
+    printf("%-13s", label);
+    for (int k = 0; k < n; k++) {
+        int best = -1;
+        for (int t = 0; t < STATS_TILES; t++) {
+            if (!taken[t] && counts[t] > 0 && (best < 0 || counts[t] > counts[best])) best = t;
+        }
+        if (best < 0) break;
+        taken[best] = true;
+        printf("%s%d (%.3f)", k ? ", " : "", best + 1, counts[best] / games);
+    }
+    printf("\n");
+}
+
+static int CmdSim(int argc, char** argv)
+{
+    long long games = (argc > 2) ? atoll(argv[2]) : 1000000;
+    uint64_t seed = (argc > 3) ? strtoull(argv[3], NULL, 10) : (uint64_t)time(NULL);
+    int threads = (argc > 7) ? atoi(argv[7]) : 0;
+    SimConfig cfg;
+    if (games < 1 || !ParseSetup(argc, argv, 4, &cfg)) {
+        return 1;
+    }
+    if (argc > 8 && !RulesParse(argv[8], &cfg.rules)) {
+        fprintf(stderr, "bad rules, want classic or a mix of exact+six+three+doubles\n");
+        return 1;
+    }
+
+    //a dump interval turns on counting, 0 counts without dumping. a trajectory file also moves
+    //classic games off the vector lanes onto the counting loop
+    SimStats stats = { 0 };
+    stats.dump = DumpStats;
+    if (argc > 9) stats.every = atof(argv[9]);
+    TrajWriter traj;
+    if (argc > 10) {
+        if (!TrajWriterOpen(&traj, argv[10], &cfg, (uint64_t)games, seed)) {
+            fprintf(stderr, "can't write %s\n", argv[10]);
+            return 1;
+        }
+        stats.traj = &traj;
+    }
+
+    SimSummary s;
+    int ran = RunSimulationStats(&cfg, (uint64_t)games, seed, threads, argc > 9 ? &stats : NULL, &s);
+    if (argc > 10 && !TrajWriterClose(&traj)) {
+        fprintf(stderr, "writing %s failed\n", argv[10]);
+        ran = 0;
+    }
+    if (!ran) {
+        fprintf(stderr, "simulation failed\n");
+        return 1;
+    }
+
+    double n = (double)s.games;
+    char rules[64];
+    RulesName(cfg.rules, rules, sizeof(rules));
+    printf("games        %llu\n", (unsigned long long)s.games);
+    if (cfg.rules) printf("rules        %s\n", rules);
+    printf("avg turns    %.3f (p50 %d, p99 %d)\n", s.turns / n, SimTurnPercentile(&s, 50), SimTurnPercentile(&s, 99));
+    printf("snake hits   %.3f per game\n", s.snakeHits / n);
+    printf("ladder hits  %.3f per game\n", s.ladderHits / n);
+    printf("bounces      %.3f per game\n", s.bounces / n);
+    if (cfg.mode == MODE_CHAOS) printf("snakes put   %.3f per game\n", s.snakesPlaced / n);
+    for (int p = 0; p < cfg.playerCount; p++) {
+        printf("seat %d wins  %.4f\n", p + 1, s.wins[p] / n);
+    }
+    if (s.unfinished) printf("unfinished   %llu\n", (unsigned long long)s.unfinished);
+    if (argc > 9) {
+        const Stats* t = &stats.total;
+        int64_t rolls = 0;
+        for (int r = 1; r < STATS_ROLLS; r++) rolls += t->rollTotals[r];
+        printf("rolls        ");
+        for (int r = 1; r < STATS_ROLLS; r++) {
+            if (t->rollTotals[r]) printf("%d:%.4f ", r, (double)t->rollTotals[r] / (double)rolls);
+        }
+        printf("\n");
+        PrintHot("snake heads", t->snakeTiles, n, 3);
+        PrintHot("ladder feet", t->ladderTiles, n, 3);
+        if (cfg.mode == MODE_CHAOS) {
+            printf("chaos hits   %.3f per game, %.3f per snake put\n", t->chaosHits / n, t->chaosPlaced ? (double)t->chaosHits / (double)t->chaosPlaced : 0.0);
+        }
+    }
+    printf("threads      %d\n", s.threads);
+    printf("games/sec    %.0f\n", s.seconds > 0 ? n / s.seconds : 0.0);
+    return 0;
+}
+
+//rolls each token took from tiles lo..hi, read off a file sim wrote
+static int CmdTraj(int argc, char** argv)
+{
+    if (argc < 3) {
+        Usage();
+        return 1;
+    }
+    int lo = (argc > 3) ? atoi(argv[3]) : 90;
+    int hi = (argc > 4) ? atoi(argv[4]) : 99;
+    int threads = (argc > 5) ? atoi(argv[5]) : 0;
+    TrajReader r;
+    if (!TrajOpen(&r, argv[2])) {
+        fprintf(stderr, "can't read %s\n", argv[2]);
+        return 1;
+    }
+    enum { BUCKETS = 64 };
+    uint64_t hist[BUCKETS];
+    double t0 = SysNow();
+    if (!TrajTileTurns(&r, lo, hi, threads, hist, BUCKETS)) {
+        fprintf(stderr, "bad tile range\n");
+        TrajClose(&r);
+        return 1;
+    }
+    double seconds = SysNow() - t0;
+
+    char rules[64];
+    RulesName(r.header->rules, rules, sizeof(rules));
+    printf("games        %llu in %llu chunks, seed %llu\n", (unsigned long long)r.games, (unsigned long long)r.chunks, (unsigned long long)r.header->seed);
+    printf("setup        %d players, %d dice, %s, %s\n", r.header->players, r.header->dice, r.header->mode == MODE_CHAOS ? "chaos" : "classic", rules);
+    printf("moves        %llu, %.2f bits each\n", (unsigned long long)r.moves, r.moves ? 8.0 * (double)r.map.size / (double)r.moves : 0.0);
+
+    uint64_t tokens = 0;
+    double sum = 0.0;
+    for (int b = 0; b < BUCKETS; b++) {
+        tokens += hist[b];
+        sum += (double)b * (double)hist[b];
+    }
+    printf("tiles %d-%d  %.3f rolls per token per game\n", lo, hi, tokens ? sum / (double)tokens : 0.0);
+    const double pcts[] = { 50, 90, 99 };
+    for (int k = 0; k < 3 && tokens; k++) {
+        uint64_t want = (uint64_t)(tokens * pcts[k] / 100.0), seen = 0;
+        int b = 0;
+        for (; b < BUCKETS - 1; b++) {
+            seen += hist[b];
+            if (seen > want) break;
+        }
+        printf("%s p%.0f %d", k ? "," : "            ", pcts[k], b);
+    }
+    printf("\n");
+    for (int b = 0; b < BUCKETS && tokens; b++) {
+        if (hist[b] * 1000 >= tokens) printf("  %2d%s %.4f\n", b, b == BUCKETS - 1 ? "+" : " ", (double)hist[b] / (double)tokens);
+    }
+    printf("scanned in   %.3f s, %.0f moves/sec\n", seconds, seconds > 0 ? (double)r.moves / seconds : 0.0);
+    TrajClose(&r);
+    return 0;
+}
+
+//chaos games with one bot seat against seats placing at random, the bot moving round the
+//seats game by game so going first doesn't count for it
+static int CmdBot(int argc, char** argv)
+{
+    long long games = (argc > 2) ? atoll(argv[2]) : 1000;
+    uint64_t seed = (argc > 3) ? strtoull(argv[3], NULL, 10) : (uint64_t)time(NULL);
+    double ms = (argc > 4) ? atof(argv[4]) : BOT_DEFAULT_MS;
+    SimConfig cfg;
+    if (games < 1 || ms < 0 || !ParseSetup(argc, argv, 5, &cfg)) {
+        return 1;
+    }
+    Bot bot;
+    if (!BotInit(&bot, ms, ms > 0 ? BOT_MAX_DEPTH : 2, 0)) {
+        return 1;
+    }
+    cfg.mode = MODE_CHAOS;
+    cfg.policy = BotSnakePolicy;
+    cfg.policyCtx = &bot;
+
+    long long wins = 0, decisions = 0, placed = 0, depths = 0;
+    double spent = 0.0, slowest = 0.0;
+    for (long long i = 0; i < games; i++) {
+        int seat = (int)(i % cfg.playerCount);
+        bot.seats = 1u << seat;
+        Game g;
+        GameInit(&g, cfg.playerCount, cfg.diceCount, cfg.mode, GameSeed(seed, (uint64_t)i));
+        //SimulateGame with the bot's decisions timed
+        while (g.winner < 0 && g.globalTurn < MAX_GAME_TURNS) {
+            if (g.canPlace[g.currentPlayer]) {
+                Rng rng = RngAt(g.seed, (uint64_t)g.globalTurn, RNG_POLICY);
+                int head = BotSnakePolicy(&g, &rng, &bot);
+                if (g.currentPlayer == seat) {
+                    decisions++;
+                    depths += bot.depth;
+                    spent += bot.ms;
+                    if (bot.ms > slowest) slowest = bot.ms;
+                    placed += head != 0;
+                }
+                if (head) GamePlaceSnake(&g, head);
+            }
+            int da, db;
+            GameMove(&g, RollDice(&g, &da, &db));
+        }
+        wins += g.winner == seat;
+    }
+    BotFree(&bot);
+
+    printf("games        %lld\n", games);
+    printf("bot wins     %.4f (even odds %.4f)\n", (double)wins / (double)games, 1.0 / cfg.playerCount);
+    printf("decisions    %lld, %.1f%% placed\n", decisions, decisions ? 100.0 * (double)placed / (double)decisions : 0.0);
+    if (decisions) printf("per decision %.3f ms avg, %.3f ms worst, depth %.2f\n", spent / (double)decisions, slowest, (double)depths / (double)decisions);
+    return 0;
+}
+
+//entrants are none, random, greedy, bot (fixed depth) or bot:<ms>
+static int CmdTourney(int argc, char** argv)
+{
+    if (argc < 3) {
+        Usage();
+        return 1;
+    }
+    TourneyConfig* cfg = (TourneyConfig*)calloc(1, sizeof(TourneyConfig));
+    TourneyResult* r = (TourneyResult*)malloc(sizeof(TourneyResult));
+    if (!cfg || !r) {
+        free(cfg);
+        free(r);
+        return 1;
+    }
+    char list[512];
+    snprintf(list, sizeof(list), "%s", argv[2]);
+    for (char* tok = strtok(list, ","); tok; tok = strtok(NULL, ",")) {
+        if (cfg->entrantCount == TOURNEY_MAX_ENTRANTS || !EntrantParse(tok, &cfg->entrants[cfg->entrantCount++])) {
+            fprintf(stderr, "bad entrant %s, want none, random, greedy, bot or bot:<ms>\n", tok);
+            free(cfg);
+            free(r);
+            return 1;
+        }
+    }
+    cfg->repeats = (argc > 3) ? atoi(argv[3]) : 1000;
+    cfg->seed = (argc > 4) ? strtoull(argv[4], NULL, 10) : (uint64_t)time(NULL);
+    cfg->seats = (argc > 5) ? atoi(argv[5]) : 2;
+    cfg->diceCount = (argc > 6) ? atoi(argv[6]) : 1;
+    cfg->format = (argc > 7 && strcmp(argv[7], "swiss") == 0) ? TOURNEY_SWISS : TOURNEY_ROUND_ROBIN;
+    cfg->rounds = (argc > 8) ? atoi(argv[8]) : 8;
+    cfg->threads = (argc > 9) ? atoi(argv[9]) : 0;
+    if (argc > 10 && !(cfg->csv = fopen(argv[10], "w"))) {
+        fprintf(stderr, "can't write %s\n", argv[10]);
+        free(cfg);
+        free(r);
+        return 1;
+    }
+
+    int ok = cfg->diceCount >= 1 && cfg->diceCount <= 2 && RunTourney(cfg, r);
+    if (cfg->csv && fclose(cfg->csv) != 0) ok = 0;
+    if (!ok) {
+        fprintf(stderr, "tournament failed, swiss wants 2 players and every match needs that many entrants\n");
+        free(cfg);
+        free(r);
+        return 1;
+    }
+
+    double m = (double)r->matches;
+    printf("matches      %llu (%.0f/sec on %d threads), %.2f turns avg\n", (unsigned long long)r->matches, r->seconds > 0 ? m / r->seconds : 0.0, r->threads, r->turns / m);
+    if (r->unfinished) printf("unfinished   %llu\n", (unsigned long long)r->unfinished);
+    int order[TOURNEY_MAX_ENTRANTS];
+    for (int i = 0; i < cfg->entrantCount; i++) {
+        int j = i;
+        for (; j > 0 && r->elo[order[j - 1]] < r->elo[i]; j--) order[j] = order[j - 1];
+        order[j] = i;
+    }
+    printf("%-*s %10s %8s %9s\n", TOURNEY_NAME_LEN, "entrant", "games", "win %", "elo");
+    for (int k = 0; k < cfg->entrantCount; k++) {
+        int i = order[k];
+        double games = (double)r->games[i];
+        printf("%-*s %10llu %8.2f %+9.1f +-%.1f\n", TOURNEY_NAME_LEN, cfg->entrants[i].name, (unsigned long long)r->games[i],
+            games > 0 ? 100.0 * (double)r->wins[i] / games : 0.0, r->elo[i], r->eloCi[i]);
+    }
+    //seats of a match are always played in order, so this is what going first is worth
+    for (int s = 0; s < cfg->seats; s++) {
+        double p = r->seatWins[s] / m;
+        printf("seat %d wins  %.4f +-%.4f (even %.4f)\n", s + 1, p, 1.96 * sqrt(p * (1.0 - p) / m), 1.0 / cfg->seats);
+    }
+    free(cfg);
+    free(r);
+    return 0;
+}
+
+//exact odds for a fresh game, a tiles count other than 100 stretches the default layout to that size.
+//the distribution stops at max turns, by default what SOLVE_WORK buys: see solver.h for the cost
+static int CmdSolve(int argc, char** argv)
+{
+    int seats = (argc > 2) ? atoi(argv[2]) : 2;
+    int dice = (argc > 3) ? atoi(argv[3]) : 1;
+    int width = (argc > 4) ? atoi(argv[4]) : BOARD_SIZE;
+    int height = (argc > 5) ? atoi(argv[5]) : width;
+    int maxTurns = (argc > 6) ? atoi(argv[6]) : 0;
+    if (seats < 1 || seats > MAX_PLAYERS || dice < 1 || dice > 2 || maxTurns < 0 ||
+        width < BOARD_MIN_SIDE || width > BOARD_MAX_SIDE || height < BOARD_MIN_SIDE || height > BOARD_MAX_SIDE) {
+        fprintf(stderr, "bad players/dice/sides, sides are %d to %d\n", BOARD_MIN_SIDE, BOARD_MAX_SIDE);
+        return 1;
+    }
+
+    //the board the game and the simulator play on that size
+    Board b;
+    BoardInit(&b, width, height);
+    int tiles = b.tiles;
+    int* jump = (int*)malloc(((size_t)tiles + 1) * sizeof(int));
+    if (!jump) {
+        return 1;
+    }
+    for (int t = 0; t <= tiles; t++) jump[t] = t;
+    for (int i = 0; i < b.snakeCount; i++) jump[b.snakes[i].start] = b.snakes[i].end;
+    for (int i = 0; i < b.ladderCount; i++) jump[b.ladders[i].start] = b.ladders[i].end;
+
+    int start[MAX_PLAYERS] = { 1, 1, 1, 1 };
+    ChainSpec spec = { tiles, jump, dice, maxTurns };
+    SolveResult r;
+    clock_t t0 = clock();
+    int ok = SolveChain(&spec, start, seats, 0, &r);
+    double ms = 1000.0 * (double)(clock() - t0) / CLOCKS_PER_SEC;
+    free(jump);
+    if (!ok) {
+        fprintf(stderr, "solve failed\n");
+        return 1;
+    }
+
+    printf("board          %dx%d, %d tiles\n", width, height, tiles);
+    printf("own turns      %.6f expected per token, sd %.6f\n", r.expectedOwnTurns[0], r.sdOwnTurns[0]);
+    //a cut distribution only has the games that ended by then, so their odds are floors
+    if (!r.cut) printf("game turns     %.6f expected\n", r.expectedGameTurns);
+    for (int s = 0; s < seats; s++) {
+        printf("seat %d wins    %s%.6f\n", s + 1, r.cut ? ">= " : "", r.winProb[s]);
+    }
+    double cum = 0.0;
+    int marks[] = { 50, 90, 99 };
+    for (int n = 1, m = 0; n < r.lengthCount && m < 3; n++) {
+        cum += r.gameLength[n];
+        while (m < 3 && cum * 100.0 >= marks[m]) {
+            printf("p%-2d game       %d turns\n", marks[m++], n);
+        }
+    }
+    printf("unresolved     %.3g\n", r.unresolved);
+    if (r.cut) {
+        printf("cut at turn    %d of each token's own, raise max turns for the rest at turns x tiles\n", r.turnCount - 1);
+    }
+    printf("solved in      %.2f ms\n", ms);
+    SolveResultFree(&r);
+    return 0;
+}
+
+static void PrintLinks(const char* kind, const SnakeOrLadder* links, int count)
+{
+    printf("    %-8s", kind);
+    for (int i = 0; i < count; i++) printf(" %d-%d", links[i].start, links[i].end);
+    printf("\n");
+}
+
+//the best boards for each target, one cache across the targets so the second one on never
+//solves a layout again. the kept boards get the full solve for the game they'd make
+static int CmdDesign(int argc, char** argv)
+{
+    DesignConfig cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.layouts = (argc > 2) ? strtoull(argv[2], NULL, 10) : 100000;
+    cfg.seed = (argc > 3) ? strtoull(argv[3], NULL, 10) : (uint64_t)time(NULL);
+    const char* targets = (argc > 4) ? argv[4] : "25";
+    cfg.snakes = (argc > 5) ? atoi(argv[5]) : 5;
+    cfg.ladders = (argc > 6) ? atoi(argv[6]) : 5;
+    cfg.diceCount = (argc > 7) ? atoi(argv[7]) : 1;
+    int seats = (argc > 8) ? atoi(argv[8]) : 2;
+    cfg.top = (argc > 9) ? atoi(argv[9]) : 5;
+    cfg.spreadWeight = (argc > 10) ? atof(argv[10]) : 0.25;
+    cfg.width = cfg.height = (argc > 11) ? atoi(argv[11]) : BOARD_SIZE;
+    cfg.threads = (argc > 12) ? atoi(argv[12]) : 0;
+    cfg.minLength = 4;
+    cfg.maxLength = cfg.width * cfg.height / 2;
+    if (seats < 1 || seats > MAX_PLAYERS) {
+        fprintf(stderr, "bad players\n");
+        return 1;
+    }
+
+    Board b;
+    BoardInit(&b, cfg.width, cfg.height);
+    printf("default      %s\n", DesignFlawName(DesignCheck(&b, cfg.diceCount)));
+
+    DesignCache cache;
+    DesignResult* r = (DesignResult*)malloc(sizeof(DesignResult));
+    if (!r || !DesignCacheInit(&cache)) {
+        free(r);
+        return 1;
+    }
+    cfg.cache = &cache;
+    int ok = 1;
+    char list[256];
+    snprintf(list, sizeof(list), "%s", targets);
+    for (char* tok = strtok(list, ","); tok && ok; tok = strtok(NULL, ",")) {
+        cfg.targetTurns = atof(tok);
+        if (!(ok = RunDesign(&cfg, r))) {
+            fprintf(stderr, "design failed, check the counts, the side (10 to 100) and top (1 to %d)\n", DESIGN_MAX_TOP);
+            break;
+        }
+        printf("target       %.2f own turns, sd weighs %.2f\n", cfg.targetTurns, cfg.spreadWeight);
+        printf("layouts      %llu (%.0f/sec on %d threads), %llu solved, %llu duplicates, %llu from cache\n", (unsigned long long)r->drawn,
+            r->seconds > 0 ? (double)r->drawn / r->seconds : 0.0, r->threads, (unsigned long long)r->solved,
+            (unsigned long long)r->duplicates, (unsigned long long)r->cached);
+        printf("rejected     %llu no room", (unsigned long long)r->noRoom);
+        for (int f = DESIGN_OK + 1; f < DESIGN_FLAWS; f++) printf(", %llu %s", (unsigned long long)r->flawed[f], DesignFlawName((DesignFlaw)f));
+        printf("\n");
+
+        for (int k = 0; k < r->topCount; k++) {
+            const DesignEntry* e = &r->top[k];
+            DesignToBoard(&e->layout, cfg.width, cfg.height, &b);
+            Game g;
+            GameInit(&g, seats, cfg.diceCount, MODE_CLASSIC, 0);
+            g.board = b;
+            SolveResult s;
+            printf("#%-2d layout %llu, score %.3f, own turns %.2f sd %.2f", k + 1, (unsigned long long)e->index, e->score, e->mean, e->sd);
+            if (SolveGame(&g, &s)) {
+                if (!s.cut) printf(", game %.2f turns, seat 1 wins %.4f", s.expectedGameTurns, s.winProb[0]);
+                SolveResultFree(&s);
+            }
+            printf("\n");
+            PrintLinks("ladders", e->layout.ladders, e->layout.ladderCount);
+            PrintLinks("snakes", e->layout.snakes, e->layout.snakeCount);
+        }
+    }
+    DesignCacheFree(&cache);
+    free(r);
+    return ok ? 0 : 1;
+}
+
+//the dice of any turn of a reported game, turns count from 0 like the HUD's total before the roll
+static int CmdRoll(int argc, char** argv)
+{
+    if (argc < 4) {
+        Usage();
+        return 1;
+    }
+    uint64_t seed = strtoull(argv[2], NULL, 10);
+    int turn = atoi(argv[3]);
+    int dice = (argc > 4) ? atoi(argv[4]) : 1;
+    int a, b;
+    int total = DiceAt(seed, turn, dice == 2 ? 2 : 1, &a, &b);
+    if (dice == 2) printf("turn %d: %d + %d = %d\n", turn, a, b, total);
+    else printf("turn %d: %d\n", turn, total);
+    return 0;
+}
+
+//brings the folder's catalog up to date and lists the newest (or by turn / name) matching saves
+static int CmdSaves(int argc, char** argv)
+{
+    const char* dir = (argc > 2) ? argv[2] : ".";
+    CatalogSort sort = CATALOG_BY_TIME;
+    if (argc > 3 && strcmp(argv[3], "turn") == 0) sort = CATALOG_BY_TURN;
+    if (argc > 3 && strcmp(argv[3], "name") == 0) sort = CATALOG_BY_NAME;
+    CatalogFilter f = { -1, 0, 0, 0, (argc > 4) ? argv[4] : NULL };
+
+    Catalog c;
+    double t0 = SysNow();
+    CatalogOpen(&c, dir);
+    double t1 = SysNow();
+    int ok = CatalogSync(&c);
+    double t2 = SysNow();
+    int page[20], rows;
+    int total = CatalogQuery(&c, sort, sort != CATALOG_BY_NAME, f.text ? &f : NULL, 0, page, 20, &rows);
+    double t3 = SysNow();
+    total = CatalogQuery(&c, sort, sort != CATALOG_BY_NAME, f.text ? &f : NULL, 0, page, 20, &rows);
+    double t4 = SysNow();
+
+    for (int i = 0; i < rows; i++) {
+        const CatalogKey* k = &c.keys[page[i]];
+        const CatalogInfo* in = &c.info[page[i]];
+        time_t when = (time_t)(k->mtime / 1000000000LL);
+        char stamp[32];
+        strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M", localtime(&when));
+        printf("%-28s %s  %s %dp turn %-5u best %-3u %s", in->file, stamp, k->mode == MODE_CHAOS ? "chaos  " : "classic",
+            k->playerCount, k->turn, k->best, in->names[0]);
+        for (int p = 1; p < k->playerCount; p++) printf(", %s", in->names[p]);
+        printf("\n");
+    }
+    printf("%d of %d saves\n", rows, total);
+    printf("open %.2f ms, sync %.2f ms, first list %.3f ms, list %.3f ms\n",
+        (t1 - t0) * 1e3, (t2 - t1) * 1e3, (t3 - t2) * 1e3, (t4 - t3) * 1e3);
+    CatalogClose(&c);
+    //the count and the page come from different passes, a page short of it means they disagree
+    if (rows != (total < 20 ? total : 20)) {
+        fprintf(stderr, "catalog counted %d saves but listed %d\n", total, rows);
+        return 1;
+    }
+    return ok ? 0 : 1;
+}
+
+//plays one headless game like SimulateGame and journals it
+static int CmdRecord(int argc, char** argv)
+{
+    if (argc < 3) {
+        Usage();
+        return 1;
+    }
+    uint64_t seed = (argc > 3) ? strtoull(argv[3], NULL, 10) : (uint64_t)time(NULL);
+    SimConfig cfg;
+    if (!ParseSetup(argc, argv, 4, &cfg)) {
+        return 1;
+    }
+
+    SaveState s;
+    memset(&s, 0, sizeof(s));
+    GameInit(&s.game, cfg.playerCount, cfg.diceCount, cfg.mode, seed);
+    for (int i = 0; i < cfg.playerCount; i++) {
+        sprintf(s.players[i].name, "Bot %d", i + 1);
+        s.players[i].playerNumber = i + 1;
+    }
+    JournalWriter* j = (JournalWriter*)malloc(sizeof(JournalWriter));
+    if (!j || !JournalBegin(j, argv[2], &s, NULL, NULL)) {
+        free(j);
+        return 1;
+    }
+
+    Game* g = &s.game;
+    while (g->winner < 0 && g->globalTurn < MAX_GAME_TURNS) {
+        if (g->mode == MODE_CHAOS && g->canPlace[g->currentPlayer]) {
+            Rng rng = RngAt(seed, (uint64_t)g->globalTurn, RNG_POLICY);
+            int head = cfg.policy(g, &rng, cfg.policyCtx);
+            PlaceResult res = head ? GamePlaceSnake(g, head) : PLACE_BAD_TILE;
+            if (res == PLACE_OK) JournalPlace(j, head, g->board.snakes[g->board.snakeCount - 1].end);
+            if (res == PLACE_LIMIT) JournalSkip(j);
+        }
+        int a, b;
+        int total = RollDice(g, &a, &b);
+        JournalRoll(j, a, b);
+        GameMove(g, total);
+        JournalTurnDone(j, g);
+    }
+    JournalEnd(j, false);
+    free(j);
+    printf("%d turns, winner seat %d\n", g->globalTurn, g->winner + 1);
+    return 0;
+}
+
+//replays a journal through the rules and checks it, or shows the state at one turn
+static int CmdReplay(int argc, char** argv)
+{
+    if (argc < 3) {
+        Usage();
+        return 1;
+    }
+    JournalReader r;
+    if (!JournalOpen(&r, argv[2])) {
+        fprintf(stderr, "not a journal: %s\n", argv[2]);
+        return 1;
+    }
+
+    SaveState s;
+    int ok;
+    double t0 = SysNow();
+    if (argc > 3) {
+        int turn = atoi(argv[3]);
+        ok = JournalSeek(&r, turn, &s);
+        double ms = (SysNow() - t0) * 1e3;
+        if (ok) {
+            printf("turn %d, %s to move\n", s.game.globalTurn, s.players[s.game.currentPlayer].name);
+            for (int p = 0; p < s.game.playerCount; p++) printf("  %-12s tile %d\n", s.players[p].name, s.game.position[p]);
+            printf("snakes %d, seek %.3f ms from %d snapshots\n", s.game.board.snakeCount, ms, r.markCount);
+        }
+    }
+    else {
+        JournalStats st;
+        ok = JournalReplay(&r, &s, &st);
+        double sec = SysNow() - t0;
+        if (ok) {
+            printf("turns       %d\n", st.turns);
+            printf("winner      %s\n", s.game.winner >= 0 ? s.players[s.game.winner].name : "(none)");
+            printf("placed      %d\n", st.placed);
+            printf("snapshots   %d checked\n", st.snapshots);
+            printf("saves       %d%s\n", st.saves, st.left ? ", left early" : "");
+            if (st.rewinds) printf("rewinds     %d undo/redo jumps\n", st.rewinds);
+            printf("mismatches  %d\n", st.mismatches);
+            printf("replayed in %.3f ms (%.0f turns/sec)\n", sec * 1e3, sec > 0 ? st.turns / sec : 0.0);
+            ok = st.mismatches == 0;
+        }
+    }
+    JournalClose(&r);
+    return ok ? 0 : 1;
+}
+
+#define DEFAULT_ADDR "7777" //every interface; "unix:/path" for a unix socket
+
+//one event loop thread hosting every session, see server.h for the protocol
+static int CmdServe(int argc, char** argv)
+{
+    ServerConfig cfg;
+    cfg.addr = (argc > 2) ? argv[2] : DEFAULT_ADDR;
+    cfg.maxSessions = (argc > 3) ? atoi(argv[3]) : 65536;
+    cfg.seconds = (argc > 4) ? atof(argv[4]) : 0.0;
+    cfg.dir = (argc > 5) ? argv[5] : ".";
+    return RunServer(&cfg) ? 0 : 1;
+}
+
+//drives a running server from this machine and reports throughput and command latency
+static int CmdLoad(int argc, char** argv)
+{
+    LoadConfig cfg;
+    cfg.addr = (argc > 2) ? argv[2] : DEFAULT_ADDR;
+    cfg.connections = (argc > 3) ? atoi(argv[3]) : 8;
+    cfg.sessions = (argc > 4) ? atoi(argv[4]) : 256;
+    cfg.seconds = (argc > 5) ? atof(argv[5]) : 5.0;
+
+    LoadSummary* s = (LoadSummary*)malloc(sizeof(LoadSummary));
+    if (!s) {
+        return 1;
+    }
+    int ok = RunLoad(&cfg, s);
+    if (!ok) {
+        fprintf(stderr, "load failed, is the server up on %s?\n", cfg.addr);
+    }
+    if (s->commands) {
+        double rate = s->commands / s->seconds;
+        printf("sessions     %d over %d connections\n", s->sessions, cfg.connections);
+        printf("commands     %llu (%.0f/sec), %llu errors\n", (unsigned long long)s->commands, rate, (unsigned long long)s->errors);
+        printf("games        %llu finished\n", (unsigned long long)s->games);
+        printf("latency us   p50 %.0f, p99 %.0f, p99.9 %.0f\n", LoadPercentile(s, 50), LoadPercentile(s, 99), LoadPercentile(s, 99.9));
+        if (s->serverCpu > 0) {
+            //the server is one thread, so its busy share is the share of one core this load takes
+            double busy = s->serverCpu / s->seconds;
+            printf("server cpu   %.2f s (%.0f%% of a core)\n", s->serverCpu, busy * 100);
+            printf("per core     %.0f commands/sec, ~%.0f sessions per core at this pace\n", s->commands / s->serverCpu, s->sessions / busy);
+        }
+    }
+    free(s);
+    return ok ? 0 : 1;
+}
+
+int RunCli(int argc, char** argv)
+{
+    if (argc < 2) {
+        Usage();
+        return 1;
+    }
+    if (strcmp(argv[1], "sim") == 0) return CmdSim(argc, argv);
+    if (strcmp(argv[1], "traj") == 0) return CmdTraj(argc, argv);
+    if (strcmp(argv[1], "bot") == 0) return CmdBot(argc, argv);
+    if (strcmp(argv[1], "tourney") == 0) return CmdTourney(argc, argv);
+    if (strcmp(argv[1], "solve") == 0) return CmdSolve(argc, argv);
+    if (strcmp(argv[1], "design") == 0) return CmdDesign(argc, argv);
+    if (strcmp(argv[1], "roll") == 0) return CmdRoll(argc, argv);
+    if (strcmp(argv[1], "saves") == 0) return CmdSaves(argc, argv);
+    if (strcmp(argv[1], "record") == 0) return CmdRecord(argc, argv);
+    if (strcmp(argv[1], "replay") == 0) return CmdReplay(argc, argv);
+    if (strcmp(argv[1], "serve") == 0) return CmdServe(argc, argv);
+    if (strcmp(argv[1], "load") == 0) return CmdLoad(argc, argv);
+
+    Usage();
+    return 1;
+}
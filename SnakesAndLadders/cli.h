@@ -0,0 +1,4 @@
+#pragma once
+
+//command line tools, main() hands over here when it gets arguments so no window opens
+int RunCli(int argc, char** argv);
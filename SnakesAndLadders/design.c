@@ -0,0 +1,488 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include "design.h"
+#include "sys.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DESIGN_GRAB       64     //layouts a worker takes at a time
+#define DESIGN_TRIES      32     //picks at one link before the layout counts as no room
+#define DESIGN_EPS        1e-9   //the score sweeps stop once no tile moves more than this, relative
+#define DESIGN_SWEEPS     100000
+#define DESIGN_CACHE_BITS 16     //first size of a cache
+
+typedef enum {
+    SLOT_SKIP,  //no room, flawed or already met this search
+    SLOT_SOLVE, //new, the solve pass scores it
+    SLOT_KNOWN  //score taken from the cache
+} SlotState;
+
+typedef struct {
+    DesignLayout layout;
+    uint64_t key;
+    int flaw;     //-1 for no room
+    SlotState state;
+    double mean;  //negative when the sweeps never settled
+    double sd;
+} Slot;
+
+typedef struct {
+    const DesignConfig* cfg;
+    Slot* slots;
+    uint64_t base; //layout number of slots[0]
+    int64_t count;
+    int solving;   //0 draws and checks, 1 scores the SLOT_SOLVE ones
+    volatile int64_t next;
+} Pool;
+
+typedef struct {
+    Pool* pool;
+    int* jump;    //tiles + 1, where a landing on each tile ends
+    int* next;    //tiles * rolls, where each roll from each tile ends
+    int* stack;
+    uint8_t* mark;
+    double* e;    //expected own turns to finish from each tile
+    double* s;    //and the expected square
+} Worker;
+
+static const char* const flawNames[DESIGN_FLAWS] = { "ok", "edge", "backwards", "shared", "chain", "stuck" };
+
+static uint64_t Mix(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+const char* DesignFlawName(DesignFlaw f)
+{
+    return (f >= 0 && f < DESIGN_FLAWS) ? flawNames[f] : "?";
+}
+
+static int Rolls(int diceCount, int* roll, double* p)
+{
+    int k = 0;
+    for (int r = diceCount; r <= 6 * diceCount; r++) {
+        roll[k] = r;
+        p[k++] = (diceCount == 1) ? 1.0 / 6.0 : (6 - abs(r - 7)) / 36.0;
+    }
+    return k;
+}
+
+static void Jumps(const DesignLayout* l, int tiles, int* jump)
+{
+    for (int t = 0; t <= tiles; t++) jump[t] = t;
+    for (int i = 0; i < l->snakeCount; i++) jump[l->snakes[i].start] = l->snakes[i].end;
+    for (int i = 0; i < l->ladderCount; i++) jump[l->ladders[i].start] = l->ladders[i].end;
+}
+
+//the link list alone, no play
+static DesignFlaw LayoutFlaw(const DesignLayout* l, int tiles)
+{
+    SnakeOrLadder all[MAX_SNAKES + MAX_LADDERS];
+    int n = 0;
+    for (int i = 0; i < l->snakeCount; i++) {
+        if (l->snakes[i].end >= l->snakes[i].start) return DESIGN_BACKWARDS;
+        all[n++] = l->snakes[i];
+    }
+    for (int i = 0; i < l->ladderCount; i++) {
+        if (l->ladders[i].end <= l->ladders[i].start) return DESIGN_BACKWARDS;
+        all[n++] = l->ladders[i];
+    }
+    for (int i = 0; i < n; i++) {
+        if (all[i].start <= 1 || all[i].start >= tiles || all[i].end <= 1 || all[i].end >= tiles) return DESIGN_EDGE;
+    }
+    for (int i = 0; i < n; i++) {
+        for (int j = i + 1; j < n; j++) {
+            if (all[i].start == all[j].start || all[i].end == all[j].end) return DESIGN_SHARED;
+            if (all[i].end == all[j].start || all[j].end == all[i].start) return DESIGN_CHAIN;
+        }
+    }
+    return DESIGN_OK;
+}
+
+//every tile reachable from the start must have some way on to the last tile, or a token can
+//end up walking forever. mark bit 1 is reachable, bit 2 can finish
+static bool Finishes(const int* jump, int tiles, int diceCount, uint8_t* mark, int* stack)
+{
+    int lo = diceCount, hi = 6 * diceCount;
+    memset(mark, 0, (size_t)tiles + 1);
+    int top = 0;
+    mark[1] = 1;
+    stack[top++] = 1;
+    while (top) {
+        int t = stack[--top];
+        for (int r = lo; r <= hi && t != tiles; r++) {
+            int n = jump[BounceTarget(t, r, tiles)];
+            if (!(mark[n] & 1)) {
+                mark[n] |= 1;
+                stack[top++] = n;
+            }
+        }
+    }
+
+    //top down, so a sweep settles everything a ladder or a plain roll leads to and only
+    //snakes need another one
+    mark[tiles] |= 2;
+    for (bool moved = true; moved;) {
+        moved = false;
+        for (int t = tiles - 1; t >= 1; t--) {
+            if (mark[t] & 2) continue;
+            for (int r = lo; r <= hi; r++) {
+                if (mark[jump[BounceTarget(t, r, tiles)]] & 2) {
+                    mark[t] |= 2;
+                    moved = true;
+                    break;
+                }
+            }
+        }
+    }
+    for (int t = 1; t <= tiles; t++) {
+        if (mark[t] == 1) return false;
+    }
+    return true;
+}
+
+DesignFlaw DesignCheck(const Board* b, int diceCount)
+{
+    DesignLayout l;
+    memcpy(l.snakes, b->snakes, sizeof(l.snakes));
+    memcpy(l.ladders, b->ladders, sizeof(l.ladders));
+    l.snakeCount = b->snakeCount;
+    l.ladderCount = b->ladderCount;
+    DesignFlaw f = LayoutFlaw(&l, b->tiles);
+    if (f != DESIGN_OK) {
+        return f;
+    }
+
+    int* jump = (int*)malloc(((size_t)b->tiles + 1) * sizeof(int));
+    int* stack = (int*)malloc(((size_t)b->tiles + 1) * sizeof(int));
+    uint8_t* mark = (uint8_t*)malloc((size_t)b->tiles + 1);
+    if (jump && stack && mark) {
+        Jumps(&l, b->tiles, jump);
+        if (!Finishes(jump, b->tiles, diceCount, mark, stack)) f = DESIGN_STUCK;
+    }
+    free(jump);
+    free(stack);
+    free(mark);
+    return f;
+}
+
+void DesignToBoard(const DesignLayout* l, int width, int height, Board* out)
+{
+    BoardInitEmpty(out, width, height);
+    for (int i = 0; i < l->snakeCount; i++) BoardAddSnake(out, l->snakes[i].start, l->snakes[i].end);
+    for (int i = 0; i < l->ladderCount; i++) BoardAddLadder(out, l->ladders[i].start, l->ladders[i].end);
+}
+
+//the links sorted by start tile, a start can't repeat on a fit layout. the kind of a link is
+//in its direction, so two layouts with the same links listed in another order meet here
+static uint64_t LayoutKey(const DesignLayout* l, int tiles, int diceCount)
+{
+    uint64_t links[MAX_SNAKES + MAX_LADDERS];
+    int n = 0;
+    for (int i = 0; i < l->snakeCount; i++) links[n++] = (uint64_t)l->snakes[i].start << 32 | (uint64_t)l->snakes[i].end;
+    for (int i = 0; i < l->ladderCount; i++) links[n++] = (uint64_t)l->ladders[i].start << 32 | (uint64_t)l->ladders[i].end;
+    for (int i = 1; i < n; i++) {
+        uint64_t v = links[i];
+        int j = i;
+        for (; j > 0 && links[j - 1] > v; j--) links[j] = links[j - 1];
+        links[j] = v;
+    }
+    uint64_t h = Mix((uint64_t)tiles << 8 | (uint64_t)diceCount);
+    for (int i = 0; i < n; i++) h = Mix(h ^ links[i]);
+    return h ? h : 1;
+}
+
+//ladders then snakes, each end a free tile so no two links ever touch
+static bool Draw(const DesignConfig* cfg, uint64_t index, DesignLayout* out)
+{
+    Board b;
+    BoardInitEmpty(&b, cfg->width, cfg->height);
+    int last = b.tiles - 1;
+    Rng rng = RngAt(cfg->seed, index, RNG_DESIGN);
+    for (int i = 0; i < cfg->ladders; i++) {
+        int tries = 0;
+        for (; tries < DESIGN_TRIES; tries++) {
+            int start = BoardPickFree(&b, 2, last - cfg->minLength, &rng);
+            int end = start ? BoardPickFree(&b, start + cfg->minLength, start + cfg->maxLength < last ? start + cfg->maxLength : last, &rng) : 0;
+            if (end) {
+                BoardAddLadder(&b, start, end);
+                break;
+            }
+        }
+        if (tries == DESIGN_TRIES) return false;
+    }
+    for (int i = 0; i < cfg->snakes; i++) {
+        int tries = 0;
+        for (; tries < DESIGN_TRIES; tries++) {
+            int head = BoardPickFree(&b, 2 + cfg->minLength, last, &rng);
+            int tail = head ? BoardPickFree(&b, head - cfg->maxLength > 2 ? head - cfg->maxLength : 2, head - cfg->minLength, &rng) : 0;
+            if (tail) {
+                BoardAddSnake(&b, head, tail);
+                break;
+            }
+        }
+        if (tries == DESIGN_TRIES) return false;
+    }
+    memcpy(out->snakes, b.snakes, sizeof(out->snakes));
+    memcpy(out->ladders, b.ladders, sizeof(out->ladders));
+    out->snakeCount = b.snakeCount;
+    out->ladderCount = b.ladderCount;
+    return true;
+}
+
+//mean and spread of the own turns from the start tile. with T the turns from a tile and n
+//where one roll takes it, E[T] = 1 + sum p E[T_n] and E[T^2] = 2 E[T] - 1 + sum p E[T_n^2].
+//both are solved in place from the top tile down, as Togo does for the bot, over the tiles
+//Finishes marked reachable: the rest never feed the start tile and may never settle
+static bool Moments(Worker* w, int tiles, int diceCount, double* mean, double* sd)
+{
+    int roll[11];
+    double p[11];
+    int k = Rolls(diceCount, roll, p);
+    double* e = w->e;
+    double* s = w->s;
+    for (int t = 1; t < tiles; t++) {
+        for (int r = 0; r < k; r++) w->next[t * k + r] = w->jump[BounceTarget(t, roll[r], tiles)];
+    }
+    for (int t = 0; t <= tiles; t++) {
+        e[t] = (double)(tiles - t) / (3.5 * diceCount);
+        s[t] = e[t] * e[t];
+    }
+    for (int sweep = 0; sweep < DESIGN_SWEEPS; sweep++) {
+        double moved = 0.0;
+        for (int t = tiles - 1; t >= 1; t--) {
+            if (!(w->mark[t] & 1)) continue;
+            double sumE = 1.0, sumS = 0.0;
+            const int* next = w->next + t * k;
+            for (int r = 0; r < k; r++) {
+                int n = next[r];
+                sumE += p[r] * e[n];
+                sumS += p[r] * s[n];
+            }
+            sumS += 2.0 * sumE - 1.0;
+            double d = fabs(sumS - s[t]) / sumS;
+            if (d > moved) moved = d;
+            e[t] = sumE;
+            s[t] = sumS;
+        }
+        if (moved < DESIGN_EPS) {
+            *mean = e[1];
+            *sd = sqrt(fmax(s[1] - e[1] * e[1], 0.0));
+            return true;
+        }
+    }
+    return false;
+}
+
+static void WorkerMain(void* arg)
+{
+    Worker* w = (Worker*)arg;
+    Pool* p = w->pool;
+    const DesignConfig* cfg = p->cfg;
+    int tiles = cfg->width * cfg->height;
+    for (;;) {
+        int64_t first = SysAdd64(&p->next, DESIGN_GRAB);
+        if (first >= p->count) {
+            return;
+        }
+        int64_t last = first + DESIGN_GRAB < p->count ? first + DESIGN_GRAB : p->count;
+        for (int64_t i = first; i < last; i++) {
+            Slot* s = &p->slots[i];
+            if (p->solving) {
+                if (s->state != SLOT_SOLVE) continue;
+                Jumps(&s->layout, tiles, w->jump);
+                Finishes(w->jump, tiles, cfg->diceCount, w->mark, w->stack);
+                if (!Moments(w, tiles, cfg->diceCount, &s->mean, &s->sd)) s->mean = -1.0;
+                continue;
+            }
+            s->state = SLOT_SKIP;
+            if (!Draw(cfg, p->base + (uint64_t)i, &s->layout)) {
+                s->flaw = -1;
+                continue;
+            }
+            s->flaw = LayoutFlaw(&s->layout, tiles);
+            if (s->flaw == DESIGN_OK) {
+                Jumps(&s->layout, tiles, w->jump);
+                if (!Finishes(w->jump, tiles, cfg->diceCount, w->mark, w->stack)) s->flaw = DESIGN_STUCK;
+            }
+            s->key = LayoutKey(&s->layout, tiles, cfg->diceCount);
+        }
+    }
+}
+
+//one pass over slots[0..count) on every worker, the calling thread being worker 0
+static void RunPass(Pool* pool, int solving, Worker* workers, SysThread* handles, int threads)
+{
+    pool->next = 0;
+    pool->solving = solving;
+    int started = 1;
+    for (int t = 1; t < threads; t++) {
+        if (!SysThreadStart(&handles[t], WorkerMain, &workers[t])) break;
+        started++;
+    }
+    WorkerMain(&workers[0]); //also covers whatever a thread that failed to start left
+    for (int t = 1; t < started; t++) SysThreadJoin(&handles[t]);
+}
+
+bool DesignCacheInit(DesignCache* c)
+{
+    memset(c, 0, sizeof(*c));
+    c->cap = (uint64_t)1 << DESIGN_CACHE_BITS;
+    c->slots = (DesignCacheEntry*)calloc((size_t)c->cap, sizeof(DesignCacheEntry));
+    return c->slots != NULL;
+}
+
+void DesignCacheFree(DesignCache* c)
+{
+    free(c->slots);
+    memset(c, 0, sizeof(*c));
+}
+
+static DesignCacheEntry* CacheFind(const DesignCache* c, uint64_t key)
+{
+    uint64_t i = key & (c->cap - 1);
+    while (c->slots[i].key && c->slots[i].key != key) i = (i + 1) & (c->cap - 1);
+    return &c->slots[i];
+}
+
+static bool CacheGrow(DesignCache* c)
+{
+    DesignCache bigger = *c;
+    bigger.cap = c->cap * 2;
+    bigger.slots = (DesignCacheEntry*)calloc((size_t)bigger.cap, sizeof(DesignCacheEntry));
+    if (!bigger.slots) {
+        return false;
+    }
+    for (uint64_t i = 0; i < c->cap; i++) {
+        if (c->slots[i].key) *CacheFind(&bigger, c->slots[i].key) = c->slots[i];
+    }
+    free(c->slots);
+    *c = bigger;
+    return true;
+}
+
+//a tie keeps the layout drawn first
+static void Offer(const DesignConfig* cfg, const Slot* s, uint64_t index, DesignResult* out)
+{
+    if (s->mean < 0) {
+        return;
+    }
+    double score = fabs(s->mean - cfg->targetTurns) + cfg->spreadWeight * s->sd;
+    if (out->topCount == cfg->top && score >= out->top[out->topCount - 1].score) {
+        return;
+    }
+    int j = out->topCount < cfg->top ? out->topCount++ : out->topCount - 1;
+    for (; j > 0 && out->top[j - 1].score > score; j--) out->top[j] = out->top[j - 1];
+    out->top[j] = (DesignEntry){ s->layout, s->key, index, s->mean, s->sd, score };
+}
+
+int RunDesign(const DesignConfig* cfg, DesignResult* out)
+{
+    memset(out, 0, sizeof(*out));
+    int tiles = cfg->width * cfg->height;
+    if (cfg->width < BOARD_MIN_SIDE || cfg->height < BOARD_MIN_SIDE || tiles > DESIGN_MAX_TILES || cfg->diceCount < 1 ||
+        cfg->diceCount > 2 || cfg->snakes < 0 || cfg->snakes > MAX_SNAKES || cfg->ladders < 0 || cfg->ladders > MAX_LADDERS ||
+        cfg->minLength < 1 || cfg->maxLength < cfg->minLength || cfg->top < 1 || cfg->top > DESIGN_MAX_TOP) {
+        return 0;
+    }
+    int threads = cfg->threads > 0 ? cfg->threads : SysCpuCount();
+
+    DesignCache own;
+    DesignCache* cache = cfg->cache;
+    bool ok = cache || DesignCacheInit(&own);
+    if (!cache) cache = &own;
+    uint32_t run = ++cache->run;
+
+    Slot* slots = (Slot*)malloc(DESIGN_BATCH * sizeof(Slot));
+    Worker* workers = (Worker*)calloc((size_t)threads, sizeof(Worker));
+    SysThread* handles = (SysThread*)calloc((size_t)threads, sizeof(SysThread));
+    ok = ok && slots && workers && handles;
+    Pool pool = { cfg, slots, 0, 0, 0, 0 };
+    for (int t = 0; ok && t < threads; t++) {
+        Worker* w = &workers[t];
+        w->pool = &pool;
+        w->jump = (int*)malloc(((size_t)tiles + 1) * sizeof(int));
+        w->next = (int*)malloc((size_t)tiles * 11 * sizeof(int));
+        w->stack = (int*)malloc(((size_t)tiles + 1) * sizeof(int));
+        w->mark = (uint8_t*)malloc((size_t)tiles + 1);
+        w->e = (double*)malloc(((size_t)tiles + 1) * sizeof(double));
+        w->s = (double*)malloc(((size_t)tiles + 1) * sizeof(double));
+        ok = w->jump && w->next && w->stack && w->mark && w->e && w->s;
+    }
+
+    double start = SysNow();
+    for (uint64_t index = 0; ok && index < cfg->layouts;) {
+        int64_t count = cfg->layouts - index < DESIGN_BATCH ? (int64_t)(cfg->layouts - index) : DESIGN_BATCH;
+        pool.base = index;
+        pool.count = count;
+        RunPass(&pool, 0, workers, handles, threads);
+
+        //dedup in layout order on this thread, so which copy of a layout counts as the first
+        //doesn't depend on the threads
+        for (int64_t i = 0; i < count && ok; i++) {
+            Slot* s = &slots[i];
+            if (s->flaw < 0) {
+                out->noRoom++;
+                continue;
+            }
+            if (s->flaw != DESIGN_OK) {
+                out->flawed[s->flaw]++;
+                continue;
+            }
+            if (cache->count * 2 >= cache->cap && !(ok = CacheGrow(cache))) break;
+            DesignCacheEntry* e = CacheFind(cache, s->key);
+            if (e->key == s->key && e->run == run) {
+                out->duplicates++;
+            }
+            else if (e->key == s->key) {
+                out->cached++;
+                e->run = run;
+                s->mean = e->mean;
+                s->sd = e->sd;
+                s->state = SLOT_KNOWN;
+            }
+            else {
+                *e = (DesignCacheEntry){ s->key, 0.0, 0.0, run };
+                cache->count++;
+                s->state = SLOT_SOLVE;
+            }
+        }
+        if (!ok) {
+            break;
+        }
+        RunPass(&pool, 1, workers, handles, threads);
+
+        for (int64_t i = 0; i < count; i++) {
+            Slot* s = &slots[i];
+            if (s->state == SLOT_SOLVE) {
+                DesignCacheEntry* e = CacheFind(cache, s->key);
+                e->mean = s->mean;
+                e->sd = s->sd;
+                out->solved++;
+            }
+            if (s->state != SLOT_SKIP) Offer(cfg, s, index + (uint64_t)i, out);
+        }
+        out->drawn += (uint64_t)count;
+        index += (uint64_t)count;
+    }
+    out->seconds = SysNow() - start;
+    out->threads = threads;
+
+    for (int t = 0; workers && t < threads; t++) {
+        free(workers[t].jump);
+        free(workers[t].next);
+        free(workers[t].stack);
+        free(workers[t].mark);
+        free(workers[t].e);
+        free(workers[t].s);
+    }
+    if (cache == &own) DesignCacheFree(&own);
+    free(slots);
+    free(workers);
+    free(handles);
+    return ok;
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include "game.h"
+
+//board design search: random layouts drawn under constraints, checked, scored and the best
+//few kept. layout i always comes from (seed, i) and the results are taken in layout order,
+//so a search gives the same boards on any number of threads.
+//
+//a layout's score is exact, not simulated: the mean and spread of the own turns one token
+//needs to finish, solved on the chain from the top tile down. layouts are keyed by a hash of
+//their sorted links, and the cache keeps every score so the same layout is never solved twice
+
+#define DESIGN_MAX_TOP   64
+#define DESIGN_MAX_TILES 10000 //the score sweeps every tile many times over
+#define DESIGN_BATCH     4096  //layouts drawn between two dedup passes
+
+//why a board isn't fit to play, the first problem found
+typedef enum {
+    DESIGN_OK,
+    DESIGN_EDGE,      //a link on the start or last tile
+    DESIGN_BACKWARDS, //a ladder that goes down or a snake that goes up
+    DESIGN_SHARED,    //two links start or end on the same tile
+    DESIGN_CHAIN,     //a link ends where another starts, a ladder onto a snake head among them
+    DESIGN_STUCK,     //some tile a token can reach has no way on to the last tile
+    DESIGN_FLAWS
+} DesignFlaw;
+
+typedef struct {
+    SnakeOrLadder snakes[MAX_SNAKES];
+    SnakeOrLadder ladders[MAX_LADDERS];
+    int snakeCount;
+    int ladderCount;
+} DesignLayout;
+
+typedef struct {
+    uint64_t key;  //0 marks a free slot
+    double mean;   //negative when the score never settled
+    double sd;
+    uint32_t run;  //the last search that met this layout
+} DesignCacheEntry;
+
+//scores by layout key. one cache can serve several searches, a sweep over targets on the
+//same seed solves each layout once
+typedef struct {
+    DesignCacheEntry* slots;
+    uint64_t cap;  //a power of two, grown at half full
+    uint64_t count;
+    uint32_t run;
+} DesignCache;
+
+typedef struct {
+    int width;
+    int height;
+    int diceCount;
+    int snakes;
+    int ladders;
+    int minLength;       //tiles a link spans
+    int maxLength;
+    double targetTurns;  //own turns per token the board should take
+    double spreadWeight; //score = |mean - target| + spreadWeight * sd, lower is better
+    int top;             //layouts kept, up to DESIGN_MAX_TOP
+    uint64_t layouts;    //layouts drawn
+    uint64_t seed;
+    int threads;         //<= 0 uses one per core
+    DesignCache* cache;  //NULL for one that lasts this search
+} DesignConfig;
+
+typedef struct {
+    DesignLayout layout;
+    uint64_t key;
+    uint64_t index; //layout number it was drawn as
+    double mean;
+    double sd;
+    double score;
+} DesignEntry;
+
+typedef struct {
+    uint64_t drawn;
+    uint64_t noRoom;     //the constraints left no tile for some link
+    uint64_t flawed[DESIGN_FLAWS];
+    uint64_t duplicates; //met earlier in this search
+    uint64_t cached;     //scored by an earlier search on the same cache
+    uint64_t solved;
+    DesignEntry top[DESIGN_MAX_TOP];
+    int topCount;        //best first
+    double seconds;
+    int threads;
+} DesignResult;
+
+bool DesignCacheInit(DesignCache* c);
+void DesignCacheFree(DesignCache* c);
+
+DesignFlaw  DesignCheck(const Board* b, int diceCount);
+const char* DesignFlawName(DesignFlaw f);
+void        DesignToBoard(const DesignLayout* l, int width, int height, Board* out);
+
+int  RunDesign(const DesignConfig* cfg, DesignResult* out);
@@ -0,0 +1,306 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include "game.h"
+#include <stdlib.h>
+#include <string.h>
+
+//start is set to where it leads even over an end already there, an end never changes a jump
+static void Link(Board* b, int tile, int to)
+{
+    uint32_t i = BoardSlot(tile);
+    while (b->slotTile[i] && b->slotTile[i] != (uint32_t)tile) i = (i + 1) & (BOARD_SLOTS - 1);
+    if (b->slotTile[i]) {
+        if (to != tile) b->slotJump[i] = (uint32_t)to;
+        return;
+    }
+    b->slotTile[i] = (uint32_t)tile;
+    b->slotJump[i] = (uint32_t)to;
+    int far = (int)((i - BoardSlot(tile)) & (BOARD_SLOTS - 1));
+    if (far > b->probe) b->probe = far;
+
+    int j = b->takenCount++;
+    for (; j > 0 && b->taken[j - 1] > tile; j--) b->taken[j] = b->taken[j - 1];
+    b->taken[j] = tile;
+}
+
+//slots from scratch, only needed when links go away
+static void Compile(Board* b)
+{
+    memset(b->slotTile, 0, sizeof(b->slotTile));
+    memset(b->slotJump, 0, sizeof(b->slotJump));
+    b->takenCount = 0;
+    b->probe = 0;
+
+    for (int i = 0; i < b->snakeCount; i++) {
+        Link(b, b->snakes[i].start, b->snakes[i].end);
+        Link(b, b->snakes[i].end, b->snakes[i].end);
+    }
+    for (int i = 0; i < b->ladderCount; i++) {
+        Link(b, b->ladders[i].start, b->ladders[i].end);
+        Link(b, b->ladders[i].end, b->ladders[i].end);
+    }
+}
+
+void BoardClearSnakes(Board* b)
+{
+    b->snakeCount = 0;
+    Compile(b);
+}
+
+void BoardAddSnake(Board* b, int head, int tail)
+{
+    if (b->snakeCount >= MAX_SNAKES) {
+        return;
+    }
+    b->snakes[b->snakeCount++] = (SnakeOrLadder){ head, tail };
+    Link(b, head, tail);
+    Link(b, tail, tail);
+}
+
+void BoardAddLadder(Board* b, int start, int end)
+{
+    if (b->ladderCount >= MAX_LADDERS) {
+        return;
+    }
+    b->ladders[b->ladderCount++] = (SnakeOrLadder){ start, end };
+    Link(b, start, end);
+    Link(b, end, end);
+}
+
+//the 10x10 tile a link sits on, moved to the same spot on a tiles sized board
+static int Stretch(int tile, int tiles)
+{
+    return (int)((long long)tile * tiles / BOARD_TILES);
+}
+
+void BoardInitEmpty(Board* b, int width, int height)
+{
+    if (width < BOARD_MIN_SIDE) width = BOARD_MIN_SIDE;
+    if (width > BOARD_MAX_SIDE) width = BOARD_MAX_SIDE;
+    if (height < BOARD_MIN_SIDE) height = BOARD_MIN_SIDE;
+    if (height > BOARD_MAX_SIDE) height = BOARD_MAX_SIDE;
+    b->width = width;
+    b->height = height;
+    b->tiles = width * height;
+    b->snakeCount = 0;
+    b->ladderCount = 0;
+    Compile(b);
+}
+
+void BoardInit(Board* b, int width, int height)
+{
+    BoardInitEmpty(b, width, height);
+    static const int snakes[][2] = { { 16, 6 }, { 37, 21 }, { 49, 27 }, { 82, 55 }, { 97, 78 } };
+    static const int ladders[][2] = { { 4, 14 }, { 8, 30 }, { 28, 76 }, { 71, 92 }, { 80, 99 } };
+    for (int i = 0; i < 5; i++) {
+        BoardAddSnake(b, Stretch(snakes[i][0], b->tiles), Stretch(snakes[i][1], b->tiles));
+    }
+    for (int i = 0; i < 5; i++) {
+        BoardAddLadder(b, Stretch(ladders[i][0], b->tiles), Stretch(ladders[i][1], b->tiles));
+    }
+}
+
+void BoardInitDefault(Board* b)
+{
+    BoardInit(b, BOARD_SIZE, BOARD_SIZE);
+}
+
+//uniform pick among the free tiles in lo..hi, 0 if there are none. the k-th free tile is
+//found by stepping over the sorted taken ones, a few dozen compares with nothing to
+//mispredict, and the cost never depends on the range
+int BoardPickFree(const Board* b, int lo, int hi, Rng* rng)
+{
+    if (lo < 1) lo = 1;
+    if (hi > b->tiles) hi = b->tiles;
+    if (lo > hi) {
+        return 0;
+    }
+
+    int first = 0, last = 0;
+    for (int i = 0; i < b->takenCount; i++) {
+        first += b->taken[i] < lo;
+        last += b->taken[i] <= hi;
+    }
+    int total = hi - lo + 1 - (last - first);
+    if (total <= 0) {
+        return 0;
+    }
+
+    int tile = lo + RngRange(rng, 0, total - 1);
+    for (int i = first; i < last; i++) tile += b->taken[i] <= tile;
+    return tile;
+}
+
+void TileCell(int width, int height, int tile, int* col, int* row)
+{
+    int fromBottom = (tile - 1) / width, along = (tile - 1) % width;
+    *col = (fromBottom & 1) ? width - 1 - along : along;
+    *row = height - 1 - fromBottom;
+}
+
+void GameInit(Game* g, int playerCount, int diceCount, Mode mode, uint64_t seed)
+{
+    memset(g, 0, sizeof(*g));
+    BoardInitDefault(&g->board);
+
+    g->seed = seed;
+    g->mode = mode;
+    g->playerCount = playerCount;
+    g->diceCount = diceCount;
+    g->winner = -1;
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        g->position[i] = 1; //places player at 1 at starting
+    }
+}
+
+static int DiceFromBlock(const uint32_t block[4], int turn, int diceCount, int* dieA, int* dieB)
+{
+    const uint32_t* w = block + 2 * (turn & 1);
+    //bruteforce dice 2 = 0
+    *dieA = DieFace(w[0]);
+    if (diceCount == 1) {
+        *dieB = 0;
+        return *dieA;
+    }
+    *dieB = DieFace(w[1]);
+    return *dieA + *dieB;
+}
+
+//the roll of any turn of any game straight from its seed, nothing before it is needed
+int DiceAt(uint64_t seed, int turn, int diceCount, int* dieA, int* dieB)
+{
+    uint32_t block[4];
+    DiceBlock(seed, turn, block);
+    return DiceFromBlock(block, turn, diceCount, dieA, dieB);
+}
+
+int RollDice(const Game* g, int* dieA, int* dieB)
+{
+    return DiceAt(g->seed, g->globalTurn, g->diceCount, dieA, dieB);
+}
+
+//same tile WalkStep ends on: anything past the last tile walks back the extra
+int BounceTarget(int pos, int roll, int tiles)
+{
+    int t = pos + roll;
+    return (t > tiles) ? 2 * tiles - t : t;
+}
+
+void WalkBegin(TokenWalk* w, int roll)
+{
+    w->stepsRemaining = roll;
+    w->stepDir = 1;
+    w->bouncing = false;
+}
+
+bool WalkStep(TokenWalk* w, int* pos, int tiles)
+{
+    *pos += w->stepDir;
+    w->stepsRemaining--;
+
+    if (!w->bouncing && w->stepDir == 1 && *pos > tiles) {
+        int overflow = *pos - tiles;
+        *pos = tiles;
+        w->stepsRemaining += overflow;
+        w->stepDir = -1;
+        w->bouncing = true;
+        return false;
+    }
+    return w->stepsRemaining == 0;
+}
+
+MoveInfo GameFinishMove(Game* g, int landed)
+{
+    int cur = g->currentPlayer;
+    MoveInfo m;
+    m.landed = landed;
+    m.to = Slide(&g->board, landed);
+    m.bounced = false;
+    g->position[cur] = m.to;
+
+    g->personalTurn[cur]++;
+    g->globalTurn++;
+
+    if (g->mode == MODE_CHAOS && g->personalTurn[cur] == CHAOS_PLACE_EVERY) {
+        g->personalTurn[cur] = 0;
+        if (g->board.snakeCount < MAX_SNAKES) {
+            g->canPlace[cur] = true;
+        }
+    }
+
+    if (m.to == g->board.tiles) {
+        g->winner = cur;
+    }
+    else {
+        g->currentPlayer = (cur + 1 == g->playerCount) ? 0 : cur + 1; //no divide on the hot path
+    }
+    return m;
+}
+
+MoveInfo GameMove(Game* g, int roll)
+{
+    int from = g->position[g->currentPlayer];
+    MoveInfo m = GameFinishMove(g, BounceTarget(from, roll, g->board.tiles));
+    m.bounced = from + roll > g->board.tiles;
+    return m;
+}
+
+PlaceResult GamePlaceSnake(Game* g, int head)
+{
+    if (head <= 1 || head >= g->board.tiles) {
+        return PLACE_BAD_TILE;
+    }
+    if (TileOccupied(&g->board, head)) {
+        return PLACE_OCCUPIED;
+    }
+    if (g->board.snakeCount >= MAX_SNAKES) {
+        g->canPlace[g->currentPlayer] = false;
+        return PLACE_LIMIT;
+    }
+
+    //tail lands 5 to 20 below the head on a free tile, heads too low for that fall back to tile 1
+    Rng rng = RngAt(g->seed, (uint64_t)g->globalTurn, RNG_TAIL);
+    int tail = BoardPickFree(&g->board, head - 20, head - 5 > 1 ? head - 5 : 1, &rng);
+    if (!tail) {
+        return PLACE_NO_TAIL;
+    }
+
+    BoardAddSnake(&g->board, head, tail);
+    g->canPlace[g->currentPlayer] = false;
+    return PLACE_OK;
+}
+
+int RandomSnakePolicy(const Game* g, Rng* rng, void* ctx)
+{
+    (void)ctx;
+    return BoardPickFree(&g->board, 2, g->board.tiles - 1, rng);
+}
+
+void SimulateGame(const SimConfig* cfg, uint64_t seed, GameResult* out)
+{
+    Game g;
+    GameInit(&g, cfg->playerCount, cfg->diceCount, cfg->mode, seed);
+    memset(out, 0, sizeof(*out));
+    uint32_t block[4];
+
+    while (g.winner < 0 && g.globalTurn < MAX_GAME_TURNS) {
+        int cur = g.currentPlayer;
+        if (g.mode == MODE_CHAOS && g.canPlace[cur] && cfg->policy) {
+            Rng rng = RngAt(seed, (uint64_t)g.globalTurn, RNG_POLICY);
+            int head = cfg->policy(&g, &rng, cfg->policyCtx);
+            if (head && GamePlaceSnake(&g, head) == PLACE_OK) {
+                out->snakesPlaced++;
+            }
+        }
+
+        //same rolls as RollDice, just one block per two turns
+        int a, b;
+        if (!(g.globalTurn & 1)) DiceBlock(seed, g.globalTurn, block);
+        MoveInfo m = GameMove(&g, DiceFromBlock(block, g.globalTurn, g.diceCount, &a, &b));
+        if (m.to < m.landed) out->snakeHits++;
+        else if (m.to > m.landed) out->ladderHits++;
+        if (m.bounced) out->bounces++;
+    }
+
+    out->winner = g.winner;
+    out->turns = g.globalTurn;
+}
@@ -0,0 +1,173 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "rng.h"
+
+//game rules with no raylib in them, the window and the headless tools both use this
+
+#define BOARD_SIZE      10 //side of the default board
+#define BOARD_TILES     (BOARD_SIZE * BOARD_SIZE)
+#define BOARD_MIN_SIDE  10 //the default layout is stretched over bigger boards, never squeezed
+#define BOARD_MAX_SIDE  1000
+#define BOARD_SLOT_BITS 8
+#define BOARD_SLOTS     (1 << BOARD_SLOT_BITS) //link end hash, under a third full with every link down
+#define MAX_PLAYERS     4
+#define MAX_SNAKES      20
+#define MAX_LADDERS     20 //the default layout has 5, designed boards may have more
+#define CHAOS_PLACE_EVERY 2 //own turns between snake placements
+#define MAX_GAME_TURNS  100000 //headless games stop here if nobody wins
+
+typedef enum {
+    MODE_CLASSIC,
+    MODE_CHAOS
+} Mode;
+
+typedef struct {
+    int start;
+    int end;
+} SnakeOrLadder;
+
+//links are kept in placement order for drawing and saving. every link end is hashed by tile
+//into the slots, so a landing or a placement check is about one probe however many links
+//there are and however big the board is, and a game stays a small value to copy around
+typedef struct {
+    SnakeOrLadder snakes[MAX_SNAKES];
+    SnakeOrLadder ladders[MAX_LADDERS];
+    int snakeCount;
+    int ladderCount;
+    int width;  //tiles per row
+    int height; //rows
+    int tiles;  //width * height, landing on the last one wins
+    int probe; //furthest any tile sits from its home slot
+    uint32_t slotTile[BOARD_SLOTS]; //0 marks a free slot
+    uint32_t slotJump[BOARD_SLOTS]; //where a landing there ends up, the tile itself for a link's far end
+    int taken[2 * (MAX_SNAKES + MAX_LADDERS)]; //the same tiles sorted, for picking free ones
+    int takenCount;
+} Board;
+
+typedef struct {
+    uint64_t seed; //every roll and chaos tail is a function of this and the turn
+    Mode mode;
+    int playerCount;
+    int diceCount;
+    int currentPlayer;
+    int position[MAX_PLAYERS];
+    int personalTurn[MAX_PLAYERS];
+    bool canPlace[MAX_PLAYERS];
+    int globalTurn;
+    int winner; //-1 while the game is running
+    Board board;
+} Game;
+
+typedef enum {
+    PLACE_OK,
+    PLACE_BAD_TILE,
+    PLACE_OCCUPIED,
+    PLACE_LIMIT,
+    PLACE_NO_TAIL //every tile the tail could go on is taken
+} PlaceResult;
+
+//what one move did, landed is after the bounce and before Slide
+typedef struct {
+    int landed;
+    int to;
+    bool bounced;
+} MoveInfo;
+
+//tile by tile walk so the window can animate the same move GameMove does in one go
+typedef struct {
+    int stepsRemaining;
+    int stepDir;
+    bool bouncing;
+} TokenWalk;
+
+void BoardInitEmpty(Board* b, int width, int height); //no links
+void BoardInit(Board* b, int width, int height); //the default links stretched over width x height
+void BoardInitDefault(Board* b);
+void BoardClearSnakes(Board* b);
+void BoardAddSnake(Board* b, int head, int tail);
+void BoardAddLadder(Board* b, int start, int end);
+int  BoardPickFree(const Board* b, int lo, int hi, Rng* rng);
+
+static inline uint32_t BoardSlot(int tile)
+{
+    return ((uint32_t)tile * 0x9E3779B1u) >> (32 - BOARD_SLOT_BITS);
+}
+
+//every slot up to probe is looked at whatever it holds, the loop count is fixed per board
+//so moves don't pay for a mispredicted "found it" branch on every landing
+static inline int Slide(const Board* b, int pos)
+{
+    uint32_t home = BoardSlot(pos);
+    int to = pos;
+    for (int k = 0; k <= b->probe; k++) {
+        uint32_t i = (home + (uint32_t)k) & (BOARD_SLOTS - 1);
+        uint32_t hit = 0u - (uint32_t)(b->slotTile[i] == (uint32_t)pos);
+        to ^= (to ^ (int)b->slotJump[i]) & (int)hit;
+    }
+    return to;
+}
+
+static inline bool TileOccupied(const Board* b, int tile)
+{
+    uint32_t home = BoardSlot(tile);
+    bool hit = false;
+    for (int k = 0; k <= b->probe; k++) {
+        hit |= b->slotTile[(home + (uint32_t)k) & (BOARD_SLOTS - 1)] == (uint32_t)tile;
+    }
+    return hit && tile != 0;
+}
+
+//column and row (from the top) of a tile. numbers snake up from the bottom left, one row
+//left to right and the next right to left
+void TileCell(int width, int height, int tile, int* col, int* row);
+
+void GameInit(Game* g, int playerCount, int diceCount, Mode mode, uint64_t seed);
+
+//one philox block covers two turns, two words each: turn & 1 picks the pair, the first word
+//is die A and the second die B
+static inline void DiceBlock(uint64_t seed, int turn, uint32_t block[4])
+{
+    uint64_t pair = (uint64_t)turn >> 1;
+    uint32_t in[4] = { (uint32_t)pair, (uint32_t)(pair >> 32), RNG_DICE, 0 };
+    Philox4x32(seed, in, block);
+}
+
+static inline int DieFace(uint32_t word)
+{
+    return 1 + (int)(((uint64_t)word * 6) >> 32);
+}
+
+int  DiceAt(uint64_t seed, int turn, int diceCount, int* dieA, int* dieB);
+int  RollDice(const Game* g, int* dieA, int* dieB);
+int  BounceTarget(int pos, int roll, int tiles);
+void WalkBegin(TokenWalk* w, int roll);
+bool WalkStep(TokenWalk* w, int* pos, int tiles);
+
+MoveInfo GameFinishMove(Game* g, int landed);
+MoveInfo GameMove(Game* g, int roll);
+PlaceResult GamePlaceSnake(Game* g, int head);
+
+//headless games, policy returns a head tile to place a chaos snake on or 0 to keep the right
+typedef int (*SnakePolicy)(const Game* g, Rng* rng, void* ctx);
+
+typedef struct {
+    int playerCount;
+    int diceCount;
+    Mode mode;
+    SnakePolicy policy;
+    void* policyCtx;
+    uint32_t rules; //house rule bits from rules.h, 0 is the turn GameMove plays
+} SimConfig;
+
+typedef struct {
+    int winner;
+    int turns;
+    int snakeHits;
+    int ladderHits;
+    int bounces;
+    int snakesPlaced;
+} GameResult;
+
+int  RandomSnakePolicy(const Game* g, Rng* rng, void* ctx);
+void SimulateGame(const SimConfig* cfg, uint64_t seed, GameResult* out);
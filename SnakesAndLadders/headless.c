@@ -0,0 +1,9 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include "cli.h"
+
+//the command line tools without the window, for the linux build (see Makefile). on windows
+//the game exe takes the same arguments
+int main(int argc, char** argv)
+{
+    return RunCli(argc, argv);
+}
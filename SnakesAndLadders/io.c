@@ -0,0 +1,166 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include "io.h"
+#include "sys.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    IoJob* head;
+    IoJob* tail;
+} JobList;
+
+static SysLock lock;
+static SysThread worker;
+static JobList pending, finished;
+static bool quitting, running;
+static char dir[260];
+static Catalog catalog; //worker only
+
+static void Push(JobList* l, IoJob* job)
+{
+    job->next = NULL;
+    if (l->tail) l->tail->next = job;
+    else l->head = job;
+    l->tail = job;
+}
+
+static void FilePath(char* out, size_t len, const char* file)
+{
+    snprintf(out, len, "%s/%s", dir, file);
+}
+
+static void Run(IoJob* job)
+{
+    char path[400];
+    if (job->kind == IO_SAVE) {
+        FilePath(path, sizeof(path), job->file);
+        job->ok = SaveWrite(path, &job->state);
+        if (job->ok) CatalogNote(&catalog, path, &job->state);
+    }
+    else if (job->kind == IO_LOAD) {
+        FilePath(path, sizeof(path), job->file);
+        job->ok = SaveRead(path, &job->state);
+    }
+    else if (job->kind == IO_APPEND) {
+        FilePath(path, sizeof(path), job->file);
+        FILE* fp = fopen(path, job->first ? "wb" : "ab");
+        job->ok = fp && fwrite(job->data, 1, job->len, fp) == job->len;
+        if (fp && fclose(fp) != 0) job->ok = 0;
+    }
+    else {
+        job->ok = job->sync ? CatalogSync(&catalog) : 1;
+        CatalogFilter f = { -1, 0, 0, 0, job->text };
+        int idx[IO_PAGE];
+        job->total = CatalogQuery(&catalog, job->sort, job->descending, job->text[0] ? &f : NULL, job->skip, idx, IO_PAGE,
+            &job->rowCount);
+        for (int i = 0; i < job->rowCount; i++) {
+            job->rows[i].key = catalog.keys[idx[i]];
+            job->rows[i].info = catalog.info[idx[i]];
+        }
+    }
+}
+
+static void IoMain(void* arg)
+{
+    (void)arg;
+    CatalogOpen(&catalog, dir);
+    SysLockEnter(&lock);
+    for (;;) {
+        while (!pending.head && !quitting) SysLockWait(&lock);
+        IoJob* job = pending.head;
+        if (!job) {
+            break; //quitting and nothing left
+        }
+        pending.head = job->next;
+        if (!pending.head) pending.tail = NULL;
+        SysLockLeave(&lock);
+
+        Run(job);
+
+        SysLockEnter(&lock);
+        Push(&finished, job);
+    }
+    SysLockLeave(&lock);
+    CatalogClose(&catalog);
+}
+
+int IoStart(const char* folder)
+{
+    snprintf(dir, sizeof(dir), "%s", folder);
+    quitting = false;
+    if (!SysLockInit(&lock)) {
+        return 0;
+    }
+    if (!SysThreadStart(&worker, IoMain, NULL)) {
+        SysLockFree(&lock);
+        return 0;
+    }
+    running = true;
+    return 1;
+}
+
+void IoStop(void)
+{
+    if (!running) {
+        return;
+    }
+    SysLockEnter(&lock);
+    quitting = true;
+    SysLockWake(&lock);
+    SysLockLeave(&lock);
+    SysThreadJoin(&worker);
+    running = false;
+
+    //nobody is left to call back, the results only need freeing
+    for (IoJob* j = finished.head; j;) {
+        IoJob* next = j->next;
+        free(j->data);
+        free(j);
+        j = next;
+    }
+    finished.head = finished.tail = NULL;
+    SysLockFree(&lock);
+}
+
+IoJob* IoNew(IoKind kind, IoDone done)
+{
+    IoJob* job = (IoJob*)calloc(1, sizeof(IoJob));
+    if (job) {
+        job->kind = kind;
+        job->done = done;
+    }
+    return job;
+}
+
+void IoSubmit(IoJob* job)
+{
+    if (!running) {
+        job->ok = 0; //no worker, the callback still comes on the next poll
+        Push(&finished, job);
+        return;
+    }
+    SysLockEnter(&lock);
+    Push(&pending, job);
+    SysLockWake(&lock);
+    SysLockLeave(&lock);
+}
+
+int IoPoll(void)
+{
+    if (running) SysLockEnter(&lock);
+    IoJob* j = finished.head;
+    finished.head = finished.tail = NULL;
+    if (running) SysLockLeave(&lock);
+
+    int n = 0;
+    while (j) {
+        IoJob* next = j->next;
+        if (j->done) j->done(j);
+        free(j->data);
+        free(j);
+        j = next;
+        n++;
+    }
+    return n;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include "catalog.h"
+#include "save.h"
+
+//save file work off the render thread. one worker runs the jobs in order and owns the
+//catalog, IoPoll hands finished jobs to their callbacks on the calling thread so a
+//callback can touch game state without any locking
+
+#define IO_PAGE 32 //rows one list job brings back
+
+typedef enum {
+    IO_SAVE,
+    IO_LOAD,
+    IO_LIST,
+    IO_APPEND //data onto the end of file, or a new file when first is set
+} IoKind;
+
+typedef struct {
+    CatalogKey key;
+    CatalogInfo info;
+} IoRow;
+
+typedef struct IoJob IoJob;
+typedef void (*IoDone)(IoJob* job);
+
+struct IoJob {
+    IoKind kind;
+    char file[CATALOG_NAME_LEN]; //save and load, relative to the io folder
+    SaveState state;             //save: what to write, load: what was read
+
+    //list
+    bool sync; //bring the catalog up to date with the folder first
+    CatalogSort sort;
+    bool descending;
+    char text[SAVE_NAME_LEN];
+    int skip;
+    int total;
+    int rowCount;
+    IoRow rows[IO_PAGE];
+
+    //append, data is malloced and freed with the job
+    uint8_t* data;
+    size_t len;
+    bool first;
+
+    int ok;
+    IoDone done;
+    void* ctx;
+    IoJob* next;
+};
+
+int    IoStart(const char* dir);
+void   IoStop(void); //runs whatever is still queued first, so a save made right before exit lands
+IoJob* IoNew(IoKind kind, IoDone done); //zeroed, owned by io until its callback returns
+void   IoSubmit(IoJob* job);
+int    IoPoll(void); //callbacks for finished jobs, returns how many ran
@@ -0,0 +1,346 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include "journal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint32_t Rd16(const uint8_t* p) { return (uint32_t)p[0] | (uint32_t)p[1] << 8; }
+static uint32_t Rd32(const uint8_t* p) { return Rd16(p) | Rd16(p + 2) << 16; }
+static uint64_t Rd64(const uint8_t* p) { return (uint64_t)Rd32(p) | (uint64_t)Rd32(p + 4) << 32; }
+static void Wr16(uint8_t* p, uint32_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+static void Wr32(uint8_t* p, uint32_t v) { Wr16(p, v); Wr16(p + 2, v >> 16); }
+static void Wr64(uint8_t* p, uint64_t v) { Wr32(p, (uint32_t)v); Wr32(p + 4, (uint32_t)(v >> 32)); }
+
+static void FileSink(const char* path, const uint8_t* data, size_t len, bool first, void* ctx)
+{
+    (void)ctx;
+    FILE* fp = fopen(path, first ? "wb" : "ab");
+    if (!fp) {
+        return;
+    }
+    fwrite(data, 1, len, fp);
+    fclose(fp);
+}
+
+void JournalFlush(JournalWriter* j)
+{
+    if (!j->started || !j->len) {
+        return;
+    }
+    j->sink(j->path, j->buf, j->len, j->first, j->ctx);
+    j->first = false;
+    j->len = 0;
+}
+
+static void Put(JournalWriter* j, const uint8_t* data, size_t len)
+{
+    if (!j->started) {
+        return;
+    }
+    if (j->len + len > JOURNAL_BUFFER) {
+        JournalFlush(j);
+    }
+    memcpy(j->buf + j->len, data, len);
+    j->len += len;
+}
+
+static void Snapshot(JournalWriter* j, const SaveState* s, JournalRecord kind)
+{
+    uint8_t rec[5 + SAVE_MAX_LEN];
+    uint32_t n = SaveEncode(s, rec + 5);
+    rec[0] = (uint8_t)kind;
+    Wr32(rec + 1, n);
+    Put(j, rec, 5 + n);
+    j->lastSnapshot = s->game.globalTurn;
+}
+
+int JournalBegin(JournalWriter* j, const char* path, const SaveState* start, JournalSink sink, void* ctx)
+{
+    memset(j, 0, sizeof(*j));
+    if (snprintf(j->path, sizeof(j->path), "%s", path) >= (int)sizeof(j->path)) {
+        return 0;
+    }
+    j->sink = sink ? sink : FileSink;
+    j->ctx = ctx;
+    j->started = true;
+    j->first = true;
+    j->base = *start;
+
+    const Game* g = &start->game;
+    uint8_t h[JOURNAL_HEADER_LEN];
+    memset(h, 0, sizeof(h));
+    Wr32(h, JOURNAL_MAGIC);
+    Wr16(h + 4, JOURNAL_VERSION);
+    Wr16(h + 6, JOURNAL_HEADER_LEN);
+    Wr64(h + 8, g->seed);
+    h[16] = (uint8_t)g->mode;
+    h[17] = (uint8_t)g->playerCount;
+    h[18] = (uint8_t)g->diceCount;
+    Wr32(h + 20, JOURNAL_SNAPSHOT_EVERY);
+    Wr32(h + 28, Crc32(0, h, 28));
+    Put(j, h, sizeof(h));
+    Snapshot(j, start, J_SNAPSHOT);
+    JournalFlush(j); //the file exists from the first turn on
+    return 1;
+}
+
+void JournalRoll(JournalWriter* j, int dieA, int dieB)
+{
+    uint8_t rec[3] = { J_ROLL, (uint8_t)dieA, (uint8_t)dieB };
+    Put(j, rec, sizeof(rec));
+}
+
+void JournalPlace(JournalWriter* j, int head, int tail)
+{
+    uint8_t rec[9];
+    rec[0] = J_PLACE;
+    Wr32(rec + 1, (uint32_t)head);
+    Wr32(rec + 5, (uint32_t)tail);
+    Put(j, rec, sizeof(rec));
+}
+
+void JournalSkip(JournalWriter* j)
+{
+    uint8_t rec = J_SKIP;
+    Put(j, &rec, 1);
+}
+
+void JournalSave(JournalWriter* j, const char* name)
+{
+    uint8_t rec[2 + 255];
+    size_t n = strlen(name);
+    if (n > 255) n = 255;
+    rec[0] = J_SAVE;
+    rec[1] = (uint8_t)n;
+    memcpy(rec + 2, name, n);
+    Put(j, rec, 2 + n);
+    JournalFlush(j); //a save is a point worth having on disk
+}
+
+void JournalTurnDone(JournalWriter* j, const Game* g)
+{
+    if (!j->started || g->winner >= 0 || g->globalTurn - j->lastSnapshot < JOURNAL_SNAPSHOT_EVERY) {
+        return;
+    }
+    j->base.game = *g;
+    j->base.phase = SAVE_PHASE_TURN;
+    Snapshot(j, &j->base, J_SNAPSHOT);
+}
+
+void JournalRewind(JournalWriter* j, const SaveState* s)
+{
+    Snapshot(j, s, J_REWIND);
+}
+
+void JournalEnd(JournalWriter* j, bool left)
+{
+    if (!j->started) {
+        return;
+    }
+    if (left) {
+        uint8_t rec = J_LEAVE;
+        Put(j, &rec, 1);
+    }
+    JournalFlush(j);
+    j->started = false;
+}
+
+//bytes the record at p takes, 0 if it runs past the end or isn't a record
+static size_t RecordLen(const uint8_t* p, size_t left, int version)
+{
+    size_t n = 0;
+    switch (p[0]) {
+    case J_ROLL: n = 3; break;
+    case J_PLACE: n = version >= 3 ? 9 : 5; break;
+    case J_SKIP: case J_LEAVE: n = 1; break;
+    case J_SAVE: n = left >= 2 ? 2 + (size_t)p[1] : 2; break;
+    case J_SNAPSHOT: case J_REWIND: n = left >= 5 ? 5 + (size_t)Rd32(p + 1) : 5; break;
+    default: return 0;
+    }
+    return n <= left ? n : 0;
+}
+
+//a snapshot taken mid turn is played up to the end of that turn, so replay always works in whole turns
+static void SettleTurn(SaveState* s)
+{
+    if (s->phase == SAVE_PHASE_ROLLED) {
+        GameMove(&s->game, s->diceTotal);
+    }
+    else if (s->phase == SAVE_PHASE_MOVING) {
+        int pos = s->game.position[s->game.currentPlayer];
+        while (!WalkStep(&s->walk, &pos, s->game.board.tiles));
+        GameFinishMove(&s->game, pos);
+    }
+    s->phase = SAVE_PHASE_TURN;
+}
+
+int JournalOpen(JournalReader* r, const char* path)
+{
+    memset(r, 0, sizeof(*r));
+    if (!SysMapFile(path, &r->map)) {
+        return 0;
+    }
+    const uint8_t* d = r->map.data;
+    size_t size = r->map.size;
+    if (size < JOURNAL_HEADER_LEN || Rd32(d) != JOURNAL_MAGIC || Rd16(d + 4) < 1 || Rd16(d + 4) > JOURNAL_VERSION ||
+        Rd16(d + 6) != JOURNAL_HEADER_LEN || Crc32(0, d, 28) != Rd32(d + 28)) {
+        JournalClose(r);
+        return 0;
+    }
+    r->version = (int)Rd16(d + 4);
+    r->seed = Rd64(d + 8);
+    r->mode = (Mode)d[16];
+    r->playerCount = d[17];
+    r->diceCount = d[18];
+
+    //one pass to find the snapshots
+    int cap = 0;
+    size_t at = JOURNAL_HEADER_LEN;
+    while (at < size) {
+        size_t n = RecordLen(d + at, size - at, r->version);
+        if (!n) {
+            break; //torn tail from a crash mid write
+        }
+        if (d[at] == J_SNAPSHOT || d[at] == J_REWIND) {
+            SaveState s;
+            if (!SaveDecode(d + at + 5, n - 5, &s)) {
+                break;
+            }
+            //marks past a rewind were on the line that got undone, turns from there on are
+            //found from the rewind. earlier turns are the same on both lines
+            while (d[at] == J_REWIND && r->markCount > 1 && r->marks[r->markCount - 1].turn >= s.game.globalTurn) {
+                r->markCount--;
+            }
+            if (r->markCount == cap) {
+                cap = cap ? cap * 2 : 16;
+                JournalMark* m = (JournalMark*)realloc(r->marks, (size_t)cap * sizeof(JournalMark));
+                if (!m) {
+                    JournalClose(r);
+                    return 0;
+                }
+                r->marks = m;
+            }
+            SettleTurn(&s);
+            r->marks[r->markCount++] = (JournalMark){ at, s.game.globalTurn };
+        }
+        at += n;
+    }
+    r->end = at;
+    if (!r->markCount) {
+        JournalClose(r); //every journal starts with one
+        return 0;
+    }
+    return 1;
+}
+
+void JournalClose(JournalReader* r)
+{
+    SysUnmapFile(&r->map);
+    free(r->marks);
+    memset(r, 0, sizeof(*r));
+}
+
+//applies records from mark on until the state reaches stopTurn (or the end when it's negative)
+static int Play(const JournalReader* r, int mark, int stopTurn, SaveState* s, JournalStats* st)
+{
+    const uint8_t* d = r->map.data;
+    size_t at = r->marks[mark].at;
+    size_t n = RecordLen(d + at, r->end - at, r->version);
+    if (!SaveDecode(d + at + 5, n - 5, s)) {
+        return 0;
+    }
+    SettleTurn(s);
+    at += n;
+
+    while (at < r->end && (stopTurn < 0 || s->game.globalTurn < stopTurn)) {
+        const uint8_t* p = d + at;
+        n = RecordLen(p, r->end - at, r->version);
+        Game* g = &s->game;
+        switch (p[0]) {
+        case J_ROLL: {
+            int a, b;
+            int total = DiceAt(g->seed, g->globalTurn, g->diceCount, &a, &b);
+            if (st && (a != p[1] || b != p[2])) st->mismatches++;
+            if (g->winner < 0) GameMove(g, total);
+            if (st) { st->rolls++; st->turns = g->globalTurn; }
+            break;
+        }
+        case J_PLACE: {
+            bool wide = r->version >= 3;
+            int head = (int)(wide ? Rd32(p + 1) : Rd16(p + 1));
+            int tail = (int)(wide ? Rd32(p + 5) : Rd16(p + 3));
+            PlaceResult res = GamePlaceSnake(g, head);
+            if (st && (res != PLACE_OK || g->board.snakes[g->board.snakeCount - 1].end != tail)) st->mismatches++;
+            if (st) st->placed++;
+            break;
+        }
+        case J_SKIP:
+            g->canPlace[g->currentPlayer] = false;
+            break;
+        case J_SAVE:
+            if (st) st->saves++;
+            break;
+        case J_LEAVE:
+            if (st) st->left = true;
+            break;
+        case J_REWIND: {
+            SaveState to;
+            if (!SaveDecode(p + 5, n - 5, &to)) {
+                return 0; //checked when the marks were found, can't happen
+            }
+            *s = to;
+            SettleTurn(s);
+            if (st) st->rewinds++;
+        } break;
+        case J_SNAPSHOT:
+            if (st) {
+                //compared as encoded images so struct padding can't get in the way
+                SaveState check, mine;
+                uint8_t a[SAVE_MAX_LEN], b[SAVE_MAX_LEN];
+                int same = SaveDecode(p + 5, n - 5, &check);
+                if (same) {
+                    mine = check;
+                    mine.game = *g;
+                    uint32_t la = SaveEncode(&check, a), lb = SaveEncode(&mine, b);
+                    same = la == lb && memcmp(a, b, la) == 0;
+                }
+                if (!same) st->mismatches++;
+                st->snapshots++;
+            }
+            break;
+        }
+        at += n;
+    }
+    return 1;
+}
+
+int JournalSeek(const JournalReader* r, int turn, SaveState* out)
+{
+    //last snapshot at or before the turn, marks are in turn order
+    int lo = 0, hi = r->markCount - 1;
+    while (lo < hi) {
+        int mid = (lo + hi + 1) / 2;
+        if (r->marks[mid].turn <= turn) lo = mid;
+        else hi = mid - 1;
+    }
+    SaveState s;
+    if (!Play(r, lo, turn, &s, NULL)) {
+        return 0;
+    }
+    *out = s;
+    return 1;
+}
+
+int JournalReplay(const JournalReader* r, SaveState* out, JournalStats* stats)
+{
+    JournalStats st;
+    memset(&st, 0, sizeof(st));
+    SaveState s;
+    if (!Play(r, 0, -1, &s, &st)) {
+        return 0;
+    }
+    st.turns = s.game.globalTurn;
+    if (out) *out = s;
+    if (stats) *stats = st;
+    return 1;
+}
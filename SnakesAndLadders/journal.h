@@ -0,0 +1,100 @@
+#pragma once
+#include <stddef.h>
+#include "save.h"
+#include "sys.h"
+
+//append only record of one game: a header, then a stream of small records. it starts with a
+//snapshot of the state play began from and every JOURNAL_SNAPSHOT_EVERY turns it embeds
+//another one, so seeking only replays from the nearest snapshot. snapshots are whole v2 save
+//images and carry their own crcs, the rolls are checked against the seed on replay
+//
+//  header  32 bytes  magic "SLJR", u16 version, u16 header size, u64 seed,
+//                    u8 mode, players, dice, 0, u32 snapshot interval, u32 0, u32 crc
+//  'R' a b           one roll, the move it made is implied
+//  'P' u32 head tail a chaos snake placed (u16 before v3)
+//  'K'               the current player gave up placing
+//  'S' n name[n]     saved as name
+//  'L'               left the game
+//  'N' u32 n save[n] snapshot at the start of a turn
+//  'U' u32 n save[n] undo or redo: play goes on from this state instead (v2)
+//
+//a rewind leaves what came before it in the file, the turns it undid just stop counting.
+//a seek into turns a redo jumped over gets the state the redo landed on
+
+#define JOURNAL_MAGIC          0x524A4C53u //"SLJR"
+#define JOURNAL_VERSION        3 //1 had no rewinds, 2 no tiles past 65535, both still read
+#define JOURNAL_HEADER_LEN     32
+#define JOURNAL_SNAPSHOT_EVERY 256
+#define JOURNAL_BUFFER         4096
+
+typedef enum {
+    J_ROLL = 'R',
+    J_PLACE = 'P',
+    J_SKIP = 'K',
+    J_SAVE = 'S',
+    J_LEAVE = 'L',
+    J_SNAPSHOT = 'N',
+    J_REWIND = 'U'
+} JournalRecord;
+
+//where flushed bytes go, first is set for the chunk that starts the file.
+//NULL writes them with stdio right away
+typedef void (*JournalSink)(const char* path, const uint8_t* data, size_t len, bool first, void* ctx);
+
+typedef struct {
+    char path[260];
+    JournalSink sink;
+    void* ctx;
+    bool started;
+    bool first; //nothing flushed yet
+    SaveState base; //names and colors for the snapshots
+    int lastSnapshot;
+    size_t len;
+    uint8_t buf[JOURNAL_BUFFER];
+} JournalWriter;
+
+int  JournalBegin(JournalWriter* j, const char* path, const SaveState* start, JournalSink sink, void* ctx);
+void JournalRoll(JournalWriter* j, int dieA, int dieB);
+void JournalPlace(JournalWriter* j, int head, int tail);
+void JournalSkip(JournalWriter* j);
+void JournalSave(JournalWriter* j, const char* name);
+void JournalTurnDone(JournalWriter* j, const Game* g); //after each finished move, snapshots when due
+void JournalRewind(JournalWriter* j, const SaveState* s); //the game jumped to s through undo or redo
+void JournalFlush(JournalWriter* j);
+void JournalEnd(JournalWriter* j, bool left);
+
+typedef struct {
+    size_t at;  //offset of the snapshot or rewind record
+    int turn;
+} JournalMark;
+
+typedef struct {
+    SysMap map;
+    int version;
+    uint64_t seed;
+    Mode mode;
+    int playerCount, diceCount;
+    JournalMark* marks;
+    int markCount;
+    size_t end; //bytes of whole records, a torn tail is left out
+} JournalReader;
+
+typedef struct {
+    int turns;
+    int rolls;
+    int placed;
+    int snapshots;   //checked against the replayed state
+    int mismatches;  //rolls, tails or snapshots the replay didn't reproduce
+    int saves;
+    int rewinds;
+    bool left;
+} JournalStats;
+
+int  JournalOpen(JournalReader* r, const char* path);
+void JournalClose(JournalReader* r);
+
+//state at the start of global turn `turn`, or the last state if the game stopped before it
+int  JournalSeek(const JournalReader* r, int turn, SaveState* out);
+
+//plays the whole journal from its first snapshot and checks every roll, tail and snapshot
+int  JournalReplay(const JournalReader* r, SaveState* out, JournalStats* stats);
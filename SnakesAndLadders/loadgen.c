@@ -0,0 +1,259 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include "server.h"
+#include "net.h"
+#include "sys.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint32_t Rd16(const uint8_t* p) { return (uint32_t)p[0] | (uint32_t)p[1] << 8; }
+static uint32_t Rd32(const uint8_t* p) { return Rd16(p) | Rd16(p + 2) << 16; }
+static uint64_t Rd64(const uint8_t* p) { return (uint64_t)Rd32(p) | (uint64_t)Rd32(p + 4) << 32; }
+static void Wr16(uint8_t* p, uint32_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+static void Wr32(uint8_t* p, uint32_t v) { Wr16(p, v); Wr16(p + 2, v >> 16); }
+static void Wr64(uint8_t* p, uint64_t v) { Wr32(p, (uint32_t)v); Wr32(p + 4, (uint32_t)(v >> 32)); }
+
+//what a client game needs between replies
+typedef struct {
+    uint32_t id; //0 until NEW comes back
+    bool rolled;
+    bool over;
+} Seat;
+
+typedef struct {
+    const LoadConfig* cfg;
+    int index;
+    double deadline;
+    LoadSummary* sum; //per thread, merged at the end
+    int ok;
+} Worker;
+
+static int SendAll(NetSocket s, const uint8_t* p, int len)
+{
+    while (len > 0) {
+        int n = NetSend(s, p, len);
+        if (n <= 0) return 0;
+        p += n;
+        len -= n;
+    }
+    return 1;
+}
+
+//one reply into msg, blocking
+static int ReadReply(NetSocket s, uint8_t* buf, int* have, uint8_t* msg)
+{
+    for (;;) {
+        if (*have >= 2) {
+            int len = 2 + (int)Rd16(buf);
+            if (len < NET_HEADER_LEN + 1 || len > NET_MAX_MSG) {
+                return 0;
+            }
+            if (*have >= len) {
+                memcpy(msg, buf, (size_t)len);
+                memmove(buf, buf + len, (size_t)(*have - len));
+                *have -= len;
+                return len;
+            }
+        }
+        int n = NetRecv(s, buf + *have, 4096 - *have);
+        if (n <= 0) {
+            return 0;
+        }
+        *have += n;
+    }
+}
+
+static uint8_t* Header(uint8_t* m, int op, uint32_t tag, uint32_t session)
+{
+    m[2] = (uint8_t)op;
+    Wr32(m + 3, tag);
+    Wr32(m + 7, session);
+    return m + NET_HEADER_LEN;
+}
+
+static uint8_t* NewRequest(uint8_t* m, uint32_t tag, uint64_t seed)
+{
+    uint8_t* w = Header(m, NET_OP_NEW, tag, 0);
+    w[0] = 2;
+    w[1] = 1;
+    w[2] = MODE_CLASSIC;
+    w[3] = 0;
+    Wr16(w + 4, 0);
+    Wr16(w + 6, 0);
+    Wr64(w + 8, seed);
+    Wr16(m, (uint32_t)(NET_HEADER_LEN + 16 - 2));
+    return m + NET_HEADER_LEN + 16;
+}
+
+static uint8_t* Request(uint8_t* m, int op, uint32_t tag, uint32_t session)
+{
+    Header(m, op, tag, session);
+    Wr16(m, (uint32_t)(NET_HEADER_LEN - 2));
+    return m + NET_HEADER_LEN;
+}
+
+//every seat gets one command per round, sent as one write, then the replies are read back.
+//each command's latency runs from the send to its own reply
+static void WorkerMain(void* arg)
+{
+    Worker* wk = (Worker*)arg;
+    int seatCount = wk->cfg->sessions;
+    NetSocket s = NetConnect(wk->cfg->addr);
+    Seat* seats = (Seat*)calloc((size_t)seatCount, sizeof(Seat));
+    uint8_t* out = (uint8_t*)malloc((size_t)seatCount * NET_MAX_MSG);
+    uint8_t* sentOp = (uint8_t*)malloc((size_t)seatCount);
+    uint8_t in[4096], msg[NET_MAX_MSG];
+    int have = 0;
+    uint64_t seed = GameSeed(0x5eed, (uint64_t)wk->index << 32);
+    if (s == NET_NONE || !seats || !out || !sentOp) {
+        if (s != NET_NONE) NetClose(s);
+        free(seats);
+        free(out);
+        free(sentOp);
+        return;
+    }
+
+    LoadSummary* sum = wk->sum;
+    while (SysNow() < wk->deadline) {
+        uint8_t* w = out;
+        for (int i = 0; i < seatCount; i++) {
+            Seat* st = &seats[i];
+            if (!st->id) {
+                w = NewRequest(w, (uint32_t)i, seed++);
+                sentOp[i] = NET_OP_NEW;
+            }
+            else if (st->over) {
+                w = Request(w, NET_OP_END, (uint32_t)i, st->id);
+                sentOp[i] = NET_OP_END;
+            }
+            else {
+                int op = st->rolled ? NET_OP_THROW : NET_OP_ROLL;
+                w = Request(w, op, (uint32_t)i, st->id);
+                sentOp[i] = (uint8_t)op;
+            }
+        }
+        double sent = SysNow();
+        if (!SendAll(s, out, (int)(w - out))) {
+            break;
+        }
+
+        bool lost = false;
+        for (int i = 0; i < seatCount; i++) {
+            int len = ReadReply(s, in, &have, msg);
+            if (!len) {
+                lost = true;
+                break;
+            }
+            uint64_t us = (uint64_t)((SysNow() - sent) * 1e6);
+            sum->latency[us < LOAD_BUCKETS ? us : LOAD_BUCKETS - 1]++;
+            sum->commands++;
+
+            uint32_t tag = Rd32(msg + 3);
+            if (tag >= (uint32_t)seatCount || msg[2] != (sentOp[tag] | NET_REPLY)) {
+                lost = true;
+                break;
+            }
+            Seat* st = &seats[tag];
+            if (msg[NET_HEADER_LEN] != NET_OK) {
+                sum->errors++;
+                *st = (Seat){ 0, false, false }; //start that seat over
+                continue;
+            }
+            const uint8_t* body = msg + NET_HEADER_LEN + 1;
+            switch (sentOp[tag]) {
+            case NET_OP_NEW: st->id = Rd32(msg + 7); st->rolled = false; st->over = false; break;
+            case NET_OP_ROLL: st->rolled = true; break;
+            case NET_OP_THROW:
+                st->rolled = false;
+                if (body[9] != 0xFF) {
+                    st->over = true;
+                    sum->games++;
+                }
+                break;
+            case NET_OP_END: st->id = 0; break;
+            }
+        }
+        if (lost) {
+            break;
+        }
+    }
+    for (int i = 0; i < seatCount; i++) {
+        if (seats[i].id) sum->sessions++;
+    }
+    wk->ok = 1;
+    NetClose(s);
+    free(seats);
+    free(out);
+    free(sentOp);
+}
+
+//server cpu seconds so far, negative if it didn't answer
+static double ServerCpu(const char* addr)
+{
+    NetSocket s = NetConnect(addr);
+    if (s == NET_NONE) {
+        return -1.0;
+    }
+    uint8_t m[NET_MAX_MSG], in[4096];
+    int have = 0;
+    double cpu = -1.0;
+    uint8_t* w = Request(m, NET_OP_STATS, 0, 0);
+    if (SendAll(s, m, (int)(w - m)) && ReadReply(s, in, &have, m) && m[NET_HEADER_LEN] == NET_OK) {
+        cpu = (double)Rd64(m + NET_HEADER_LEN + 1 + 12) * 1e-6;
+    }
+    NetClose(s);
+    return cpu;
+}
+
+int RunLoad(const LoadConfig* cfg, LoadSummary* out)
+{
+    memset(out, 0, sizeof(*out));
+    if (!NetInit() || cfg->connections < 1 || cfg->sessions < 1 || cfg->sessions * NET_MAX_MSG > (1 << 24)) {
+        return 0;
+    }
+    int n = cfg->connections;
+    Worker* wk = (Worker*)calloc((size_t)n, sizeof(Worker));
+    SysThread* th = (SysThread*)calloc((size_t)n, sizeof(SysThread));
+    LoadSummary* sums = (LoadSummary*)calloc((size_t)n, sizeof(LoadSummary));
+    if (!wk || !th || !sums) {
+        free(wk);
+        free(th);
+        free(sums);
+        return 0;
+    }
+
+    double cpu0 = ServerCpu(cfg->addr);
+    double start = SysNow();
+    int started = 0;
+    for (; started < n; started++) {
+        wk[started] = (Worker){ cfg, started, start + cfg->seconds, &sums[started], 0 };
+        if (!SysThreadStart(&th[started], WorkerMain, &wk[started])) break;
+    }
+    int ok = started > 0;
+    for (int i = 0; i < started; i++) {
+        SysThreadJoin(&th[i]);
+        ok = ok && wk[i].ok;
+        out->commands += sums[i].commands;
+        out->games += sums[i].games;
+        out->errors += sums[i].errors;
+        out->sessions += sums[i].sessions;
+        for (int b = 0; b < LOAD_BUCKETS; b++) out->latency[b] += sums[i].latency[b];
+    }
+    out->seconds = SysNow() - start;
+    double cpu1 = ServerCpu(cfg->addr);
+    out->serverCpu = (cpu0 >= 0 && cpu1 >= 0) ? cpu1 - cpu0 : -1.0;
+    free(wk);
+    free(th);
+    free(sums);
+    return ok;
+}
+
+double LoadPercentile(const LoadSummary* s, double pct)
+{
+    uint64_t want = (uint64_t)(s->commands * pct / 100.0), seen = 0;
+    for (int b = 0; b < LOAD_BUCKETS; b++) {
+        seen += s->latency[b];
+        if (seen > want) return (double)b;
+    }
+    return (double)(LOAD_BUCKETS - 1);
+}
@@ -0,0 +1,405 @@
+#define _GNU_SOURCE
+#define _CRT_SECURE_NO_WARNINGS
+#include "net.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+//splits "host:port" or "port", host NULL means every interface
+static void SplitAddr(const char* addr, char* host, size_t hostLen, const char** port)
+{
+    const char* colon = strrchr(addr, ':');
+    if (!colon) {
+        host[0] = '\0';
+        *port = addr;
+        return;
+    }
+    size_t n = (size_t)(colon - addr);
+    if (n >= hostLen) n = hostLen - 1;
+    memcpy(host, addr, n);
+    host[n] = '\0';
+    *port = colon + 1;
+}
+
+#if defined(_WIN32)
+
+int NetInit(void)
+{
+    WSADATA wsa;
+    return WSAStartup(MAKEWORD(2, 2), &wsa) == 0;
+}
+
+static void NonBlocking(SOCKET s)
+{
+    u_long on = 1;
+    ioctlsocket(s, FIONBIO, &on);
+}
+
+static void NoDelay(SOCKET s)
+{
+    int on = 1;
+    setsockopt(s, IPPROTO_TCP, TCP_NODELAY, (const char*)&on, sizeof(on));
+}
+
+NetSocket NetListen(const char* addr)
+{
+    if (strncmp(addr, "unix:", 5) == 0) {
+        fprintf(stderr, "net: unix sockets aren't supported here, use host:port\n");
+        return NET_NONE;
+    }
+    char host[256];
+    const char* port;
+    SplitAddr(addr, host, sizeof(host), &port);
+    struct addrinfo hints, *res;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    if (getaddrinfo(host[0] ? host : NULL, port, &hints, &res) != 0) {
+        return NET_NONE;
+    }
+    SOCKET s = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+    int ok = s != INVALID_SOCKET && bind(s, res->ai_addr, (int)res->ai_addrlen) == 0 && listen(s, SOMAXCONN) == 0;
+    freeaddrinfo(res);
+    if (!ok) {
+        if (s != INVALID_SOCKET) closesocket(s);
+        return NET_NONE;
+    }
+    NonBlocking(s);
+    return (NetSocket)s;
+}
+
+NetSocket NetAccept(NetSocket listener)
+{
+    SOCKET s = accept((SOCKET)listener, NULL, NULL);
+    if (s == INVALID_SOCKET) {
+        return NET_NONE;
+    }
+    NonBlocking(s);
+    NoDelay(s);
+    return (NetSocket)s;
+}
+
+NetSocket NetConnect(const char* addr)
+{
+    char host[256];
+    const char* port;
+    SplitAddr(addr, host, sizeof(host), &port);
+    struct addrinfo hints, *res;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host[0] ? host : "127.0.0.1", port, &hints, &res) != 0) {
+        return NET_NONE;
+    }
+    SOCKET s = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+    int ok = s != INVALID_SOCKET && connect(s, res->ai_addr, (int)res->ai_addrlen) == 0;
+    freeaddrinfo(res);
+    if (!ok) {
+        if (s != INVALID_SOCKET) closesocket(s);
+        return NET_NONE;
+    }
+    NoDelay(s);
+    return (NetSocket)s;
+}
+
+void NetClose(NetSocket s)
+{
+    closesocket((SOCKET)s);
+}
+
+int NetRecv(NetSocket s, void* buf, int len)
+{
+    int n = recv((SOCKET)s, (char*)buf, len, 0);
+    if (n >= 0) {
+        return n;
+    }
+    return WSAGetLastError() == WSAEWOULDBLOCK ? NET_AGAIN : NET_FAILED;
+}
+
+int NetSend(NetSocket s, const void* buf, int len)
+{
+    int n = send((SOCKET)s, (const char*)buf, len, 0);
+    if (n >= 0) {
+        return n;
+    }
+    return WSAGetLastError() == WSAEWOULDBLOCK ? NET_AGAIN : NET_FAILED;
+}
+
+//no epoll here, WSAPoll walks the whole set each wait which is fine for a local server
+typedef struct {
+    WSAPOLLFD* fds;
+    void** ctx;
+    int count, cap;
+} Poller;
+
+int NetPollerInit(NetPoller* p)
+{
+    p->impl = calloc(1, sizeof(Poller));
+    return p->impl != NULL;
+}
+
+void NetPollerFree(NetPoller* p)
+{
+    Poller* q = (Poller*)p->impl;
+    if (q) {
+        free(q->fds);
+        free(q->ctx);
+        free(q);
+    }
+    p->impl = NULL;
+}
+
+int NetPollerSet(NetPoller* p, NetSocket s, int events, void* ctx)
+{
+    Poller* q = (Poller*)p->impl;
+    int i = 0;
+    while (i < q->count && q->fds[i].fd != (SOCKET)s) i++;
+    if (i == q->count) {
+        if (q->count == q->cap) {
+            int cap = q->cap ? q->cap * 2 : 64;
+            WSAPOLLFD* fds = (WSAPOLLFD*)realloc(q->fds, (size_t)cap * sizeof(WSAPOLLFD));
+            if (fds) q->fds = fds;
+            void** c = (void**)realloc(q->ctx, (size_t)cap * sizeof(void*));
+            if (c) q->ctx = c;
+            if (!fds || !c) {
+                return 0;
+            }
+            q->cap = cap;
+        }
+        q->count++;
+    }
+    q->fds[i].fd = (SOCKET)s;
+    q->fds[i].events = (SHORT)(((events & NET_READ) ? POLLRDNORM : 0) | ((events & NET_WRITE) ? POLLWRNORM : 0));
+    q->fds[i].revents = 0;
+    q->ctx[i] = ctx;
+    return 1;
+}
+
+void NetPollerRemove(NetPoller* p, NetSocket s)
+{
+    Poller* q = (Poller*)p->impl;
+    for (int i = 0; i < q->count; i++) {
+        if (q->fds[i].fd != (SOCKET)s) continue;
+        q->count--;
+        q->fds[i] = q->fds[q->count];
+        q->ctx[i] = q->ctx[q->count];
+        return;
+    }
+}
+
+int NetPollerWait(NetPoller* p, NetEvent* out, int max, int timeoutMs)
+{
+    Poller* q = (Poller*)p->impl;
+    if (!q->count) {
+        Sleep(timeoutMs < 0 ? 10 : (DWORD)timeoutMs);
+        return 0;
+    }
+    if (WSAPoll(q->fds, (ULONG)q->count, timeoutMs) < 0) {
+        return -1;
+    }
+    int n = 0;
+    for (int i = 0; i < q->count && n < max; i++) {
+        SHORT r = q->fds[i].revents;
+        if (!r) continue;
+        out[n].ctx = q->ctx[i];
+        out[n].events = ((r & (POLLRDNORM | POLLHUP | POLLERR)) ? NET_READ : 0) | ((r & POLLWRNORM) ? NET_WRITE : 0);
+        n++;
+    }
+    return n;
+}
+
+#else
+
+int NetInit(void)
+{
+    signal(SIGPIPE, SIG_IGN); //a client that drops shows up as a failed send, not a dead server
+    return 1;
+}
+
+static void NoDelay(int s)
+{
+    int on = 1;
+    setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+}
+
+static int UnixAddr(const char* path, struct sockaddr_un* sa)
+{
+    memset(sa, 0, sizeof(*sa));
+    sa->sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(sa->sun_path)) {
+        return 0;
+    }
+    strcpy(sa->sun_path, path);
+    return 1;
+}
+
+NetSocket NetListen(const char* addr)
+{
+    int s = -1, ok = 0;
+    if (strncmp(addr, "unix:", 5) == 0) {
+        struct sockaddr_un sa;
+        if (!UnixAddr(addr + 5, &sa)) {
+            return NET_NONE;
+        }
+        unlink(sa.sun_path); //left over from a server that didn't get to clean up
+        s = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        ok = s >= 0 && bind(s, (struct sockaddr*)&sa, sizeof(sa)) == 0 && listen(s, SOMAXCONN) == 0;
+    }
+    else {
+        char host[256];
+        const char* port;
+        SplitAddr(addr, host, sizeof(host), &port);
+        struct addrinfo hints, *res;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_PASSIVE;
+        if (getaddrinfo(host[0] ? host : NULL, port, &hints, &res) != 0) {
+            return NET_NONE;
+        }
+        s = socket(res->ai_family, res->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, res->ai_protocol);
+        int on = 1;
+        if (s >= 0) setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        ok = s >= 0 && bind(s, res->ai_addr, res->ai_addrlen) == 0 && listen(s, SOMAXCONN) == 0;
+        freeaddrinfo(res);
+    }
+    if (!ok) {
+        if (s >= 0) close(s);
+        return NET_NONE;
+    }
+    return (NetSocket)s;
+}
+
+NetSocket NetAccept(NetSocket listener)
+{
+    int s = accept4((int)listener, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (s < 0) {
+        return NET_NONE;
+    }
+    NoDelay(s); //fails quietly on unix sockets
+    return (NetSocket)s;
+}
+
+NetSocket NetConnect(const char* addr)
+{
+    int s = -1, ok = 0;
+    if (strncmp(addr, "unix:", 5) == 0) {
+        struct sockaddr_un sa;
+        if (!UnixAddr(addr + 5, &sa)) {
+            return NET_NONE;
+        }
+        s = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        ok = s >= 0 && connect(s, (struct sockaddr*)&sa, sizeof(sa)) == 0;
+    }
+    else {
+        char host[256];
+        const char* port;
+        SplitAddr(addr, host, sizeof(host), &port);
+        struct addrinfo hints, *res;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        if (getaddrinfo(host[0] ? host : "127.0.0.1", port, &hints, &res) != 0) {
+            return NET_NONE;
+        }
+        s = socket(res->ai_family, res->ai_socktype | SOCK_CLOEXEC, res->ai_protocol);
+        ok = s >= 0 && connect(s, res->ai_addr, res->ai_addrlen) == 0;
+        freeaddrinfo(res);
+        if (ok) NoDelay(s);
+    }
+    if (!ok) {
+        if (s >= 0) close(s);
+        return NET_NONE;
+    }
+    return (NetSocket)s;
+}
+
+void NetClose(NetSocket s)
+{
+    close((int)s);
+}
+
+int NetRecv(NetSocket s, void* buf, int len)
+{
+    ssize_t n = recv((int)s, buf, (size_t)len, 0);
+    if (n >= 0) {
+        return (int)n;
+    }
+    return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? NET_AGAIN : NET_FAILED;
+}
+
+int NetSend(NetSocket s, const void* buf, int len)
+{
+    ssize_t n = send((int)s, buf, (size_t)len, MSG_NOSIGNAL);
+    if (n >= 0) {
+        return (int)n;
+    }
+    return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? NET_AGAIN : NET_FAILED;
+}
+
+int NetPollerInit(NetPoller* p)
+{
+    int fd = epoll_create1(EPOLL_CLOEXEC);
+    p->impl = (void*)(intptr_t)fd;
+    return fd >= 0;
+}
+
+void NetPollerFree(NetPoller* p)
+{
+    close((int)(intptr_t)p->impl);
+    p->impl = (void*)(intptr_t)-1;
+}
+
+int NetPollerSet(NetPoller* p, NetSocket s, int events, void* ctx)
+{
+    int ep = (int)(intptr_t)p->impl;
+    struct epoll_event e;
+    e.events = ((events & NET_READ) ? EPOLLIN : 0) | ((events & NET_WRITE) ? EPOLLOUT : 0);
+    e.data.ptr = ctx;
+    if (epoll_ctl(ep, EPOLL_CTL_MOD, (int)s, &e) == 0) {
+        return 1;
+    }
+    return errno == ENOENT && epoll_ctl(ep, EPOLL_CTL_ADD, (int)s, &e) == 0;
+}
+
+void NetPollerRemove(NetPoller* p, NetSocket s)
+{
+    struct epoll_event e; //old kernels want one even for a delete
+    epoll_ctl((int)(intptr_t)p->impl, EPOLL_CTL_DEL, (int)s, &e);
+}
+
+int NetPollerWait(NetPoller* p, NetEvent* out, int max, int timeoutMs)
+{
+    struct epoll_event ev[256];
+    if (max > 256) max = 256;
+    int n = epoll_wait((int)(intptr_t)p->impl, ev, max, timeoutMs);
+    if (n < 0) {
+        return errno == EINTR ? 0 : -1;
+    }
+    for (int i = 0; i < n; i++) {
+        out[i].ctx = ev[i].data.ptr;
+        out[i].events = ((ev[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) ? NET_READ : 0) | ((ev[i].events & EPOLLOUT) ? NET_WRITE : 0);
+    }
+    return n;
+}
+
+#endif
@@ -0,0 +1,39 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+//non-blocking sockets and a readiness poller for the game server and its load generator.
+//epoll on linux, WSAPoll on windows. like sys.c the os headers stay inside net.c.
+//addresses are "unix:/path/to.sock", "host:port" or just "port" for every interface
+
+typedef intptr_t NetSocket;
+#define NET_NONE ((NetSocket)-1)
+
+#define NET_READ  1
+#define NET_WRITE 2
+
+#define NET_AGAIN  (-1) //nothing to read or no room to write right now
+#define NET_FAILED (-2)
+
+int       NetInit(void); //once per process before anything else
+NetSocket NetListen(const char* addr);
+NetSocket NetAccept(NetSocket listener); //NET_NONE when nobody is waiting
+NetSocket NetConnect(const char* addr); //blocking connect, the socket comes back blocking
+void      NetClose(NetSocket s);
+int       NetRecv(NetSocket s, void* buf, int len); //bytes, 0 once the peer closed, NET_AGAIN or NET_FAILED
+int       NetSend(NetSocket s, const void* buf, int len); //bytes, NET_AGAIN or NET_FAILED
+
+typedef struct {
+    void* ctx;
+    int events; //NET_READ, NET_WRITE, both
+} NetEvent;
+
+typedef struct {
+    void* impl;
+} NetPoller;
+
+int  NetPollerInit(NetPoller* p);
+void NetPollerFree(NetPoller* p);
+int  NetPollerSet(NetPoller* p, NetSocket s, int events, void* ctx); //adds or changes the watch
+void NetPollerRemove(NetPoller* p, NetSocket s);
+int  NetPollerWait(NetPoller* p, NetEvent* out, int max, int timeoutMs); //ready count, -1 on error
@@ -0,0 +1,123 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include "prof.h"
+#include "sys.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+const char* const profZoneNames[PROF_ZONES] = { "input", "io", "board", "players", "hud", "present" };
+
+typedef struct {
+    float ms[PROF_ZONES + 1]; //zones then the total
+} Sample;
+
+static Sample history[PROF_HISTORY];
+static int head, filled;
+static Sample now;
+static ProfZone current;
+static double since, frameStart;
+static bool running;
+static int tag;
+static uint64_t frameNo;
+static FILE* csv;
+
+static void Charge(double t)
+{
+    now.ms[current] += (float)((t - since) * 1000.0);
+    since = t;
+}
+
+void ProfFrame(int nextTag)
+{
+    double t = SysNow();
+    if (running) {
+        Charge(t);
+        now.ms[PROF_TOTAL] = (float)((t - frameStart) * 1000.0);
+        history[head] = now;
+        head = (head + 1) % PROF_HISTORY;
+        if (filled < PROF_HISTORY) filled++;
+        if (csv) {
+            fprintf(csv, "%llu,%d", (unsigned long long)frameNo, tag);
+            for (int z = 0; z <= PROF_ZONES; z++) fprintf(csv, ",%.3f", now.ms[z]);
+            fputc('\n', csv);
+        }
+        frameNo++;
+    }
+    memset(&now, 0, sizeof(now));
+    running = true;
+    current = PROF_INPUT;
+    since = frameStart = t;
+    tag = nextTag;
+}
+
+ProfZone ProfSwitch(ProfZone zone)
+{
+    ProfZone left = current;
+    if (running) Charge(SysNow());
+    current = zone;
+    return left;
+}
+
+int ProfFrameCount(void)
+{
+    return filled;
+}
+
+static int CompareFloat(const void* a, const void* b)
+{
+    float x = *(const float*)a, y = *(const float*)b;
+    return (x > y) - (x < y);
+}
+
+ProfStat ProfStats(int zone)
+{
+    ProfStat st = { 0, 0, 0 };
+    if (!filled || zone < 0 || zone > PROF_ZONES) {
+        return st;
+    }
+    float v[PROF_HISTORY];
+    for (int i = 0; i < filled; i++) v[i] = history[i].ms[zone];
+    qsort(v, (size_t)filled, sizeof(float), CompareFloat);
+    st.p50 = v[(filled - 1) / 2];
+    st.p99 = v[(filled - 1) * 99 / 100];
+    st.max = v[filled - 1];
+    return st;
+}
+
+void ProfHistogram(int zone, int* buckets)
+{
+    memset(buckets, 0, PROF_BUCKETS * sizeof(int));
+    if (zone < 0 || zone > PROF_ZONES) {
+        return;
+    }
+    for (int i = 0; i < filled; i++) {
+        int b = (int)history[i].ms[zone];
+        buckets[b < PROF_BUCKETS ? b : PROF_BUCKETS - 1]++;
+    }
+}
+
+bool ProfCsvStart(const char* path)
+{
+    ProfCsvStop();
+    csv = fopen(path, "w");
+    if (!csv) {
+        return false;
+    }
+    setvbuf(csv, NULL, _IOFBF, 1 << 16); //one write every few hundred frames, not one per frame
+    fprintf(csv, "frame,state");
+    for (int z = 0; z < PROF_ZONES; z++) fprintf(csv, ",%s_ms", profZoneNames[z]);
+    fprintf(csv, ",total_ms\n");
+    frameNo = 0;
+    return true;
+}
+
+void ProfCsvStop(void)
+{
+    if (csv) fclose(csv);
+    csv = NULL;
+}
+
+bool ProfCsvActive(void)
+{
+    return csv != NULL;
+}
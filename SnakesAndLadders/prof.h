@@ -0,0 +1,39 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+//where the frame time goes. the main loop switches zones as it moves through a frame and
+//every switch charges the time since the last one to the zone it leaves, so nested work is
+//only counted once. the last PROF_HISTORY frames are kept for the overlay, and a csv
+//stream writes every frame as it closes
+
+#define PROF_HISTORY 600 //ten seconds at 60 fps
+#define PROF_BUCKETS 34  //1 ms each for the histogram, the last one takes everything slower
+
+typedef enum {
+    PROF_INPUT,   //the update switch, per state
+    PROF_IO,      //IoPoll and its callbacks
+    PROF_BOARD,   //DrawBoard, layer redraws included
+    PROF_PLAYERS, //DrawPlayers
+    PROF_HUD,     //everything else drawn, text and buttons
+    PROF_PRESENT, //EndDrawing, so the swap and the fps wait
+    PROF_ZONES,
+    PROF_TOTAL = PROF_ZONES //whole frame, for ProfStats and ProfHistogram
+} ProfZone;
+
+typedef struct {
+    float p50, p99, max; //ms
+} ProfStat;
+
+extern const char* const profZoneNames[PROF_ZONES];
+
+void     ProfFrame(int tag); //closes the frame before and starts the next in PROF_INPUT, tag lands in the csv
+ProfZone ProfSwitch(ProfZone zone); //returns the zone it left so nested work can switch back
+int      ProfFrameCount(void); //frames in the history
+
+ProfStat ProfStats(int zone);
+void     ProfHistogram(int zone, int* buckets); //PROF_BUCKETS counts over the history
+
+bool ProfCsvStart(const char* path);
+void ProfCsvStop(void);
+bool ProfCsvActive(void);
@@ -0,0 +1,82 @@
+#pragma once
+#include <stdint.h>
+
+//counter based generator (philox4x32-10). a draw is a pure function of
+//(key, counter, stream, draw number), so any roll of any game can be worked out
+//straight from the game seed and the turn without replaying anything before it
+
+typedef enum {
+    RNG_DICE,     //counter = global turn
+    RNG_TAIL,     //chaos snake tail, counter = global turn
+    RNG_POLICY,   //headless snake placement choices, counter = global turn
+    RNG_COLOR,    //player colors, counter = seat
+    RNG_GAMESEED, //per game seeds of a batch, counter = game index
+    RNG_DESIGN    //board design search layouts, counter = layout number
+} RngStream;
+
+typedef struct {
+    uint64_t key;
+    uint64_t ctr;
+    uint32_t stream;
+    uint32_t block; //next block to compute
+    uint32_t buf[4];
+    int used;       //words of buf already handed out
+} Rng;
+
+static inline void Philox4x32(uint64_t key, const uint32_t in[4], uint32_t out[4])
+{
+    uint32_t k0 = (uint32_t)key, k1 = (uint32_t)(key >> 32);
+    uint32_t c0 = in[0], c1 = in[1], c2 = in[2], c3 = in[3];
+    for (int i = 0; i < 10; i++) {
+        uint64_t p0 = (uint64_t)0xD2511F53u * c0;
+        uint64_t p1 = (uint64_t)0xCD9E8D57u * c2;
+        c0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+        c2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+        c1 = (uint32_t)p1;
+        c3 = (uint32_t)p0;
+        k0 += 0x9E3779B9u;
+        k1 += 0xBB67AE85u;
+    }
+    out[0] = c0; out[1] = c1; out[2] = c2; out[3] = c3;
+}
+
+static inline Rng RngAt(uint64_t key, uint64_t ctr, RngStream stream)
+{
+    Rng r;
+    r.key = key;
+    r.ctr = ctr;
+    r.stream = (uint32_t)stream;
+    r.block = 0;
+    r.used = 4;
+    return r;
+}
+
+static inline uint32_t RngNext32(Rng* r)
+{
+    if (r->used == 4) {
+        uint32_t in[4] = { (uint32_t)r->ctr, (uint32_t)(r->ctr >> 32), r->stream, r->block++ };
+        Philox4x32(r->key, in, r->buf);
+        r->used = 0;
+    }
+    return r->buf[r->used++];
+}
+
+static inline uint64_t RngNext(Rng* r)
+{
+    uint64_t hi = RngNext32(r);
+    return hi << 32 | RngNext32(r);
+}
+
+//inclusive on both ends like GetRandomValue
+static inline int RngRange(Rng* r, int lo, int hi)
+{
+    uint64_t span = (uint64_t)(hi - lo + 1);
+    return lo + (int)(((uint64_t)RngNext32(r) * span) >> 32);
+}
+
+//seed for game number index of a batch, the same whichever thread plays it
+static inline uint64_t GameSeed(uint64_t batchSeed, uint64_t index)
+{
+    Rng r = RngAt(batchSeed, index, RNG_GAMESEED);
+    return RngNext(&r);
+}
@@ -0,0 +1,174 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include "rules.h"
+#include <stdio.h>
+#include <string.h>
+
+#define LOOP_TWO_DICE (1u << RULE_BITS)
+#define LOOP_CHAOS    (1u << (RULE_BITS + 1))
+
+#if defined(_MSC_VER)
+#define RULES_INLINE static __forceinline
+#else
+#define RULES_INLINE static inline __attribute__((always_inline))
+#endif
+
+static const char* const ruleNames[RULE_BITS] = { "exact", "six", "three", "doubles" };
+
+bool RulesParse(const char* text, uint32_t* rules)
+{
+    *rules = 0;
+    if (strcmp(text, "classic") == 0) {
+        return true;
+    }
+    while (*text) {
+        size_t len = strcspn(text, "+,");
+        int bit = 0;
+        for (; bit < RULE_BITS; bit++) {
+            if (strlen(ruleNames[bit]) == len && strncmp(text, ruleNames[bit], len) == 0) break;
+        }
+        if (bit == RULE_BITS) {
+            return false;
+        }
+        *rules |= 1u << bit;
+        text += len;
+        if (*text) text++;
+    }
+    return true;
+}
+
+void RulesName(uint32_t rules, char* buf, int len)
+{
+    int at = snprintf(buf, (size_t)len, "%s", rules ? "" : "classic");
+    for (int bit = 0; bit < RULE_BITS && at < len; bit++) {
+        if (rules >> bit & 1) at += snprintf(buf + at, (size_t)(len - at), "%s%s", at ? "+" : "", ruleNames[bit]);
+    }
+}
+
+//the template. v is a constant in every copy, so each rule test below folds away and what's
+//left is that variant's own straight line turn. the end of a turn is GameFinishMove's.
+//st and tr are NULL in the table's copies, so the counting and the recording fold away there too
+RULES_INLINE void PlayRules(const SimConfig* cfg, uint64_t seed, GameResult* out, const uint32_t v, Stats* st, TrajBuf* tr)
+{
+    const bool exact = v & RULE_EXACT_WIN, six = v & RULE_SIX_AGAIN, three = v & RULE_THREE_SIXES;
+    const bool two = v & LOOP_TWO_DICE, doubles = two && (v & RULE_DOUBLES_AGAIN), chaos = v & LOOP_CHAOS;
+    Game g;
+    GameInit(&g, cfg->playerCount, two ? 2 : 1, chaos ? MODE_CHAOS : MODE_CLASSIC, seed);
+    memset(out, 0, sizeof(*out));
+    const int tiles = g.board.tiles;
+    uint64_t chaosHeads[BOARD_TILES / 64 + 1] = { 0 }; //headless games are on the default board
+    uint32_t block[4];
+    int rolls = 0;
+
+    while (g.winner < 0 && g.globalTurn < MAX_GAME_TURNS) {
+        int cur = g.currentPlayer;
+        if (chaos && g.canPlace[cur] && cfg->policy) {
+            Rng rng = RngAt(seed, (uint64_t)g.globalTurn, RNG_POLICY);
+            int head = cfg->policy(&g, &rng, cfg->policyCtx);
+            if (head && GamePlaceSnake(&g, head) == PLACE_OK) {
+                out->snakesPlaced++;
+                if (st) {
+                    StatsPlaced(st);
+                    chaosHeads[head >> 6] |= 1ull << (head & 63);
+                }
+            }
+        }
+
+        int pos = g.position[cur], start = pos, streak = 0;
+        for (;;) {
+            if (!(rolls & 1)) DiceBlock(seed, rolls, block);
+            const uint32_t* w = block + 2 * (rolls & 1);
+            rolls++;
+            int a = DieFace(w[0]), b = two ? DieFace(w[1]) : 0;
+            if (st) StatsRoll(st, a + b);
+            bool again = (six && (a == 6 || b == 6)) || (doubles && a == b);
+            if (three && again && ++streak == 3) {
+                pos = start;
+                if (tr) TrajMove(tr, cur, a + b, start, false);
+                break;
+            }
+
+            int t = pos + a + b;
+            int landed = (t <= tiles) ? t : (exact ? pos : 2 * tiles - t);
+            if (exact && two && (pos + a == tiles || pos + b == tiles)) landed = tiles;
+            int to = Slide(&g.board, landed);
+            out->bounces += t > tiles;
+            out->snakeHits += to < landed;
+            out->ladderHits += to > landed;
+            if (st) StatsMove(st, tiles, landed, to, t > tiles, chaosHeads[landed >> 6] >> (landed & 63) & 1);
+            if (tr) TrajMove(tr, cur, a + b, to, t > tiles);
+            pos = to;
+            if (!again || pos == tiles) break;
+        }
+
+        g.position[cur] = pos;
+        g.personalTurn[cur]++;
+        g.globalTurn++;
+        if (chaos && g.personalTurn[cur] == CHAOS_PLACE_EVERY) {
+            g.personalTurn[cur] = 0;
+            if (g.board.snakeCount < MAX_SNAKES) g.canPlace[cur] = true;
+        }
+        if (pos == tiles) {
+            g.winner = cur;
+        }
+        else {
+            g.currentPlayer = (cur + 1 == g.playerCount) ? 0 : cur + 1;
+        }
+    }
+
+    out->winner = g.winner;
+    out->turns = g.globalTurn;
+    if (st) StatsGameEnd(st, g.winner, g.globalTurn);
+    if (tr) TrajGameEnd(tr);
+}
+
+typedef void (*RulesLoop)(const SimConfig* cfg, uint64_t seed, GameResult* out);
+
+//one function per variant, named by the variant number in octal
+#define LOOP(a, b) static void Loop##a##b(const SimConfig* cfg, uint64_t seed, GameResult* out) { PlayRules(cfg, seed, out, (a) * 8 + (b), NULL, NULL); }
+#define LOOP_ROW(a) LOOP(a, 0) LOOP(a, 1) LOOP(a, 2) LOOP(a, 3) LOOP(a, 4) LOOP(a, 5) LOOP(a, 6) LOOP(a, 7)
+LOOP_ROW(0) LOOP_ROW(1) LOOP_ROW(2) LOOP_ROW(3) LOOP_ROW(4) LOOP_ROW(5) LOOP_ROW(6) LOOP_ROW(7)
+
+#define ENTRY_ROW(a) Loop##a##0, Loop##a##1, Loop##a##2, Loop##a##3, Loop##a##4, Loop##a##5, Loop##a##6, Loop##a##7
+static const RulesLoop loops[RULE_LOOPS] = {
+    ENTRY_ROW(0), ENTRY_ROW(1), ENTRY_ROW(2), ENTRY_ROW(3), ENTRY_ROW(4), ENTRY_ROW(5), ENTRY_ROW(6), ENTRY_ROW(7)
+};
+
+static uint32_t Variant(const SimConfig* cfg)
+{
+    return (cfg->rules & RULE_ALL) | (cfg->diceCount == 2 ? LOOP_TWO_DICE : 0) | (cfg->mode == MODE_CHAOS ? LOOP_CHAOS : 0);
+}
+
+static RulesLoop PickLoop(const SimConfig* cfg)
+{
+    return loops[Variant(cfg)];
+}
+
+//the one loop that counts and records, the variant is read as it plays. a test per rule per
+//roll costs little next to the counting
+static void StatsLoop(const SimConfig* cfg, uint64_t seed, GameResult* out, Stats* st, TrajBuf* tr)
+{
+    PlayRules(cfg, seed, out, Variant(cfg), st, tr);
+}
+
+void RulesSimulateGame(const SimConfig* cfg, uint64_t seed, GameResult* out)
+{
+    PickLoop(cfg)(cfg, seed, out);
+}
+
+void RulesRange(const SimConfig* cfg, uint64_t batchSeed, uint64_t first, uint64_t last, SimSummary* sum, Stats* st, TrajBuf* tr)
+{
+    if (st || tr) {
+        for (uint64_t i = first; i < last; i++) {
+            GameResult r;
+            StatsLoop(cfg, GameSeed(batchSeed, i), &r, st, tr);
+            SimRecordGame(sum, &r);
+        }
+        return;
+    }
+    RulesLoop loop = PickLoop(cfg); //picked once, the games in the range all run the same loop
+    for (uint64_t i = first; i < last; i++) {
+        GameResult r;
+        loop(cfg, GameSeed(batchSeed, i), &r);
+        SimRecordGame(sum, &r);
+    }
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include "sim.h"
+#include "traj.h"
+
+//house rules for headless games, any mix of them on top of the classic turn. a mix, the dice
+//count and the mode pick one of RULE_LOOPS game loops, all stamped out of one template with
+//their rules as constants, so each loop only holds the code of its own rules and never tests
+//one while it plays. no rules at all plays exactly what SimulateGame plays, roll for roll
+//
+//extra rolls draw the dice of the next roll index, so a game's rolls are still a pure
+//function of its seed. turns in the results count whole turns, extra rolls included in them
+
+typedef enum {
+    RULE_EXACT_WIN     = 1 << 0, //a roll past the last tile doesn't move instead of bouncing back. with two
+                                 //dice either die alone may finish, or a token on the tile before could never win
+    RULE_SIX_AGAIN     = 1 << 1, //a six rolls again, with two dice either die showing one
+    RULE_THREE_SIXES   = 1 << 2, //the third extra roll in a row forfeits the turn and the token goes back to where it began
+    RULE_DOUBLES_AGAIN = 1 << 3  //two dice showing the same face roll again
+} RuleFlag;
+
+#define RULE_BITS  4
+#define RULE_ALL   ((1u << RULE_BITS) - 1)
+#define RULE_LOOPS (1 << (RULE_BITS + 2)) //every mix, with one or two dice, classic or chaos
+
+//"exact+six+three+doubles" in any order and any subset, "classic" for none
+bool RulesParse(const char* text, uint32_t* rules);
+void RulesName(uint32_t rules, char* buf, int len);
+
+void RulesSimulateGame(const SimConfig* cfg, uint64_t seed, GameResult* out);
+//st counts every roll, move and game of the range into that shard and tr records each of them,
+//both NULL plays the plain loops
+void RulesRange(const SimConfig* cfg, uint64_t batchSeed, uint64_t first, uint64_t last, SimSummary* sum, Stats* st, TrajBuf* tr);
@@ -0,0 +1,424 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include "save.h"
+#include "sys.h"
+#include <stdio.h>
+#include <string.h>
+
+#define GAME_LEN   68
+#define TURN_LEN   28
+#define PLAYER_LEN 40
+#define LINK_LEN   8
+#define GEOM_LEN   8
+#define V1_HEAD    20 //playerCount, currentPlayer, diceCount, mode, snakeCount
+#define V1_PLAYER  44 //int position, Color, char name[32], int playerNumber
+
+//crc-32 (the zip one), byte table
+uint32_t Crc32(uint32_t crc, const void* data, size_t len)
+{
+    static const uint32_t table[256] = {
+        0x00000000, 0x77073096, 0xEE0E612C, 0x990951BA, 0x076DC419, 0x706AF48F, 0xE963A535, 0x9E6495A3,
+        0x0EDB8832, 0x79DCB8A4, 0xE0D5E91E, 0x97D2D988, 0x09B64C2B, 0x7EB17CBD, 0xE7B82D07, 0x90BF1D91,
+        0x1DB71064, 0x6AB020F2, 0xF3B97148, 0x84BE41DE, 0x1ADAD47D, 0x6DDDE4EB, 0xF4D4B551, 0x83D385C7,
+        0x136C9856, 0x646BA8C0, 0xFD62F97A, 0x8A65C9EC, 0x14015C4F, 0x63066CD9, 0xFA0F3D63, 0x8D080DF5,
+        0x3B6E20C8, 0x4C69105E, 0xD56041E4, 0xA2677172, 0x3C03E4D1, 0x4B04D447, 0xD20D85FD, 0xA50AB56B,
+        0x35B5A8FA, 0x42B2986C, 0xDBBBC9D6, 0xACBCF940, 0x32D86CE3, 0x45DF5C75, 0xDCD60DCF, 0xABD13D59,
+        0x26D930AC, 0x51DE003A, 0xC8D75180, 0xBFD06116, 0x21B4F4B5, 0x56B3C423, 0xCFBA9599, 0xB8BDA50F,
+        0x2802B89E, 0x5F058808, 0xC60CD9B2, 0xB10BE924, 0x2F6F7C87, 0x58684C11, 0xC1611DAB, 0xB6662D3D,
+        0x76DC4190, 0x01DB7106, 0x98D220BC, 0xEFD5102A, 0x71B18589, 0x06B6B51F, 0x9FBFE4A5, 0xE8B8D433,
+        0x7807C9A2, 0x0F00F934, 0x9609A88E, 0xE10E9818, 0x7F6A0DBB, 0x086D3D2D, 0x91646C97, 0xE6635C01,
+        0x6B6B51F4, 0x1C6C6162, 0x856530D8, 0xF262004E, 0x6C0695ED, 0x1B01A57B, 0x8208F4C1, 0xF50FC457,
+        0x65B0D9C6, 0x12B7E950, 0x8BBEB8EA, 0xFCB9887C, 0x62DD1DDF, 0x15DA2D49, 0x8CD37CF3, 0xFBD44C65,
+        0x4DB26158, 0x3AB551CE, 0xA3BC0074, 0xD4BB30E2, 0x4ADFA541, 0x3DD895D7, 0xA4D1C46D, 0xD3D6F4FB,
+        0x4369E96A, 0x346ED9FC, 0xAD678846, 0xDA60B8D0, 0x44042D73, 0x33031DE5, 0xAA0A4C5F, 0xDD0D7CC9,
+        0x5005713C, 0x270241AA, 0xBE0B1010, 0xC90C2086, 0x5768B525, 0x206F85B3, 0xB966D409, 0xCE61E49F,
+        0x5EDEF90E, 0x29D9C998, 0xB0D09822, 0xC7D7A8B4, 0x59B33D17, 0x2EB40D81, 0xB7BD5C3B, 0xC0BA6CAD,
+        0xEDB88320, 0x9ABFB3B6, 0x03B6E20C, 0x74B1D29A, 0xEAD54739, 0x9DD277AF, 0x04DB2615, 0x73DC1683,
+        0xE3630B12, 0x94643B84, 0x0D6D6A3E, 0x7A6A5AA8, 0xE40ECF0B, 0x9309FF9D, 0x0A00AE27, 0x7D079EB1,
+        0xF00F9344, 0x8708A3D2, 0x1E01F268, 0x6906C2FE, 0xF762575D, 0x806567CB, 0x196C3671, 0x6E6B06E7,
+        0xFED41B76, 0x89D32BE0, 0x10DA7A5A, 0x67DD4ACC, 0xF9B9DF6F, 0x8EBEEFF9, 0x17B7BE43, 0x60B08ED5,
+        0xD6D6A3E8, 0xA1D1937E, 0x38D8C2C4, 0x4FDFF252, 0xD1BB67F1, 0xA6BC5767, 0x3FB506DD, 0x48B2364B,
+        0xD80D2BDA, 0xAF0A1B4C, 0x36034AF6, 0x41047A60, 0xDF60EFC3, 0xA867DF55, 0x316E8EEF, 0x4669BE79,
+        0xCB61B38C, 0xBC66831A, 0x256FD2A0, 0x5268E236, 0xCC0C7795, 0xBB0B4703, 0x220216B9, 0x5505262F,
+        0xC5BA3BBE, 0xB2BD0B28, 0x2BB45A92, 0x5CB36A04, 0xC2D7FFA7, 0xB5D0CF31, 0x2CD99E8B, 0x5BDEAE1D,
+        0x9B64C2B0, 0xEC63F226, 0x756AA39C, 0x026D930A, 0x9C0906A9, 0xEB0E363F, 0x72076785, 0x05005713,
+        0x95BF4A82, 0xE2B87A14, 0x7BB12BAE, 0x0CB61B38, 0x92D28E9B, 0xE5D5BE0D, 0x7CDCEFB7, 0x0BDBDF21,
+        0x86D3D2D4, 0xF1D4E242, 0x68DDB3F8, 0x1FDA836E, 0x81BE16CD, 0xF6B9265B, 0x6FB077E1, 0x18B74777,
+        0x88085AE6, 0xFF0F6A70, 0x66063BCA, 0x11010B5C, 0x8F659EFF, 0xF862AE69, 0x616BFFD3, 0x166CCF45,
+        0xA00AE278, 0xD70DD2EE, 0x4E048354, 0x3903B3C2, 0xA7672661, 0xD06016F7, 0x4969474D, 0x3E6E77DB,
+        0xAED16A4A, 0xD9D65ADC, 0x40DF0B66, 0x37D83BF0, 0xA9BCAE53, 0xDEBB9EC5, 0x47B2CF7F, 0x30B5FFE9,
+        0xBDBDF21C, 0xCABAC28A, 0x53B39330, 0x24B4A3A6, 0xBAD03605, 0xCDD70693, 0x54DE5729, 0x23D967BF,
+        0xB3667A2E, 0xC4614AB8, 0x5D681B02, 0x2A6F2B94, 0xB40BBE37, 0xC30C8EA1, 0x5A05DF1B, 0x2D02EF8D
+    };
+    const uint8_t* p = (const uint8_t*)data;
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc = (crc >> 8) ^ table[(crc ^ p[i]) & 0xFF];
+    }
+    return ~crc;
+}
+
+//byte at a time so neither the host's endianness nor alignment matters
+static uint32_t Rd16(const uint8_t* p) { return (uint32_t)p[0] | (uint32_t)p[1] << 8; }
+static uint32_t Rd32(const uint8_t* p) { return Rd16(p) | Rd16(p + 2) << 16; }
+static uint64_t Rd64(const uint8_t* p) { return (uint64_t)Rd32(p) | (uint64_t)Rd32(p + 4) << 32; }
+static int32_t  RdI32(const uint8_t* p) { return (int32_t)Rd32(p); }
+
+static void Wr16(uint8_t* p, uint32_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+static void Wr32(uint8_t* p, uint32_t v) { Wr16(p, v); Wr16(p + 2, v >> 16); }
+static void Wr64(uint8_t* p, uint64_t v) { Wr32(p, (uint32_t)v); Wr32(p + 4, (uint32_t)(v >> 32)); }
+
+int SaveCheck(const uint8_t* data, size_t size)
+{
+    if (size < SAVE_HEADER_LEN || Rd32(data) != SAVE_MAGIC || Rd16(data + 4) != SAVE_VERSION) {
+        return 0;
+    }
+    uint32_t headerLen = Rd16(data + 6), fileSize = Rd32(data + 8);
+    uint32_t count = Rd32(data + 12), table = Rd32(data + 16);
+    if (headerLen != SAVE_HEADER_LEN || fileSize != size || count > 64) {
+        return 0;
+    }
+    if (table < SAVE_HEADER_LEN || table > size || (size - table) / SAVE_ENTRY_LEN < count) {
+        return 0;
+    }
+
+    uint32_t crc = Crc32(0, data, 24);
+    crc = Crc32(crc, data + table, (size_t)count * SAVE_ENTRY_LEN);
+    if (crc != Rd32(data + 24)) {
+        return 0;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        const uint8_t* e = data + table + i * SAVE_ENTRY_LEN;
+        uint32_t off = Rd32(e + 4), len = Rd32(e + 8);
+        if (off > size || len > size - off) {
+            return 0;
+        }
+        if (Crc32(0, data + off, len) != Rd32(e + 12)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+const uint8_t* SaveSection(const uint8_t* data, size_t size, uint32_t id, uint32_t* len)
+{
+    (void)size; //SaveCheck already bounded every entry
+    uint32_t count = Rd32(data + 12), table = Rd32(data + 16);
+    for (uint32_t i = 0; i < count; i++) {
+        const uint8_t* e = data + table + i * SAVE_ENTRY_LEN;
+        if (Rd32(e) == id) {
+            *len = Rd32(e + 8);
+            return data + Rd32(e + 4);
+        }
+    }
+    return NULL;
+}
+
+static int ValidTile(int t, int tiles)
+{
+    return t >= 1 && t <= tiles;
+}
+
+//anything a loaded state could index with or loop on
+static int StateValid(const SaveState* s)
+{
+    const Game* g = &s->game;
+    if (g->playerCount < 1 || g->playerCount > MAX_PLAYERS || g->diceCount < 1 || g->diceCount > 2) {
+        return 0;
+    }
+    if ((g->mode != MODE_CLASSIC && g->mode != MODE_CHAOS) || g->currentPlayer < 0 || g->currentPlayer >= g->playerCount) {
+        return 0;
+    }
+    if (g->winner < -1 || g->winner >= g->playerCount || g->globalTurn < 0) {
+        return 0;
+    }
+    for (int i = 0; i < g->playerCount; i++) {
+        if (!ValidTile(g->position[i], g->board.tiles) || g->personalTurn[i] < 0) return 0;
+    }
+
+    if (s->phase != SAVE_PHASE_TURN) {
+        int maxB = g->diceCount == 2 ? 6 : 0;
+        int minB = g->diceCount == 2 ? 1 : 0;
+        if (s->dieA < 1 || s->dieA > 6 || s->dieB < minB || s->dieB > maxB || s->diceTotal != s->dieA + s->dieB) {
+            return 0;
+        }
+    }
+    if (s->phase == SAVE_PHASE_MOVING) {
+        if (s->walk.stepsRemaining < 1 || s->walk.stepsRemaining > 12 || (s->walk.stepDir != 1 && s->walk.stepDir != -1)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+//snakes and ladders are read as raw pairs and checked before any of them reach the board
+static int ReadLinks(const uint8_t* p, uint32_t len, int max, int tiles, int pairs[][2], int* count)
+{
+    if (len % LINK_LEN || len / LINK_LEN > (uint32_t)max) {
+        return 0;
+    }
+    *count = (int)(len / LINK_LEN);
+    for (int i = 0; i < *count; i++) {
+        pairs[i][0] = RdI32(p + i * LINK_LEN);
+        pairs[i][1] = RdI32(p + i * LINK_LEN + 4);
+        if (!ValidTile(pairs[i][0], tiles) || !ValidTile(pairs[i][1], tiles)) return 0;
+    }
+    return 1;
+}
+
+static void BuildBoard(Board* b, int snakes[][2], int snakeCount, int ladders[][2], int ladderCount)
+{
+    b->ladderCount = 0;
+    BoardClearSnakes(b);
+    for (int i = 0; i < snakeCount; i++) BoardAddSnake(b, snakes[i][0], snakes[i][1]);
+    for (int i = 0; i < ladderCount; i++) BoardAddLadder(b, ladders[i][0], ladders[i][1]);
+}
+
+static void ReadName(char* dst, const uint8_t* src)
+{
+    memcpy(dst, src, SAVE_NAME_LEN);
+    dst[SAVE_NAME_LEN - 1] = '\0'; //v1 files pad with junk after the terminator, and a bad file may have none
+}
+
+static int DecodeV2(const uint8_t* data, size_t size, SaveState* s)
+{
+    if (!SaveCheck(data, size)) {
+        return 0;
+    }
+    uint32_t gameLen, turnLen = 0, playerLen, snakeLen, ladderLen, geomLen = 0;
+    const uint8_t* gp = SaveSection(data, size, SAVE_SEC_GAME, &gameLen);
+    const uint8_t* tp = SaveSection(data, size, SAVE_SEC_TURN, &turnLen);
+    const uint8_t* pp = SaveSection(data, size, SAVE_SEC_PLAYER, &playerLen);
+    const uint8_t* sp = SaveSection(data, size, SAVE_SEC_SNAKE, &snakeLen);
+    const uint8_t* lp = SaveSection(data, size, SAVE_SEC_LADDER, &ladderLen);
+    const uint8_t* bp = SaveSection(data, size, SAVE_SEC_GEOM, &geomLen);
+    if (!gp || !pp || !sp || !lp || gameLen < GAME_LEN || (tp && turnLen < TURN_LEN) || (bp && geomLen < GEOM_LEN)) {
+        return 0;
+    }
+
+    Game* g = &s->game;
+    GameInit(g, (int)Rd32(gp + 12), (int)Rd32(gp + 16), (Mode)Rd32(gp + 8), Rd64(gp));
+    g->currentPlayer = (int)Rd32(gp + 20);
+    g->globalTurn = RdI32(gp + 24);
+    g->winner = RdI32(gp + 28);
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        g->position[i] = RdI32(gp + 32 + 4 * i);
+        g->personalTurn[i] = RdI32(gp + 48 + 4 * i);
+        g->canPlace[i] = gp[64 + i] != 0;
+    }
+    if (bp) {
+        int width = RdI32(bp), height = RdI32(bp + 4);
+        if (width < BOARD_MIN_SIDE || width > BOARD_MAX_SIDE || height < BOARD_MIN_SIDE || height > BOARD_MAX_SIDE) {
+            return 0;
+        }
+        BoardInit(&g->board, width, height);
+    }
+
+    int snakes[MAX_SNAKES][2], ladders[MAX_LADDERS][2], snakeCount, ladderCount;
+    int tiles = g->board.tiles;
+    if (!ReadLinks(sp, snakeLen, MAX_SNAKES, tiles, snakes, &snakeCount) || !ReadLinks(lp, ladderLen, MAX_LADDERS, tiles, ladders, &ladderCount)) {
+        return 0;
+    }
+    BuildBoard(&g->board, snakes, snakeCount, ladders, ladderCount);
+
+    if (g->playerCount < 1 || g->playerCount > MAX_PLAYERS || playerLen != (uint32_t)g->playerCount * PLAYER_LEN) {
+        return 0;
+    }
+    for (int i = 0; i < g->playerCount; i++) {
+        const uint8_t* p = pp + i * PLAYER_LEN;
+        ReadName(s->players[i].name, p);
+        memcpy(s->players[i].color, p + 32, 4);
+        s->players[i].playerNumber = RdI32(p + 36);
+    }
+
+    s->phase = SAVE_PHASE_TURN;
+    s->dieA = s->diceTotal = 1;
+    s->dieB = g->diceCount == 2 ? 1 : 0;
+    if (tp) {
+        s->phase = (SavePhase)Rd32(tp);
+        s->dieA = RdI32(tp + 4);
+        s->dieB = RdI32(tp + 8);
+        s->diceTotal = RdI32(tp + 12);
+        s->walk.stepsRemaining = RdI32(tp + 16);
+        s->walk.stepDir = RdI32(tp + 20);
+        s->walk.bouncing = Rd32(tp + 24) != 0;
+        if (s->phase > SAVE_PHASE_MOVING) return 0;
+    }
+    s->version = 2;
+    return 1;
+}
+
+//v1 never stored ladders, turns, placement rights or a seed. ladders were always the
+//default ones, the rest starts fresh and the seed comes from the file so it stays the same
+static int DecodeV1(const uint8_t* data, size_t size, SaveState* s)
+{
+    if (size < V1_HEAD) {
+        return 0;
+    }
+    int playerCount = RdI32(data), snakeCount = RdI32(data + 16);
+    if (playerCount < 1 || playerCount > MAX_PLAYERS || snakeCount < 0 || snakeCount > MAX_SNAKES) {
+        return 0;
+    }
+    if (size != V1_HEAD + (size_t)snakeCount * LINK_LEN + (size_t)playerCount * V1_PLAYER) {
+        return 0;
+    }
+
+    Game* g = &s->game;
+    GameInit(g, playerCount, RdI32(data + 8), (Mode)RdI32(data + 12), GameSeed(Crc32(0, data, size), 0));
+    g->currentPlayer = RdI32(data + 4);
+
+    int snakes[MAX_SNAKES][2], unused;
+    if (!ReadLinks(data + V1_HEAD, (uint32_t)snakeCount * LINK_LEN, MAX_SNAKES, BOARD_TILES, snakes, &unused)) {
+        return 0;
+    }
+    BoardClearSnakes(&g->board);
+    for (int i = 0; i < snakeCount; i++) BoardAddSnake(&g->board, snakes[i][0], snakes[i][1]);
+
+    const uint8_t* pp = data + V1_HEAD + (size_t)snakeCount * LINK_LEN;
+    for (int i = 0; i < playerCount; i++) {
+        const uint8_t* p = pp + i * V1_PLAYER;
+        g->position[i] = RdI32(p);
+        memcpy(s->players[i].color, p + 4, 4);
+        ReadName(s->players[i].name, p + 8);
+        s->players[i].playerNumber = RdI32(p + 40);
+    }
+
+    s->phase = SAVE_PHASE_TURN;
+    s->dieA = s->diceTotal = 1;
+    s->dieB = g->diceCount == 2 ? 1 : 0;
+    s->version = 1;
+    return 1;
+}
+
+int SaveDecode(const uint8_t* data, size_t size, SaveState* out)
+{
+    SaveState s;
+    memset(&s, 0, sizeof(s));
+    int ok = (size >= 4 && Rd32(data) == SAVE_MAGIC) ? DecodeV2(data, size, &s) : DecodeV1(data, size, &s);
+    if (!ok || !StateValid(&s)) {
+        return 0;
+    }
+    *out = s;
+    return 1;
+}
+
+int SaveRead(const char* path, SaveState* out)
+{
+    SysMap m;
+    if (!SysMapFile(path, &m)) {
+        return 0;
+    }
+    int ok = SaveDecode(m.data, m.size, out);
+    SysUnmapFile(&m);
+    return ok;
+}
+
+typedef struct {
+    uint8_t* buf;
+    uint32_t len;
+    uint32_t count;
+    uint8_t* table;
+} Writer;
+
+static uint8_t* AddSection(Writer* w, uint32_t id, uint32_t len)
+{
+    uint8_t* e = w->table + w->count++ * SAVE_ENTRY_LEN;
+    Wr32(e, id);
+    Wr32(e + 4, w->len);
+    Wr32(e + 8, len);
+    uint8_t* p = w->buf + w->len;
+    w->len += (len + 3) & ~3u;
+    return p;
+}
+
+static void SealSection(Writer* w, uint32_t i)
+{
+    uint8_t* e = w->table + i * SAVE_ENTRY_LEN;
+    Wr32(e + 12, Crc32(0, w->buf + Rd32(e + 4), Rd32(e + 8)));
+}
+
+uint32_t SaveEncode(const SaveState* s, uint8_t* buf)
+{
+    const Game* g = &s->game;
+    memset(buf, 0, SAVE_MAX_LEN);
+    Writer w = { buf, SAVE_HEADER_LEN + SAVE_SECTIONS * SAVE_ENTRY_LEN, 0, buf + SAVE_HEADER_LEN };
+
+    uint8_t* p = AddSection(&w, SAVE_SEC_GAME, GAME_LEN);
+    Wr64(p, g->seed);
+    Wr32(p + 8, (uint32_t)g->mode);
+    Wr32(p + 12, (uint32_t)g->playerCount);
+    Wr32(p + 16, (uint32_t)g->diceCount);
+    Wr32(p + 20, (uint32_t)g->currentPlayer);
+    Wr32(p + 24, (uint32_t)g->globalTurn);
+    Wr32(p + 28, (uint32_t)g->winner);
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        Wr32(p + 32 + 4 * i, (uint32_t)g->position[i]);
+        Wr32(p + 48 + 4 * i, (uint32_t)g->personalTurn[i]);
+        p[64 + i] = g->canPlace[i] ? 1 : 0;
+    }
+
+    p = AddSection(&w, SAVE_SEC_TURN, TURN_LEN);
+    Wr32(p, (uint32_t)s->phase);
+    Wr32(p + 4, (uint32_t)s->dieA);
+    Wr32(p + 8, (uint32_t)s->dieB);
+    Wr32(p + 12, (uint32_t)s->diceTotal);
+    Wr32(p + 16, (uint32_t)s->walk.stepsRemaining);
+    Wr32(p + 20, (uint32_t)s->walk.stepDir);
+    Wr32(p + 24, s->walk.bouncing ? 1 : 0);
+
+    p = AddSection(&w, SAVE_SEC_PLAYER, (uint32_t)g->playerCount * PLAYER_LEN);
+    for (int i = 0; i < g->playerCount; i++) {
+        uint8_t* q = p + i * PLAYER_LEN;
+        strncpy((char*)q, s->players[i].name, SAVE_NAME_LEN - 1);
+        memcpy(q + 32, s->players[i].color, 4);
+        Wr32(q + 36, (uint32_t)s->players[i].playerNumber);
+    }
+
+    p = AddSection(&w, SAVE_SEC_SNAKE, (uint32_t)g->board.snakeCount * LINK_LEN);
+    for (int i = 0; i < g->board.snakeCount; i++) {
+        Wr32(p + i * LINK_LEN, (uint32_t)g->board.snakes[i].start);
+        Wr32(p + i * LINK_LEN + 4, (uint32_t)g->board.snakes[i].end);
+    }
+
+    p = AddSection(&w, SAVE_SEC_LADDER, (uint32_t)g->board.ladderCount * LINK_LEN);
+    for (int i = 0; i < g->board.ladderCount; i++) {
+        Wr32(p + i * LINK_LEN, (uint32_t)g->board.ladders[i].start);
+        Wr32(p + i * LINK_LEN + 4, (uint32_t)g->board.ladders[i].end);
+    }
+
+    p = AddSection(&w, SAVE_SEC_GEOM, GEOM_LEN);
+    Wr32(p, (uint32_t)g->board.width);
+    Wr32(p + 4, (uint32_t)g->board.height);
+
+    for (uint32_t i = 0; i < w.count; i++) SealSection(&w, i);
+    Wr32(buf, SAVE_MAGIC);
+    Wr16(buf + 4, SAVE_VERSION);
+    Wr16(buf + 6, SAVE_HEADER_LEN);
+    Wr32(buf + 8, w.len);
+    Wr32(buf + 12, w.count);
+    Wr32(buf + 16, SAVE_HEADER_LEN);
+    Wr32(buf + 24, Crc32(Crc32(0, buf, 24), w.table, (size_t)w.count * SAVE_ENTRY_LEN));
+    return w.len;
+}
+
+int SaveWrite(const char* path, const SaveState* s)
+{
+    uint8_t buf[SAVE_MAX_LEN];
+    uint32_t len = SaveEncode(s, buf);
+
+    char tmp[300];
+    if (snprintf(tmp, sizeof(tmp), "%s.tmp", path) >= (int)sizeof(tmp)) {
+        return 0;
+    }
+    FILE* fp = fopen(tmp, "wb");
+    if (!fp) {
+        return 0;
+    }
+    int ok = fwrite(buf, 1, len, fp) == len;
+    ok = (fclose(fp) == 0) && ok;
+    if (!ok || !SysReplaceFile(tmp, path)) {
+        remove(tmp);
+        return 0;
+    }
+    return 1;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <stddef.h>
+#include "game.h"
+
+//save files. v2 is fixed layout little endian so a mapped file can be checked and read
+//in place on any compiler:
+//
+//  header  32 bytes  magic "SLSV", u16 version, u16 header size, u32 file size,
+//                    u32 section count, u32 table offset, u32 crc of header + table, u32 0
+//  table   16 bytes per section  u32 id, u32 offset, u32 size, u32 crc of the payload
+//  payloads 4 byte aligned, sections with ids we don't know are skipped
+//
+//v1 files (raw ints and a 44 byte msvc struct per player) are still read and migrated
+
+#define SAVE_MAGIC      0x56534C53u //"SLSV"
+#define SAVE_VERSION    2
+#define SAVE_HEADER_LEN 32
+#define SAVE_ENTRY_LEN  16
+#define SAVE_NAME_LEN   32
+
+#define SAVE_ID(a, b, c, d) ((uint32_t)(a) | (uint32_t)(b) << 8 | (uint32_t)(c) << 16 | (uint32_t)(d) << 24)
+#define SAVE_SEC_GAME   SAVE_ID('G', 'A', 'M', 'E') //rules state, 68 bytes
+#define SAVE_SEC_TURN   SAVE_ID('T', 'U', 'R', 'N') //dice and walk of the turn in progress, 28 bytes
+#define SAVE_SEC_PLAYER SAVE_ID('P', 'L', 'Y', 'R') //40 bytes per seat
+#define SAVE_SEC_SNAKE  SAVE_ID('S', 'N', 'A', 'K') //8 bytes per snake, placement order
+#define SAVE_SEC_LADDER SAVE_ID('L', 'A', 'D', 'R') //8 bytes per ladder
+#define SAVE_SEC_GEOM   SAVE_ID('G', 'E', 'O', 'M') //board width and height, 8 bytes. 10x10 when missing
+#define SAVE_SECTIONS   6
+#define SAVE_MAX_LEN    (SAVE_HEADER_LEN + SAVE_SECTIONS * SAVE_ENTRY_LEN + 68 + 28 + \
+                         MAX_PLAYERS * 40 + (MAX_SNAKES + MAX_LADDERS) * 8 + 8)
+
+//where in a turn the save was made
+typedef enum {
+    SAVE_PHASE_TURN,   //waiting for a roll
+    SAVE_PHASE_ROLLED, //dice rolled but not thrown
+    SAVE_PHASE_MOVING  //token part way through its walk
+} SavePhase;
+
+typedef struct {
+    char name[SAVE_NAME_LEN];
+    uint8_t color[4]; //rgba
+    int playerNumber;
+} SavePlayerInfo;
+
+typedef struct {
+    Game game;
+    SavePlayerInfo players[MAX_PLAYERS];
+    SavePhase phase;
+    int dieA, dieB, diceTotal;
+    TokenWalk walk;
+    int version; //what the file was, 1 means it came through the migration
+} SaveState;
+
+uint32_t Crc32(uint32_t crc, const void* data, size_t len); //start with crc 0
+
+//writes to path.tmp and renames it over path, so a failed save never eats the old file
+int SaveWrite(const char* path, const SaveState* s);
+
+//maps the file and decodes it. out is only written when everything checks out
+int SaveRead(const char* path, SaveState* out);
+
+//the pieces SaveWrite and SaveRead are made of, for callers that keep saves inside other files
+uint32_t SaveEncode(const SaveState* s, uint8_t* buf); //buf holds SAVE_MAX_LEN, returns the length
+int SaveCheck(const uint8_t* data, size_t size); //v2 header, table and every crc, no copies
+const uint8_t* SaveSection(const uint8_t* data, size_t size, uint32_t id, uint32_t* len); //only after SaveCheck
+int SaveDecode(const uint8_t* data, size_t size, SaveState* out); //v2 or v1
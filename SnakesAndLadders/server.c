@@ -0,0 +1,495 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include "server.h"
+#include "io.h"
+#include "net.h"
+#include "save.h"
+#include "sys.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SESSION_BITS 20 //slot in the low bits of an id, a reuse count above
+#define CONN_IN      4096
+#define CONN_OUT_MAX (256 * 1024) //replies queued before a connection stops being read until they drain
+#define POLL_BATCH   256
+
+static uint32_t Rd16(const uint8_t* p) { return (uint32_t)p[0] | (uint32_t)p[1] << 8; }
+static uint32_t Rd32(const uint8_t* p) { return Rd16(p) | Rd16(p + 2) << 16; }
+static uint64_t Rd64(const uint8_t* p) { return (uint64_t)Rd32(p) | (uint64_t)Rd32(p + 4) << 32; }
+static void Wr16(uint8_t* p, uint32_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+static void Wr32(uint8_t* p, uint32_t v) { Wr16(p, v); Wr16(p + 2, v >> 16); }
+static void Wr64(uint8_t* p, uint64_t v) { Wr32(p, (uint32_t)v); Wr32(p + 4, (uint32_t)(v >> 32)); }
+
+typedef struct {
+    SaveState s;     //players, board and turn, what a save of this game would hold
+    uint32_t id;
+    int owner;       //connection slot, its sessions end with it
+    uint32_t ownerGen;
+} Session;
+
+typedef struct {
+    NetSocket sock;
+    int slot;
+    uint32_t gen;
+    int inLen;
+    uint8_t in[CONN_IN];
+    uint8_t* out;
+    int outLen, outCap;
+    int watching; //what the poller has for it
+} Conn;
+
+//a save on the io worker, answered once it's on disk if the connection is still there
+typedef struct {
+    int conn;
+    uint32_t gen;
+    uint32_t tag;
+    uint32_t session;
+} PendingSave;
+
+static Session** sessions; //slots, NULL when free
+static uint32_t* sessionGen;
+static int sessionCap, sessionLive, sessionScan;
+static Conn** conns;
+static uint32_t* connGen;
+static int connCap;
+static NetPoller poller;
+static uint64_t commands;
+static int savesInFlight;
+static uint64_t seedCount;
+
+static Session* FindSession(uint32_t id, const Conn* c)
+{
+    uint32_t slot = id & ((1u << SESSION_BITS) - 1);
+    if (slot >= (uint32_t)sessionCap || !sessions[slot]) {
+        return NULL;
+    }
+    Session* s = sessions[slot];
+    return (s->id == id && s->owner == c->slot && s->ownerGen == c->gen) ? s : NULL;
+}
+
+static Session* NewSession(const Conn* c)
+{
+    if (sessionLive == sessionCap) {
+        return NULL;
+    }
+    while (sessions[sessionScan]) sessionScan = (sessionScan + 1) % sessionCap;
+    Session* s = (Session*)calloc(1, sizeof(Session));
+    if (!s) {
+        return NULL;
+    }
+    int slot = sessionScan;
+    sessionGen[slot] = (sessionGen[slot] + 1) & ((1u << (32 - SESSION_BITS)) - 1);
+    if (!sessionGen[slot]) sessionGen[slot] = 1; //id 0 means no session
+    s->id = (uint32_t)slot | sessionGen[slot] << SESSION_BITS;
+    s->owner = c->slot;
+    s->ownerGen = c->gen;
+    sessions[slot] = s;
+    sessionLive++;
+    return s;
+}
+
+static void EndSession(Session* s)
+{
+    uint32_t slot = s->id & ((1u << SESSION_BITS) - 1);
+    sessions[slot] = NULL;
+    sessionLive--;
+    free(s);
+}
+
+static void Queue(Conn* c, const uint8_t* msg, int len)
+{
+    if (c->outLen + len > c->outCap) {
+        int cap = c->outCap ? c->outCap * 2 : 1024;
+        while (cap < c->outLen + len) cap *= 2;
+        uint8_t* n = (uint8_t*)realloc(c->out, (size_t)cap);
+        if (!n) {
+            return; //the reply is lost, the client times out on it
+        }
+        c->out = n;
+        c->outCap = cap;
+    }
+    memcpy(c->out + c->outLen, msg, (size_t)len);
+    c->outLen += len;
+}
+
+//header plus status, body is filled in by the caller after it
+static uint8_t* BeginReply(uint8_t* msg, int op, uint32_t tag, uint32_t session, NetStatus status)
+{
+    msg[2] = (uint8_t)(op | NET_REPLY);
+    Wr32(msg + 3, tag);
+    Wr32(msg + 7, session);
+    msg[NET_HEADER_LEN] = (uint8_t)status;
+    return msg + NET_HEADER_LEN + 1;
+}
+
+static void EndReply(Conn* c, uint8_t* msg, const uint8_t* end)
+{
+    int len = (int)(end - msg);
+    Wr16(msg, (uint32_t)(len - 2));
+    Queue(c, msg, len);
+}
+
+//a client that sends and never reads gets no more reads until its replies go out, so what
+//it has queued stays under about CONN_OUT_MAX plus one batch of replies
+static void Watch(Conn* c)
+{
+    int want = (c->outLen < CONN_OUT_MAX ? NET_READ : 0) | (c->outLen ? NET_WRITE : 0);
+    if (want != c->watching) {
+        c->watching = want;
+        NetPollerSet(&poller, c->sock, want, c);
+    }
+}
+
+static void CloseConn(Conn* c)
+{
+    //its games go with it
+    for (int i = 0; i < sessionCap && sessionLive; i++) {
+        if (sessions[i] && sessions[i]->owner == c->slot && sessions[i]->ownerGen == c->gen) EndSession(sessions[i]);
+    }
+    NetPollerRemove(&poller, c->sock);
+    NetClose(c->sock);
+    conns[c->slot] = NULL;
+    free(c->out);
+    free(c);
+}
+
+static void OnSaved(IoJob* job)
+{
+    PendingSave* p = (PendingSave*)job->ctx;
+    savesInFlight--;
+    Conn* c = (p->conn < connCap) ? conns[p->conn] : NULL;
+    if (c && c->gen == p->gen) {
+        uint8_t msg[NET_MAX_MSG];
+        uint8_t* w = BeginReply(msg, NET_OP_SAVE, p->tag, p->session, job->ok ? NET_OK : NET_IO_FAILED);
+        EndReply(c, msg, w);
+        //written straight away, the loop only flushes connections it read from
+        int n = (c->watching & NET_WRITE) ? 0 : NetSend(c->sock, c->out, c->outLen);
+        if (n > 0) {
+            memmove(c->out, c->out + n, (size_t)(c->outLen - n));
+            c->outLen -= n;
+        }
+        Watch(c);
+    }
+    free(p);
+}
+
+static void NewGame(Session* s, const uint8_t* p, uint64_t seed)
+{
+    int width = (int)Rd16(p + 4), height = (int)Rd16(p + 6);
+    GameInit(&s->s.game, p[0], p[1], (Mode)p[2], seed);
+    BoardInit(&s->s.game.board, width ? width : BOARD_SIZE, height ? height : BOARD_SIZE);
+    for (int i = 0; i < s->s.game.playerCount; i++) {
+        Rng rng = RngAt(seed, (uint64_t)i, RNG_COLOR); //same colors the window would pick
+        s->s.players[i].color[0] = (uint8_t)RngRange(&rng, 50, 255);
+        s->s.players[i].color[1] = (uint8_t)RngRange(&rng, 50, 255);
+        s->s.players[i].color[2] = (uint8_t)RngRange(&rng, 50, 255);
+        s->s.players[i].color[3] = 255;
+        snprintf(s->s.players[i].name, SAVE_NAME_LEN, "Player %d", i + 1);
+        s->s.players[i].playerNumber = i + 1;
+    }
+    s->s.phase = SAVE_PHASE_TURN;
+}
+
+static bool GoodName(const uint8_t* name, int len)
+{
+    if (len < 1 || len >= SAVE_NAME_LEN) {
+        return false;
+    }
+    for (int i = 0; i < len; i++) {
+        uint8_t ch = name[i];
+        bool ok = (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9') || ch == '_' || ch == '-';
+        if (!ok) return false;
+    }
+    return true;
+}
+
+//one request, the reply (if it isn't a save still on its way) is queued on the connection
+static void Handle(Conn* c, const uint8_t* m, int len)
+{
+    int op = m[2];
+    uint32_t tag = Rd32(m + 3), id = Rd32(m + 7);
+    const uint8_t* p = m + NET_HEADER_LEN;
+    int body = len - NET_HEADER_LEN;
+    uint8_t msg[NET_MAX_MSG];
+    uint8_t* w;
+    commands++;
+
+    if (op == NET_OP_NEW) {
+        bool ok = body >= 16 && p[0] >= 2 && p[0] <= MAX_PLAYERS && p[1] >= 1 && p[1] <= 2 && p[2] <= MODE_CHAOS;
+        int width = ok ? (int)Rd16(p + 4) : 0, height = ok ? (int)Rd16(p + 6) : 0;
+        if (ok && (width || height)) {
+            ok = width >= BOARD_MIN_SIDE && width <= BOARD_MAX_SIDE && height >= BOARD_MIN_SIDE && height <= BOARD_MAX_SIDE;
+        }
+        Session* s = ok ? NewSession(c) : NULL;
+        if (s) {
+            uint64_t seed = Rd64(p + 8);
+            NewGame(s, p, seed ? seed : GameSeed((uint64_t)time(NULL), seedCount++));
+        }
+        w = BeginReply(msg, op, tag, s ? s->id : 0, !ok ? NET_BAD_ARG : (s ? NET_OK : NET_FULL));
+        EndReply(c, msg, w);
+        return;
+    }
+    if (op == NET_OP_STATS) {
+        w = BeginReply(msg, op, tag, 0, NET_OK);
+        Wr32(w, (uint32_t)sessionLive);
+        Wr64(w + 4, commands);
+        Wr64(w + 12, (uint64_t)(SysCpuTime() * 1e6));
+        EndReply(c, msg, w + 20);
+        return;
+    }
+
+    Session* s = FindSession(id, c);
+    if (!s) {
+        w = BeginReply(msg, op, tag, id, (op >= NET_OP_ROLL && op <= NET_OP_END) ? NET_BAD_SESSION : NET_BAD_OP);
+        EndReply(c, msg, w);
+        return;
+    }
+    Game* g = &s->s.game;
+
+    switch (op) {
+    case NET_OP_ROLL:
+        if (s->s.phase != SAVE_PHASE_TURN || g->winner >= 0) {
+            w = BeginReply(msg, op, tag, id, NET_BAD_STATE);
+            break;
+        }
+        s->s.diceTotal = RollDice(g, &s->s.dieA, &s->s.dieB);
+        s->s.phase = SAVE_PHASE_ROLLED;
+        w = BeginReply(msg, op, tag, id, NET_OK);
+        *w++ = (uint8_t)s->s.dieA;
+        *w++ = (uint8_t)s->s.dieB;
+        break;
+
+    case NET_OP_THROW: {
+        if (s->s.phase != SAVE_PHASE_ROLLED) {
+            w = BeginReply(msg, op, tag, id, NET_BAD_STATE);
+            break;
+        }
+        int seat = g->currentPlayer;
+        MoveInfo mv = GameMove(g, s->s.diceTotal);
+        s->s.phase = SAVE_PHASE_TURN;
+        w = BeginReply(msg, op, tag, id, NET_OK);
+        Wr32(w, (uint32_t)mv.landed);
+        Wr32(w + 4, (uint32_t)mv.to);
+        w[8] = (uint8_t)seat;
+        w[9] = (uint8_t)(g->winner >= 0 ? g->winner : 0xFF);
+        Wr32(w + 10, (uint32_t)g->globalTurn);
+        w += 14;
+    } break;
+
+    case NET_OP_PLACE: {
+        if (body < 4 || s->s.phase != SAVE_PHASE_TURN || g->winner >= 0 || g->mode != MODE_CHAOS || !g->canPlace[g->currentPlayer]) {
+            w = BeginReply(msg, op, tag, id, body < 4 ? NET_BAD_ARG : NET_BAD_STATE);
+            break;
+        }
+        uint32_t head = Rd32(p);
+        PlaceResult r = head < (uint32_t)g->board.tiles ? GamePlaceSnake(g, (int)head) : PLACE_BAD_TILE;
+        w = BeginReply(msg, op, tag, id, r == PLACE_OK ? NET_OK : (r == PLACE_LIMIT ? NET_BAD_STATE : NET_BAD_ARG));
+        Wr32(w, r == PLACE_OK ? (uint32_t)g->board.snakes[g->board.snakeCount - 1].end : 0);
+        w += 4;
+    } break;
+
+    case NET_OP_SAVE: {
+        int n = body >= 1 ? p[0] : 0;
+        PendingSave* pend = NULL;
+        IoJob* job = NULL;
+        if (body < 1 + n || !GoodName(p + 1, n)) {
+            w = BeginReply(msg, op, tag, id, NET_BAD_ARG);
+            break;
+        }
+        pend = (PendingSave*)malloc(sizeof(PendingSave));
+        job = pend ? IoNew(IO_SAVE, OnSaved) : NULL;
+        if (!job) {
+            free(pend);
+            w = BeginReply(msg, op, tag, id, NET_IO_FAILED);
+            break;
+        }
+        *pend = (PendingSave){ c->slot, c->gen, tag, id };
+        snprintf(job->file, sizeof(job->file), "%.*s.sav", n, (const char*)(p + 1));
+        job->state = s->s;
+        job->ctx = pend;
+        savesInFlight++;
+        IoSubmit(job); //answered from OnSaved
+        return;
+    }
+
+    case NET_OP_END:
+        EndSession(s);
+        w = BeginReply(msg, op, tag, id, NET_OK);
+        break;
+
+    default:
+        w = BeginReply(msg, op, tag, id, NET_BAD_OP);
+        break;
+    }
+    EndReply(c, msg, w);
+}
+
+static bool Process(Conn* c);
+
+static void Flush(Conn* c)
+{
+    int sent = 0;
+    while (sent < c->outLen) {
+        int n = NetSend(c->sock, c->out + sent, c->outLen - sent);
+        if (n == NET_AGAIN) break;
+        if (n < 0) {
+            CloseConn(c);
+            return;
+        }
+        sent += n;
+    }
+    memmove(c->out, c->out + sent, (size_t)(c->outLen - sent));
+    c->outLen -= sent;
+    //requests left unhandled while the replies were backed up go now
+    if (c->inLen && c->outLen < CONN_OUT_MAX && !Process(c)) {
+        return;
+    }
+    Watch(c);
+}
+
+//handles whole requests in the input until it runs out or the replies back up. false once
+//the connection is gone
+static bool Process(Conn* c)
+{
+    int at = 0;
+    while (c->inLen - at >= 2 && c->outLen < CONN_OUT_MAX) {
+        int len = 2 + (int)Rd16(c->in + at);
+        if (len < NET_HEADER_LEN || len > NET_MAX_MSG) {
+            CloseConn(c); //not speaking the protocol
+            return false;
+        }
+        if (c->inLen - at < len) break;
+        Handle(c, c->in + at, len);
+        at += len;
+    }
+    memmove(c->in, c->in + at, (size_t)(c->inLen - at));
+    c->inLen -= at;
+    return true;
+}
+
+//false once the connection is gone
+static bool Read(Conn* c)
+{
+    while (c->outLen < CONN_OUT_MAX) {
+        int n = NetRecv(c->sock, c->in + c->inLen, CONN_IN - c->inLen);
+        if (n == NET_AGAIN) {
+            return true;
+        }
+        if (n <= 0) {
+            CloseConn(c);
+            return false;
+        }
+        c->inLen += n;
+        if (!Process(c)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void Accept(NetSocket listener)
+{
+    for (;;) {
+        NetSocket s = NetAccept(listener);
+        if (s == NET_NONE) {
+            return;
+        }
+        int slot = 0;
+        while (slot < connCap && conns[slot]) slot++;
+        if (slot == connCap) {
+            int cap = connCap ? connCap * 2 : 64;
+            Conn** grown = (Conn**)realloc(conns, (size_t)cap * sizeof(Conn*));
+            if (grown) conns = grown;
+            uint32_t* gens = grown ? (uint32_t*)realloc(connGen, (size_t)cap * sizeof(uint32_t)) : NULL;
+            if (gens) connGen = gens;
+            if (!grown || !gens) {
+                NetClose(s);
+                continue;
+            }
+            memset(conns + connCap, 0, (size_t)(cap - connCap) * sizeof(Conn*));
+            memset(connGen + connCap, 0, (size_t)(cap - connCap) * sizeof(uint32_t));
+            connCap = cap;
+        }
+        Conn* c = (Conn*)calloc(1, sizeof(Conn));
+        if (!c || !NetPollerSet(&poller, s, NET_READ, c)) {
+            free(c);
+            NetClose(s);
+            continue;
+        }
+        c->sock = s;
+        c->watching = NET_READ;
+        c->slot = slot;
+        c->gen = ++connGen[slot];
+        conns[slot] = c;
+    }
+}
+
+int RunServer(const ServerConfig* cfg)
+{
+    if (!NetInit()) {
+        return 0;
+    }
+    sessionCap = cfg->maxSessions;
+    if (sessionCap < 1 || sessionCap > (1 << SESSION_BITS)) {
+        fprintf(stderr, "sessions must be 1 to %d\n", 1 << SESSION_BITS);
+        return 0;
+    }
+    sessions = (Session**)calloc((size_t)sessionCap, sizeof(Session*));
+    sessionGen = (uint32_t*)calloc((size_t)sessionCap, sizeof(uint32_t));
+    NetSocket listener = NetListen(cfg->addr);
+    if (!sessions || !sessionGen || listener == NET_NONE || !NetPollerInit(&poller)) {
+        fprintf(stderr, "can't listen on %s\n", cfg->addr);
+        free(sessions);
+        free(sessionGen);
+        if (listener != NET_NONE) NetClose(listener);
+        return 0;
+    }
+    NetPollerSet(&poller, listener, NET_READ, NULL);
+    IoStart(cfg->dir);
+    printf("serving on %s, up to %d sessions\n", cfg->addr, sessionCap);
+    fflush(stdout);
+
+    double start = SysNow();
+    NetEvent ev[POLL_BATCH];
+    for (;;) {
+        int wait = savesInFlight ? 5 : 100; //io callbacks only come through IoPoll
+        if (cfg->seconds > 0) {
+            double left = cfg->seconds - (SysNow() - start);
+            if (left <= 0) break;
+            if (left * 1000 < wait) wait = (int)(left * 1000) + 1;
+        }
+        int n = NetPollerWait(&poller, ev, POLL_BATCH, wait);
+        if (n < 0) {
+            break;
+        }
+        for (int i = 0; i < n; i++) {
+            Conn* c = (Conn*)ev[i].ctx;
+            if (!c) {
+                Accept(listener);
+                continue;
+            }
+            if ((ev[i].events & NET_READ) && !Read(c)) {
+                continue;
+            }
+            if (c->outLen) Flush(c); //replies to what was just read, or what didn't fit before
+        }
+        IoPoll();
+    }
+
+    double took = SysNow() - start;
+    printf("served %llu commands in %.1f s, %.2f s cpu, %d sessions live\n",
+        (unsigned long long)commands, took, SysCpuTime(), sessionLive);
+    while (savesInFlight) IoPoll(); //the last saves still get their replies
+    IoStop();
+    for (int i = 0; i < connCap; i++) {
+        if (conns[i]) CloseConn(conns[i]);
+    }
+    NetClose(listener);
+    NetPollerFree(&poller);
+    free(sessions);
+    free(sessionGen);
+    free(conns);
+    free(connGen);
+    return 1;
+}
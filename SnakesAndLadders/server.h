@@ -0,0 +1,78 @@
+#pragma once
+#include <stdint.h>
+#include "game.h"
+
+//many games served from one process. one thread runs an event loop over every connection,
+//each session is a game of its own (players, board, turn) kept the way a save keeps it.
+//
+//every message is a u16 length of what follows, then u8 op, u32 tag and u32 session, little
+//endian. the tag is the client's own and comes back on the reply, the session is 0 for NEW
+//and STATS. requests carry after the header:
+//  NEW    u8 players, u8 dice, u8 mode, u8 0, u16 width, u16 height, u64 seed (0: server picks)
+//  ROLL   -
+//  THROW  -                   moves the rolled dice in one go
+//  PLACE  u32 head            chaos snake, only at the start of a turn that has the right
+//  SAVE   u8 length, name     [A-Za-z0-9_-] only, written as <name>.sav in the server folder
+//  END    -
+//  STATS  -
+//replies have op | NET_REPLY, the same tag and session (the new one for NEW), u8 status and:
+//  ROLL   u8 dieA, u8 dieB
+//  THROW  u32 landed, u32 to, u8 seat that moved, u8 winner (0xFF none), u32 global turn
+//  PLACE  u32 tail
+//  STATS  u32 live sessions, u64 commands, u64 server cpu microseconds
+
+#define NET_HEADER_LEN  11
+#define NET_MAX_MSG     128
+#define NET_REPLY       0x80
+
+typedef enum {
+    NET_OP_NEW = 1,
+    NET_OP_ROLL,
+    NET_OP_THROW,
+    NET_OP_PLACE,
+    NET_OP_SAVE,
+    NET_OP_END,
+    NET_OP_STATS
+} NetOp;
+
+typedef enum {
+    NET_OK,
+    NET_BAD_SESSION, //unknown, ended, or another connection's
+    NET_BAD_STATE,   //not allowed at this point of the turn
+    NET_BAD_ARG,
+    NET_FULL,        //no session slots left
+    NET_IO_FAILED,
+    NET_BAD_OP
+} NetStatus;
+
+typedef struct {
+    const char* addr;
+    const char* dir;  //where SAVE writes
+    int maxSessions;
+    double seconds;   //stop after this long, 0 runs until killed
+} ServerConfig;
+
+int RunServer(const ServerConfig* cfg);
+
+//load generator: connections threads, each driving sessions games pipelined over its socket
+typedef struct {
+    const char* addr;
+    int connections;
+    int sessions; //per connection
+    double seconds;
+} LoadConfig;
+
+#define LOAD_BUCKETS 100000 //1 us each, the last also takes anything slower
+
+typedef struct {
+    uint64_t commands;
+    uint64_t games;
+    uint64_t errors;
+    uint64_t latency[LOAD_BUCKETS];
+    double seconds;
+    double serverCpu; //seconds the server spent during the run
+    int sessions;
+} LoadSummary;
+
+int    RunLoad(const LoadConfig* cfg, LoadSummary* out); //out is large, keep it off the stack
+double LoadPercentile(const LoadSummary* s, double pct); //microseconds
@@ -0,0 +1,236 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include "sim.h"
+#include "rules.h"
+#include "simd.h"
+#include "sys.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define SIM_CHUNK 1024 //games handed out at a time
+
+//each worker owns a run of chunks packed as next | end << 32 so one CAS moves either end.
+//the owner takes from the front, an idle worker steals the back half of someone else's
+typedef struct {
+    volatile int64_t range;
+    char pad[64 - sizeof(int64_t)];
+} WorkQueue;
+
+typedef struct {
+    int id;
+    int threads;
+    const SimConfig* cfg;
+    uint64_t games;
+    uint64_t seed;
+    WorkQueue* queues;
+    SimSummary* sum;
+    Stats* stats;        //this worker's shard, NULL when not counting
+    SimStats* live;      //worker 0 dumps
+    StatsShard* shards;  //everyone's, for the dumps
+    TrajWriter* writer;  //NULL when not recording
+    TrajBuf* traj;       //this worker's chunk
+    double start;
+    double nextDump;
+} Worker;
+
+static int64_t Pack(uint32_t next, uint32_t end)
+{
+    return (int64_t)((uint64_t)next | (uint64_t)end << 32);
+}
+
+static int TakeOwn(WorkQueue* q, uint32_t* chunk)
+{
+    for (;;) {
+        int64_t r = SysLoad64(&q->range);
+        uint32_t next = (uint32_t)r, end = (uint32_t)((uint64_t)r >> 32);
+        if (next >= end) {
+            return 0;
+        }
+        if (SysCas64(&q->range, r, Pack(next + 1, end))) {
+            *chunk = next;
+            return 1;
+        }
+    }
+}
+
+static int Steal(WorkQueue* victim, WorkQueue* mine)
+{
+    for (;;) {
+        int64_t r = SysLoad64(&victim->range);
+        uint32_t next = (uint32_t)r, end = (uint32_t)((uint64_t)r >> 32);
+        if (next >= end) {
+            return 0;
+        }
+        uint32_t mid = end - (end - next + 1) / 2;
+        if (SysCas64(&victim->range, r, Pack(next, mid))) {
+            SysStore64(&mine->range, Pack(mid, end));
+            return 1;
+        }
+    }
+}
+
+void SimRecordGame(SimSummary* s, const GameResult* r)
+{
+    s->games++;
+    s->turns += (uint64_t)r->turns;
+    s->snakeHits += (uint64_t)r->snakeHits;
+    s->ladderHits += (uint64_t)r->ladderHits;
+    s->bounces += (uint64_t)r->bounces;
+    s->snakesPlaced += (uint64_t)r->snakesPlaced;
+    if (r->winner >= 0) s->wins[r->winner]++;
+    else s->unfinished++;
+    s->turnHist[r->turns < SIM_TURN_BUCKETS ? r->turns : SIM_TURN_BUCKETS - 1]++;
+}
+
+//between two chunks of worker 0, the other workers keep playing through it
+static void Dump(Worker* w)
+{
+    double now = SysNow();
+    if (now < w->nextDump) {
+        return;
+    }
+    w->nextDump = now + w->live->every;
+    Stats sofar;
+    StatsMerge(w->shards, w->threads, &sofar);
+    w->live->dump(&sofar, now - w->start, w->live->ctx);
+}
+
+static void WorkerMain(void* arg)
+{
+    Worker* w = (Worker*)arg;
+    WorkQueue* mine = &w->queues[w->id];
+
+    for (;;) {
+        uint32_t chunk;
+        while (TakeOwn(mine, &chunk)) {
+            uint64_t first = (uint64_t)chunk * SIM_CHUNK;
+            uint64_t last = first + SIM_CHUNK;
+            if (last > w->games) last = w->games;
+            if (w->stats) {
+                //the lanes count what the counting loop does, but a trajectory goes move by move
+                //in game order, so recording one keeps the whole batch on the scalar loop
+                if (w->writer) {
+                    TrajBufBegin(w->traj, first);
+                    RulesRange(w->cfg, w->seed, first, last, w->sum, w->stats, w->traj);
+                    TrajFlush(w->writer, w->traj); //a failure stays on the writer
+                }
+                else if (w->cfg->mode == MODE_CLASSIC && !w->cfg->rules) {
+                    SimdClassicRange(w->cfg, w->seed, first, last, w->sum, w->stats);
+                }
+                else {
+                    RulesRange(w->cfg, w->seed, first, last, w->sum, w->stats, NULL);
+                }
+                if (w->live && w->live->every > 0 && w->live->dump) Dump(w);
+                continue;
+            }
+            if (w->cfg->rules) {
+                RulesRange(w->cfg, w->seed, first, last, w->sum, NULL, NULL);
+                continue;
+            }
+            if (w->cfg->mode == MODE_CLASSIC) {
+                SimdClassicRange(w->cfg, w->seed, first, last, w->sum, NULL);
+                continue;
+            }
+            for (uint64_t i = first; i < last; i++) {
+                GameResult r;
+                SimulateGame(w->cfg, GameSeed(w->seed, i), &r);
+                SimRecordGame(w->sum, &r);
+            }
+        }
+
+        int stole = 0;
+        for (int k = 1; k < w->threads && !stole; k++) {
+            stole = Steal(&w->queues[(w->id + k) % w->threads], mine);
+        }
+        if (!stole) {
+            return; //nothing is ever added, so everyone empty means done
+        }
+    }
+}
+
+void SimSummaryAdd(SimSummary* into, const SimSummary* from)
+{
+    into->games += from->games;
+    into->unfinished += from->unfinished;
+    into->turns += from->turns;
+    into->snakeHits += from->snakeHits;
+    into->ladderHits += from->ladderHits;
+    into->bounces += from->bounces;
+    into->snakesPlaced += from->snakesPlaced;
+    for (int p = 0; p < MAX_PLAYERS; p++) into->wins[p] += from->wins[p];
+    for (int b = 0; b < SIM_TURN_BUCKETS; b++) into->turnHist[b] += from->turnHist[b];
+}
+
+int SimTurnPercentile(const SimSummary* s, double pct)
+{
+    uint64_t want = (uint64_t)(s->games * pct / 100.0);
+    uint64_t seen = 0;
+    for (int b = 0; b < SIM_TURN_BUCKETS; b++) {
+        seen += s->turnHist[b];
+        if (seen > want) return b;
+    }
+    return SIM_TURN_BUCKETS - 1;
+}
+
+int RunSimulation(const SimConfig* cfg, uint64_t games, uint64_t seed, int threads, SimSummary* out)
+{
+    return RunSimulationStats(cfg, games, seed, threads, NULL, out);
+}
+
+int RunSimulationStats(const SimConfig* cfg, uint64_t games, uint64_t seed, int threads, SimStats* stats, SimSummary* out)
+{
+    memset(out, 0, sizeof(*out));
+    uint64_t chunks = (games + SIM_CHUNK - 1) / SIM_CHUNK;
+    if (chunks > 0xFFFFFFFFull) {
+        return 0;
+    }
+    if (threads <= 0) threads = SysCpuCount();
+    if (threads > SIM_MAX_THREADS) threads = SIM_MAX_THREADS;
+    if ((uint64_t)threads > chunks) threads = chunks ? (int)chunks : 1;
+
+    WorkQueue* queues = (WorkQueue*)calloc((size_t)threads, sizeof(WorkQueue));
+    SimSummary* sums = (SimSummary*)calloc((size_t)threads, sizeof(SimSummary));
+    Worker* workers = (Worker*)calloc((size_t)threads, sizeof(Worker));
+    SysThread* handles = (SysThread*)calloc((size_t)threads, sizeof(SysThread));
+    StatsShard* shards = stats ? (StatsShard*)calloc((size_t)threads, sizeof(StatsShard)) : NULL;
+    TrajWriter* writer = stats ? stats->traj : NULL;
+    TrajBuf* bufs = writer ? (TrajBuf*)calloc((size_t)threads, sizeof(TrajBuf)) : NULL;
+    if (!queues || !sums || !workers || !handles || (stats && !shards) || (writer && !bufs)) {
+        free(queues); free(sums); free(workers); free(handles); free(shards); free(bufs);
+        return 0;
+    }
+
+    //even split up front, stealing only evens out the tail
+    for (int t = 0; t < threads; t++) {
+        uint32_t a = (uint32_t)(chunks * t / threads);
+        uint32_t b = (uint32_t)(chunks * (t + 1) / threads);
+        queues[t].range = Pack(a, b);
+        workers[t] = (Worker){ t, threads, cfg, games, seed, queues, &sums[t], shards ? &shards[t].s : NULL, NULL, shards,
+                               writer, bufs ? &bufs[t] : NULL, 0.0, 0.0 };
+    }
+
+    double t0 = SysNow();
+    workers[0].live = stats;
+    workers[0].start = t0;
+    workers[0].nextDump = stats ? t0 + stats->every : 0.0;
+    int started = 1;
+    for (int t = 1; t < threads; t++) {
+        if (!SysThreadStart(&handles[t], WorkerMain, &workers[t])) break;
+        started++;
+    }
+    WorkerMain(&workers[0]); //also steals anything a thread that failed to start left behind
+    for (int t = 1; t < started; t++) {
+        SysThreadJoin(&handles[t]);
+    }
+    out->seconds = SysNow() - t0;
+
+    //each worker only ever touched its own summary, merging after the joins needs no locks
+    for (int t = 0; t < threads; t++) {
+        SimSummaryAdd(out, &sums[t]);
+    }
+    out->threads = started;
+    if (stats) StatsMerge(shards, threads, &stats->total);
+    for (int t = 0; bufs && t < threads; t++) TrajBufFree(&bufs[t]);
+
+    free(queues); free(sums); free(workers); free(handles); free(shards); free(bufs);
+    return 1;
+}
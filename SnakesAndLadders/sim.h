@@ -0,0 +1,45 @@
+#pragma once
+#include "game.h"
+#include "stats.h"
+#include "traj.h"
+
+//batches of headless games spread over every core
+
+#define SIM_TURN_BUCKETS 512 //turn histogram, the last bucket also takes longer games
+#define SIM_MAX_THREADS  256
+
+typedef struct {
+    uint64_t games;
+    uint64_t unfinished;
+    uint64_t turns;
+    uint64_t snakeHits;
+    uint64_t ladderHits;
+    uint64_t bounces;
+    uint64_t snakesPlaced;
+    uint64_t wins[MAX_PLAYERS];
+    uint64_t turnHist[SIM_TURN_BUCKETS];
+    double seconds;
+    int threads;
+} SimSummary;
+
+typedef void (*SimDumpFn)(const Stats* sofar, double seconds, void* ctx);
+
+//per roll and per tile counts on top of the summary. each worker counts into its own shard,
+//the calling thread merges them every so often for dump while the others play on
+typedef struct {
+    double every;  //seconds between dumps, 0 for none
+    SimDumpFn dump;
+    void* ctx;
+    TrajWriter* traj; //every move of every game goes here too when set, a chunk at a time
+    Stats total;   //every shard, merged once the batch is done
+} SimStats;
+
+//game i of the batch always plays from GameSeed(seed, i), so the totals don't depend on threads.
+//threads <= 0 uses one per core
+int  RunSimulation(const SimConfig* cfg, uint64_t games, uint64_t seed, int threads, SimSummary* out);
+//stats NULL is RunSimulation. with it classic games still take the vector lanes, which count
+//as they go, and the rest take the counting loop. a trajectory file puts every game on that loop
+int  RunSimulationStats(const SimConfig* cfg, uint64_t games, uint64_t seed, int threads, SimStats* stats, SimSummary* out);
+void SimSummaryAdd(SimSummary* into, const SimSummary* from);
+void SimRecordGame(SimSummary* s, const GameResult* r);
+int  SimTurnPercentile(const SimSummary* s, double pct);
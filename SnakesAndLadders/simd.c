@@ -0,0 +1,74 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include "simd.h"
+#include "rules.h"
+#include "sys.h"
+
+static volatile int64_t widest; //0 until the cpu is asked
+static volatile int64_t cap = 16;
+
+static int Widest(void)
+{
+#if defined(SIMD_X86) && defined(_MSC_VER)
+    int r[4];
+    __cpuid(r, 0);
+    int top = r[0];
+    __cpuid(r, 1);
+    if (top < 7 || !(r[2] & (1 << 27))) {
+        return 1; //no leaf 7, or no osxsave and xgetbv would fault
+    }
+    unsigned long long xcr0 = _xgetbv(0);
+    __cpuidex(r, 7, 0);
+    if ((xcr0 & 0xE6) == 0xE6 && (r[1] & (1 << 16))) return 16; //the os saves zmm and the mask registers
+    if ((xcr0 & 0x06) == 0x06 && (r[1] & (1 << 5))) return 8;
+    return 1;
+#elif defined(SIMD_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return 16;
+    if (__builtin_cpu_supports("avx2")) return 8;
+    return 1;
+#else
+    return 1;
+#endif
+}
+
+int SimdLanes(void)
+{
+    int64_t w = SysLoad64(&widest);
+    if (!w) {
+        w = Widest();
+        SysStore64(&widest, w); //every thread that gets here stores the same
+    }
+    int64_t c = SysLoad64(&cap);
+    if (w > c) w = c >= 16 ? 16 : c >= 8 ? 8 : 1;
+    return (int)w;
+}
+
+int SimdLimit(int lanes)
+{
+    SysStore64(&cap, lanes < 1 ? 1 : lanes);
+    return SimdLanes();
+}
+
+void SimdClassicRange(const SimConfig* cfg, uint64_t batchSeed, uint64_t first, uint64_t last, SimSummary* sum, Stats* st)
+{
+#if defined(SIMD_X86)
+    int lanes = SimdLanes();
+    if (lanes == 16) {
+        SimdClassicAvx512(cfg, batchSeed, first, last, sum, st);
+        return;
+    }
+    if (lanes == 8) {
+        SimdClassicAvx2(cfg, batchSeed, first, last, sum, st);
+        return;
+    }
+#endif
+    if (st) {
+        RulesRange(cfg, batchSeed, first, last, sum, st, NULL);
+        return;
+    }
+    for (uint64_t i = first; i < last; i++) {
+        GameResult r;
+        SimulateGame(cfg, GameSeed(batchSeed, i), &r);
+        SimRecordGame(sum, &r);
+    }
+}
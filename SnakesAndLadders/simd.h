@@ -0,0 +1,21 @@
+#pragma once
+#include "sim.h"
+
+//classic mode games played side by side in vector lanes, one game per lane.
+//each lane plays exactly what SimulateGame would for the same game seed, so the
+//totals match the scalar path bit for bit. the avx-512 and avx2 kernels are built
+//on any x86 compiler, the widest the cpu runs is picked on first use, otherwise
+//this is the scalar loop. st, when not NULL, gets the same counts RulesRange would add
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SIMD_X86
+#endif
+
+int  SimdLanes(void);
+//caps the lanes used, 1 for the scalar loop. returns the lanes now in use
+int  SimdLimit(int lanes);
+void SimdClassicRange(const SimConfig* cfg, uint64_t batchSeed, uint64_t first, uint64_t last, SimSummary* sum, Stats* st);
+
+//the kernels, only through SimdClassicRange: calling one on a cpu without it faults
+void SimdClassicAvx2(const SimConfig* cfg, uint64_t batchSeed, uint64_t first, uint64_t last, SimSummary* sum, Stats* st);
+void SimdClassicAvx512(const SimConfig* cfg, uint64_t batchSeed, uint64_t first, uint64_t last, SimSummary* sum, Stats* st);
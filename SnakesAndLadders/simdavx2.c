@@ -0,0 +1,49 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include "simd.h"
+#include <string.h>
+
+//the only file built with -mavx2 (/arch:AVX2 in the project). simd.c calls in here only
+//once cpuid says the machine has avx2
+#if defined(SIMD_X86)
+#include <immintrin.h>
+
+#define LANES 8
+typedef __m256i V;
+typedef __m256i M;
+
+#define VSet1(x)          _mm256_set1_epi32(x)
+#define VAdd(a, b)        _mm256_add_epi32(a, b)
+#define VSub(a, b)        _mm256_sub_epi32(a, b)
+#define VMin(a, b)        _mm256_min_epi32(a, b)
+#define VAnd(a, b)        _mm256_and_si256(a, b)
+#define VXor(a, b)        _mm256_xor_si256(a, b)
+#define VSrl(a, n)        _mm256_srli_epi32(a, n)
+#define VMullo(a, b)      _mm256_mullo_epi32(a, b)
+#define VGather(t, i)     _mm256_i32gather_epi32(t, i, 4)
+#define VStore(p, a)      _mm256_storeu_si256((__m256i*)(p), a)
+#define VBlend(a, b, m)   _mm256_blendv_epi8(a, b, m)
+#define VAddMasked(a, m)  _mm256_sub_epi32(a, m) //true lanes are -1
+#define VEq(a, b)         _mm256_cmpeq_epi32(a, b)
+#define VGt(a, b)         _mm256_cmpgt_epi32(a, b)
+#define MAnd(a, b)        _mm256_and_si256(a, b)
+#define MOr(a, b)         _mm256_or_si256(a, b)
+#define MAndNot(a, b)     _mm256_andnot_si256(a, b)
+#define MBits(m)          _mm256_movemask_ps(_mm256_castsi256_ps(m))
+
+static inline M MFromBits(int bits)
+{
+    V lane = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    return _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(bits), lane), lane);
+}
+
+static inline V VMulHi(V a, V b)
+{
+    V even = _mm256_srli_epi64(_mm256_mul_epu32(a, b), 32);
+    V odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+    return _mm256_blend_epi32(even, odd, 0xAA);
+}
+
+#define SIMD_KERNEL SimdClassicAvx2
+#include "simdlanes.h"
+
+#endif
@@ -0,0 +1,44 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include "simd.h"
+#include <string.h>
+
+//the only file built with -mavx512f (/arch:AVX512 in the project). simd.c calls in here only
+//once cpuid says the machine has avx-512
+#if defined(SIMD_X86)
+#include <immintrin.h>
+
+#define LANES 16
+typedef __m512i V;
+typedef __mmask16 M;
+
+#define VSet1(x)          _mm512_set1_epi32(x)
+#define VAdd(a, b)        _mm512_add_epi32(a, b)
+#define VSub(a, b)        _mm512_sub_epi32(a, b)
+#define VMin(a, b)        _mm512_min_epi32(a, b)
+#define VAnd(a, b)        _mm512_and_si512(a, b)
+#define VXor(a, b)        _mm512_xor_si512(a, b)
+#define VSrl(a, n)        _mm512_srli_epi32(a, n)
+#define VMullo(a, b)      _mm512_mullo_epi32(a, b)
+#define VGather(t, i)     _mm512_i32gather_epi32(i, t, 4)
+#define VStore(p, a)      _mm512_storeu_si512((void*)(p), a)
+#define VBlend(a, b, m)   _mm512_mask_blend_epi32(m, a, b)
+#define VAddMasked(a, m)  _mm512_mask_add_epi32(a, m, a, VSet1(1))
+#define VEq(a, b)         _mm512_cmpeq_epi32_mask(a, b)
+#define VGt(a, b)         _mm512_cmpgt_epi32_mask(a, b)
+#define MAnd(a, b)        ((M)((a) & (b)))
+#define MOr(a, b)         ((M)((a) | (b)))
+#define MAndNot(a, b)     ((M)(~(a) & (b)))
+#define MBits(m)          ((int)(m))
+#define MFromBits(b)      ((M)(b))
+
+static inline V VMulHi(V a, V b)
+{
+    V even = _mm512_srli_epi64(_mm512_mul_epu32(a, b), 32);
+    V odd = _mm512_mul_epu32(_mm512_srli_epi64(a, 32), _mm512_srli_epi64(b, 32));
+    return _mm512_mask_blend_epi32(0xAAAA, even, odd);
+}
+
+#define SIMD_KERNEL SimdClassicAvx512
+#include "simdlanes.h"
+
+#endif
@@ -0,0 +1,204 @@
+//the lane kernel, written once against the V and M wrappers. simdavx2.c and simdavx512.c each
+//define LANES, the wrappers and SIMD_KERNEL, then include this, so every function here is
+//built for the one instruction set that file is compiled for
+
+//lane state, positions are one vector per seat so picking the mover is a few blends
+typedef struct {
+    V pos[MAX_PLAYERS];
+    V cur;
+    V turn;
+    V k0, k1;
+    V snakeHits, ladderHits, bounces;
+    M active;
+} Lanes;
+
+static void LaneSet(int32_t* v, int lane, int32_t x, V* vec)
+{
+    VStore(v, *vec);
+    v[lane] = x;
+    memcpy(vec, v, sizeof(V));
+}
+
+//start game index in lane, returns 0 once the range is used up
+static int LaneRefill(Lanes* L, int lane, uint64_t* next, uint64_t last, uint64_t batchSeed)
+{
+    int32_t tmp[LANES];
+    if (*next >= last) {
+        return 0;
+    }
+    uint64_t seed = GameSeed(batchSeed, (*next)++);
+    for (int p = 0; p < MAX_PLAYERS; p++) LaneSet(tmp, lane, 1, &L->pos[p]);
+    LaneSet(tmp, lane, 0, &L->cur);
+    LaneSet(tmp, lane, 0, &L->turn);
+    LaneSet(tmp, lane, (int32_t)(uint32_t)seed, &L->k0);
+    LaneSet(tmp, lane, (int32_t)(uint32_t)(seed >> 32), &L->k1);
+    LaneSet(tmp, lane, 0, &L->snakeHits);
+    LaneSet(tmp, lane, 0, &L->ladderHits);
+    LaneSet(tmp, lane, 0, &L->bounces);
+    return 1;
+}
+
+//philox4x32-10 on every lane with counter (turn / 2, 0, RNG_DICE, 0), same words DiceAt uses
+static void LaneDice(const Lanes* L, V* w0, V* w1, V* w2, V* w3)
+{
+    V c0 = VSrl(L->turn, 1), c1 = VSet1(0), c2 = VSet1(RNG_DICE), c3 = VSet1(0);
+    V k0 = L->k0, k1 = L->k1;
+    V m0 = VSet1((int)0xD2511F53u), m1 = VSet1((int)0xCD9E8D57u);
+    for (int i = 0; i < 10; i++) {
+        V hi0 = VMulHi(m0, c0), lo0 = VMullo(m0, c0);
+        V hi1 = VMulHi(m1, c2), lo1 = VMullo(m1, c2);
+        c0 = VXor(VXor(hi1, c1), k0);
+        c2 = VXor(VXor(hi0, c3), k1);
+        c1 = lo1;
+        c3 = lo0;
+        k0 = VAdd(k0, VSet1((int)0x9E3779B9u));
+        k1 = VAdd(k1, VSet1((int)0xBB67AE85u));
+    }
+    *w0 = c0; *w1 = c1; *w2 = c2; *w3 = c3;
+}
+
+typedef struct {
+    const int32_t* jump;
+    int playerCount;
+    int twoDice;
+} Kernel;
+
+//what stats wants beyond the per game counters, kept here for a range and added to the shard
+//at the end of it. roll totals are counted lane by lane. landings on a link are counted per
+//tile without a branch, a lane that hit none adds to tile 0, and jump says snake or ladder
+typedef struct {
+    V rolls[STATS_ROLLS];
+    int64_t linkTiles[BOARD_TILES + 1];
+    uint32_t steps; //since rolls was last emptied, a lane count can't pass it
+} Counts;
+
+static void CountsEmpty(Counts* c, Stats* st)
+{
+    int32_t v[LANES];
+    for (int r = 0; r < STATS_ROLLS; r++) {
+        int64_t n = 0;
+        VStore(v, c->rolls[r]);
+        for (int lane = 0; lane < LANES; lane++) n += v[lane];
+        if (n) SysBump64(&st->rollTotals[r], n);
+        c->rolls[r] = VSet1(0);
+    }
+    c->steps = 0;
+}
+
+//one turn on the lanes in act using dice words wa/wb, returns the lanes whose game ended
+static inline M HalfStep(const Kernel* k, Lanes* L, M act, V wa, V wb, M* won, Counts* c)
+{
+    const V one = VSet1(1), six = VSet1(6), top = VSet1(BOARD_TILES), twiceTop = VSet1(2 * BOARD_TILES);
+
+    V roll = VAdd(one, VMulHi(wa, six));
+    if (k->twoDice) roll = VAdd(roll, VAdd(one, VMulHi(wb, six)));
+
+    V from = L->pos[0];
+    for (int p = 1; p < k->playerCount; p++) from = VBlend(from, L->pos[p], VEq(L->cur, VSet1(p)));
+
+    //bounce at the last tile is min(t, 2 * top - t), then one gather for Slide
+    V t = VAdd(from, roll);
+    V landed = VMin(t, VSub(twiceTop, t));
+    V to = VGather(k->jump, landed);
+
+    L->snakeHits = VAddMasked(L->snakeHits, MAnd(VGt(landed, to), act));
+    L->ladderHits = VAddMasked(L->ladderHits, MAnd(VGt(to, landed), act));
+    L->bounces = VAddMasked(L->bounces, MAnd(VGt(t, top), act));
+    if (c) {
+        for (int r = 1 + k->twoDice; r <= 6 + 6 * k->twoDice; r++) {
+            c->rolls[r] = VAddMasked(c->rolls[r], MAnd(VEq(roll, VSet1(r)), act));
+        }
+        int linked = MBits(MAnd(MOr(VGt(landed, to), VGt(to, landed)), act));
+        if (linked) {
+            int32_t at[LANES];
+            VStore(at, landed);
+            for (int lane = 0; lane < LANES; lane++) c->linkTiles[at[lane] & -((linked >> lane) & 1)]++;
+        }
+        c->steps++;
+    }
+    for (int p = 0; p < k->playerCount; p++) {
+        L->pos[p] = VBlend(L->pos[p], to, MAnd(VEq(L->cur, VSet1(p)), act));
+    }
+
+    M w = MAnd(VEq(to, top), act);
+    M capped = MAndNot(w, MAnd(VEq(L->turn, VSet1(MAX_GAME_TURNS - 1)), act));
+    L->turn = VAddMasked(L->turn, act);
+    V nextCur = VAdd(L->cur, one);
+    nextCur = VBlend(nextCur, VSet1(0), VEq(nextCur, VSet1(k->playerCount)));
+    L->cur = VBlend(L->cur, nextCur, MAndNot(w, act)); //winners keep their seat for the record
+
+    *won = MOr(*won, w);
+    return MOr(w, capped);
+}
+
+void SIMD_KERNEL(const SimConfig* cfg, uint64_t batchSeed, uint64_t first, uint64_t last, SimSummary* sum, Stats* st)
+{
+    Board board;
+    BoardInitDefault(&board);
+    int32_t jump[BOARD_TILES + 1];
+    for (int t = 0; t <= BOARD_TILES; t++) jump[t] = Slide(&board, t);
+    Kernel k = { jump, cfg->playerCount, cfg->diceCount == 2 };
+
+    Lanes L;
+    memset(&L, 0, sizeof(L));
+    Counts counts;
+    Counts* c = st ? &counts : NULL;
+    if (c) memset(c, 0, sizeof(*c));
+    uint64_t next = first;
+    int live = 0;
+    for (int lane = 0; lane < LANES; lane++) {
+        if (LaneRefill(&L, lane, &next, last, batchSeed)) live |= 1 << lane;
+    }
+    L.active = MFromBits(live);
+
+    //every live lane sits on an even turn here, so one philox block feeds two turns like DiceAt.
+    //a game that ends on the first turn sits out the second and is refilled after it
+    while (live) {
+        V w0, w1, w2, w3;
+        LaneDice(&L, &w0, &w1, &w2, &w3);
+        M won = MFromBits(0);
+        M doneA = HalfStep(&k, &L, L.active, w0, w1, &won, c);
+        M doneB = HalfStep(&k, &L, MAndNot(doneA, L.active), w2, w3, &won, c);
+        if (c && c->steps >= (1u << 30)) CountsEmpty(c, st);
+
+        int done = MBits(MOr(doneA, doneB));
+        if (!done) {
+            continue;
+        }
+
+        int32_t cur[LANES], turn[LANES], sh[LANES], lh[LANES], bo[LANES];
+        VStore(cur, L.cur); VStore(turn, L.turn);
+        VStore(sh, L.snakeHits); VStore(lh, L.ladderHits); VStore(bo, L.bounces);
+        int wonBits = MBits(won);
+        for (int lane = 0; lane < LANES; lane++) {
+            if (!((done >> lane) & 1)) continue;
+            GameResult r;
+            memset(&r, 0, sizeof(r));
+            r.winner = ((wonBits >> lane) & 1) ? cur[lane] : -1;
+            r.turns = turn[lane];
+            r.snakeHits = sh[lane];
+            r.ladderHits = lh[lane];
+            r.bounces = bo[lane];
+            SimRecordGame(sum, &r);
+            if (st) {
+                //a classic turn is one move
+                SysBump64(&st->moves, r.turns);
+                SysBump64(&st->bounces, r.bounces);
+                SysBump64(&st->snakeHits, r.snakeHits);
+                SysBump64(&st->ladderHits, r.ladderHits);
+                StatsGameEnd(st, r.winner, r.turns);
+            }
+            if (!LaneRefill(&L, lane, &next, last, batchSeed)) live &= ~(1 << lane);
+        }
+        L.active = MFromBits(live);
+    }
+
+    if (c) {
+        CountsEmpty(c, st);
+        for (int t = 1; t <= BOARD_TILES; t++) {
+            if (!c->linkTiles[t]) continue;
+            int64_t* tiles = jump[t] < t ? st->snakeTiles : st->ladderTiles;
+            SysBump64(&tiles[StatsTile(t, BOARD_TILES)], c->linkTiles[t]);
+        }
+    }
+}
@@ -0,0 +1,389 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include "solver.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SOLVE_EPS        1e-13   //stop once every seat has less than this left on the board
+#define SOLVE_MAX_TURNS  1000000
+#define MOMENT_EPS       1e-12   //the moment sweeps stop once no tile moves more than this, relative
+#define MOMENT_SWEEPS    100000
+
+//transposed transition matrix in ELL layout: row j lists the tiles that can move onto j.
+//rows are padded to the same width with (tile 0, 0.0) and x[0] is always 0, so the
+//kernel is width passes of a straight gather loop the compiler can vectorize
+typedef struct {
+    int n;          //tiles 0..n-1, tile 0 unused, n is the absorbing last tile
+    int width;
+    int* cols;      //width * n
+    double* vals;   //width * n
+    double* exitP;  //chance to finish from each tile in one roll
+} Chain;
+
+static int Rolls(int diceCount, int* roll, double* p)
+{
+    int k = 0;
+    if (diceCount == 1) {
+        for (int r = 1; r <= 6; r++) {
+            roll[k] = r;
+            p[k++] = 1.0 / 6.0;
+        }
+        return k;
+    }
+    for (int r = 2; r <= 12; r++) {
+        roll[k] = r;
+        p[k++] = (6 - abs(r - 7)) / 36.0;
+    }
+    return k;
+}
+
+static int Bounce(int pos, int roll, int tiles)
+{
+    int t = pos + roll;
+    if (t > tiles) t = 2 * tiles - t;
+    return (t < 1) ? 1 : t;
+}
+
+static void ChainFree(Chain* c)
+{
+    free(c->cols);
+    free(c->vals);
+    free(c->exitP);
+    memset(c, 0, sizeof(*c));
+}
+
+static int ChainBuild(const ChainSpec* spec, Chain* c)
+{
+    int N = spec->tiles;
+    int roll[11];
+    double p[11];
+    int k = Rolls(spec->diceCount, roll, p);
+
+    memset(c, 0, sizeof(*c));
+    c->n = N;
+    int* indeg = (int*)calloc((size_t)N, sizeof(int));
+    c->exitP = (double*)calloc((size_t)N, sizeof(double));
+    if (!indeg || !c->exitP) {
+        free(indeg);
+        ChainFree(c);
+        return 0;
+    }
+
+    for (int i = 1; i < N; i++) {
+        for (int r = 0; r < k; r++) {
+            int d = spec->jump[Bounce(i, roll[r], N)];
+            if (d == N) c->exitP[i] += p[r];
+            else indeg[d]++;
+        }
+    }
+    for (int j = 1; j < N; j++) {
+        if (indeg[j] > c->width) c->width = indeg[j];
+    }
+
+    size_t cells = (size_t)c->width * (size_t)N;
+    c->cols = (int*)calloc(cells ? cells : 1, sizeof(int));
+    c->vals = (double*)calloc(cells ? cells : 1, sizeof(double));
+    if (!c->cols || !c->vals) {
+        free(indeg);
+        ChainFree(c);
+        return 0;
+    }
+
+    memset(indeg, 0, (size_t)N * sizeof(int));
+    for (int i = 1; i < N; i++) {
+        for (int r = 0; r < k; r++) {
+            int d = spec->jump[Bounce(i, roll[r], N)];
+            if (d == N) continue;
+            size_t at = (size_t)indeg[d]++ * N + d;
+            c->cols[at] = i;
+            c->vals[at] = p[r];
+        }
+    }
+    free(indeg);
+    return 1;
+}
+
+//y = x * P over the transient tiles, returns the mass that reached the last tile.
+//*left gets what is still on the board, summed fresh so rounding can't pile up over long games
+static double ChainStep(const Chain* c, const double* x, double* y, double* left)
+{
+    int n = c->n;
+    double done = 0.0;
+    for (int i = 0; i < n; i++) {
+        done += x[i] * c->exitP[i];
+        y[i] = 0.0;
+    }
+    for (int w = 0; w < c->width; w++) {
+        const int* col = c->cols + (size_t)w * n;
+        const double* val = c->vals + (size_t)w * n;
+        for (int j = 0; j < n; j++) {
+            y[j] += val[j] * x[col[j]];
+        }
+    }
+    y[0] = 0.0;
+
+    double sum = 0.0;
+    for (int j = 0; j < n; j++) sum += y[j];
+    *left = sum;
+    return done;
+}
+
+//tiles whose token is sure to finish. a tile that can't reach the last one is a trap, and so
+//is every tile that can reach a trap. both walk the transposed chain back from where they start
+static unsigned char* Finishing(const Chain* c)
+{
+    int n = c->n;
+    unsigned char* mark = (unsigned char*)calloc((size_t)n, 1); //1 reaches the end, 2 may be trapped
+    int* stack = (int*)malloc((size_t)n * sizeof(int));
+    if (!mark || !stack) {
+        free(mark);
+        free(stack);
+        return NULL;
+    }
+    for (int pass = 1; pass <= 2; pass++) {
+        int top = 0;
+        for (int i = 1; i < n; i++) {
+            bool seed = pass == 1 ? c->exitP[i] > 0.0 : !mark[i];
+            if (!seed) continue;
+            mark[i] = (unsigned char)pass;
+            stack[top++] = i;
+        }
+        while (top) {
+            int j = stack[--top];
+            for (int w = 0; w < c->width; w++) {
+                size_t at = (size_t)w * n + j;
+                int i = c->cols[at];
+                if (c->vals[at] == 0.0 || mark[i] == pass) continue;
+                if (pass == 1 && mark[i]) continue;
+                mark[i] = (unsigned char)pass;
+                stack[top++] = i;
+            }
+        }
+    }
+    free(stack);
+    for (int i = 1; i < n; i++) mark[i] = mark[i] == 1;
+    return mark;
+}
+
+//expected own turns from each tile and their square, by where one roll takes it:
+//E[T] = 1 + sum p E[T_n] and E[T^2] = 2 E[T] - 1 + sum p E[T_n^2]. solved in place from the
+//top tile down as design's Moments does, so each sweep carries a jump back one link further
+static int OwnMoments(const ChainSpec* spec, const Chain* c, const int* start, int seats, SolveResult* out)
+{
+    int N = spec->tiles;
+    int roll[11];
+    double p[11];
+    int k = Rolls(spec->diceCount, roll, p);
+    unsigned char* sure = Finishing(c);
+    double* e = (double*)calloc((size_t)N + 1, sizeof(double));
+    double* s = (double*)calloc((size_t)N + 1, sizeof(double));
+    int ok = sure && e && s;
+    if (ok) {
+        for (int t = 1; t < N; t++) {
+            e[t] = sure[t] ? (double)(N - t) / (3.5 * spec->diceCount) : 0.0;
+            s[t] = e[t] * e[t];
+        }
+    }
+    int sweep = 0;
+    for (; ok && sweep < MOMENT_SWEEPS; sweep++) {
+        double moved = 0.0;
+        for (int t = N - 1; t >= 1; t--) {
+            if (!sure[t]) continue;
+            double sumE = 1.0, sumS = 0.0;
+            for (int r = 0; r < k; r++) {
+                int n = spec->jump[Bounce(t, roll[r], N)];
+                sumE += p[r] * e[n];
+                sumS += p[r] * s[n];
+            }
+            sumS += 2.0 * sumE - 1.0;
+            double d = fabs(sumS - s[t]) / sumS;
+            if (d > moved) moved = d;
+            e[t] = sumE;
+            s[t] = sumS;
+        }
+        if (moved < MOMENT_EPS) {
+            break;
+        }
+    }
+    ok = ok && sweep < MOMENT_SWEEPS;
+    for (int i = 0; i < seats && ok; i++) {
+        int t = start[i];
+        out->expectedOwnTurns[i] = sure[t] ? e[t] : HUGE_VAL;
+        out->sdOwnTurns[i] = sure[t] ? sqrt(fmax(s[t] - e[t] * e[t], 0.0)) : HUGE_VAL;
+    }
+    free(sure);
+    free(e);
+    free(s);
+    return ok;
+}
+
+static int Grow(double** arr, int* cap, int need)
+{
+    if (need < *cap) {
+        return 1;
+    }
+    int ncap = *cap ? *cap * 2 : 256;
+    while (ncap <= need) ncap *= 2;
+    double* n = (double*)realloc(*arr, (size_t)ncap * sizeof(double));
+    if (!n) {
+        return 0;
+    }
+    memset(n + *cap, 0, (size_t)(ncap - *cap) * sizeof(double));
+    *arr = n;
+    *cap = ncap;
+    return 1;
+}
+
+int SolveChain(const ChainSpec* spec, const int* start, int seats, int firstSeat, SolveResult* out)
+{
+    memset(out, 0, sizeof(*out));
+    int N = spec->tiles;
+    if (N < 2 || seats < 1 || seats > MAX_PLAYERS || firstSeat < 0 || firstSeat >= seats) {
+        return 0;
+    }
+    for (int t = 1; t <= N; t++) {
+        if (spec->jump[t] < 1 || spec->jump[t] > N) return 0;
+    }
+    for (int s = 0; s < seats; s++) {
+        if (start[s] < 1 || start[s] >= N) return 0;
+    }
+
+    Chain c;
+    if (!ChainBuild(spec, &c)) {
+        return 0;
+    }
+    if (!OwnMoments(spec, &c, start, seats, out)) {
+        ChainFree(&c);
+        return 0;
+    }
+    int maxTurns = spec->maxTurns;
+    if (maxTurns <= 0) maxTurns = SOLVE_WORK / N > 1 ? SOLVE_WORK / N : 1;
+    if (maxTurns > SOLVE_MAX_TURNS) maxTurns = SOLVE_MAX_TURNS;
+
+    //seats on the same tile share one walk, a fresh game only needs the one
+    int dupOf[MAX_PLAYERS];
+    for (int s = 0; s < seats; s++) {
+        dupOf[s] = -1;
+        for (int j = 0; j < s && dupOf[s] < 0; j++) {
+            if (start[j] == start[s] && dupOf[j] < 0) dupOf[s] = j;
+        }
+    }
+
+    double* x[MAX_PLAYERS] = { 0 };
+    double* y = (double*)calloc((size_t)N, sizeof(double));
+    int ok = y != NULL;
+    for (int s = 0; s < seats && ok; s++) {
+        if (dupOf[s] >= 0) continue;
+        x[s] = (double*)calloc((size_t)N, sizeof(double));
+        ok = x[s] != NULL;
+        if (ok) x[s][start[s]] = 1.0;
+    }
+
+    double left[MAX_PLAYERS];
+    int cap[MAX_PLAYERS] = { 0 };
+    for (int s = 0; s < seats; s++) left[s] = 1.0;
+
+    out->seats = seats;
+    int t = 0;
+    for (;;) {
+        double most = 0.0;
+        for (int s = 0; s < seats; s++) {
+            if (left[s] > most) most = left[s];
+        }
+        if (!ok || most < SOLVE_EPS) {
+            break;
+        }
+        if (t == maxTurns) {
+            out->cut = true;
+            break;
+        }
+
+        t++;
+        for (int s = 0; s < seats && ok; s++) {
+            ok = Grow(&out->finish[s], &cap[s], t);
+            if (!ok) break;
+            if (dupOf[s] >= 0) {
+                out->finish[s][t] = out->finish[dupOf[s]][t];
+                left[s] = left[dupOf[s]];
+                continue;
+            }
+            double done = ChainStep(&c, x[s], y, &left[s]);
+            double* tmp = x[s];
+            x[s] = y;
+            y = tmp;
+            out->finish[s][t] = done;
+        }
+    }
+    out->turnCount = t + 1;
+
+    for (int s = 0; s < seats; s++) free(x[s]);
+    free(y);
+    ChainFree(&c);
+
+    out->lengthCount = ok ? t * seats + 1 : 0;
+    out->gameLength = ok ? (double*)calloc((size_t)out->lengthCount, sizeof(double)) : NULL;
+    if (!out->gameLength) {
+        SolveResultFree(out);
+        return 0;
+    }
+
+    //seat s wins on its u-th turn if everyone before it in the order still needs more
+    //than u turns and everyone after it more than u-1
+    int order[MAX_PLAYERS];
+    double cum[MAX_PLAYERS] = { 0 };
+    for (int s = 0; s < seats; s++) {
+        order[s] = (s - firstSeat + seats) % seats;
+        out->unresolved += left[s] / seats;
+    }
+    for (int u = 1; u <= t; u++) {
+        double before[MAX_PLAYERS], after[MAX_PLAYERS];
+        for (int s = 0; s < seats; s++) {
+            before[s] = 1.0 - cum[s];
+            after[s] = before[s] - out->finish[s][u];
+            if (after[s] < 0.0) after[s] = 0.0;
+        }
+        for (int s = 0; s < seats; s++) {
+            double p = out->finish[s][u];
+            for (int j = 0; j < seats; j++) {
+                if (j == s) continue;
+                p *= (order[j] < order[s]) ? after[j] : before[j];
+            }
+            int n = (u - 1) * seats + order[s] + 1;
+            out->winProb[s] += p;
+            out->gameLength[n] += p;
+            out->expectedGameTurns += p * n;
+        }
+        for (int s = 0; s < seats; s++) cum[s] += out->finish[s][u];
+    }
+    return 1;
+}
+
+int SolveGame(const Game* g, SolveResult* out)
+{
+    if (g->winner >= 0) {
+        memset(out, 0, sizeof(*out));
+        out->seats = g->playerCount;
+        out->winProb[g->winner] = 1.0;
+        return 1;
+    }
+
+    int tiles = g->board.tiles;
+    int* jump = (int*)malloc(((size_t)tiles + 1) * sizeof(int));
+    if (!jump) {
+        return 0;
+    }
+    for (int t = 0; t <= tiles; t++) {
+        jump[t] = Slide(&g->board, t);
+    }
+    ChainSpec spec = { tiles, jump, g->diceCount, 0 };
+    int ok = SolveChain(&spec, g->position, g->playerCount, g->currentPlayer, out);
+    free(jump);
+    return ok;
+}
+
+void SolveResultFree(SolveResult* r)
+{
+    for (int s = 0; s < MAX_PLAYERS; s++) free(r->finish[s]);
+    free(r->gameLength);
+    memset(r, 0, sizeof(*r));
+}
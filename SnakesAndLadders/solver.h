@@ -0,0 +1,41 @@
+#pragma once
+#include "game.h"
+
+//exact game odds from the absorbing markov chain of a board, no simulation.
+//every token walks the chain on its own (tokens never block each other), so one
+//distribution per seat plus the turn order gives the whole game.
+//
+//a token's expected turns and their spread are solved in place, a few sweeps over the tiles
+//however big the board. the distribution is stepped one turn at a time, turns times tiles,
+//and a game lasts about tiles / 3.5 turns a die, so its cost grows with the square of the
+//board: a 10x10 takes under a millisecond, 50x50 about a tenth of a second, 100x100 two.
+//the steps stop at maxTurns, the odds and game length then leave out the unresolved games
+
+typedef struct {
+    int tiles;       //last tile wins, start is tile 1
+    const int* jump; //tiles + 1 entries, jump[t] is where a landing on t ends
+    int diceCount;
+    int maxTurns;    //distribution steps, 0 for as many as SOLVE_WORK buys on this board
+} ChainSpec;
+
+#define SOLVE_WORK 20000000 //tiles times turns stepped when maxTurns is 0, about a tenth of a second
+
+typedef struct {
+    int seats;
+    int turnCount;                   //length of the finish arrays
+    double* finish[MAX_PLAYERS];     //finish[s][t] = chance seat s needs exactly t more own turns
+    double expectedOwnTurns[MAX_PLAYERS]; //these two are exact whatever maxTurns is, HUGE_VAL
+    double sdOwnTurns[MAX_PLAYERS];       //for a seat that may never finish
+    double winProb[MAX_PLAYERS];
+    int lengthCount;                 //length of gameLength
+    double* gameLength;              //gameLength[n] = chance the game ends after n more turns in total
+    double expectedGameTurns;
+    double unresolved;               //mass still on the board when the steps stopped
+    bool cut;                        //stopped at maxTurns, not because the games were done
+} SolveResult;
+
+//start[s] is seat s's tile, firstSeat moves next
+int  SolveChain(const ChainSpec* spec, const int* start, int seats, int firstSeat, SolveResult* out);
+//odds from the game's current board, positions and turn, chaos snakes still to come are not counted
+int  SolveGame(const Game* g, SolveResult* out);
+void SolveResultFree(SolveResult* r);
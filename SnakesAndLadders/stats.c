@@ -0,0 +1,50 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include "stats.h"
+#include <string.h>
+
+#define STATS_FIELDS ((int)(sizeof(Stats) / sizeof(int64_t)))
+
+void StatsAdd(Stats* into, const Stats* from)
+{
+    int64_t* to = (int64_t*)into;
+    const int64_t* f = (const int64_t*)from;
+    for (int i = 0; i < STATS_FIELDS; i++) to[i] += SysPeek64(&f[i]);
+}
+
+void StatsMerge(const StatsShard* shards, int count, Stats* out)
+{
+    memset(out, 0, sizeof(*out));
+    for (int i = 0; i < count; i++) StatsAdd(out, &shards[i].s);
+}
+
+int StatsTurnPercentile(const Stats* s, double pct)
+{
+    int64_t want = (int64_t)(s->games * pct / 100.0), seen = 0;
+    for (int b = 0; b < STATS_TURN_BUCKETS; b++) {
+        seen += s->turnHist[b];
+        if (seen > want) return b;
+    }
+    return STATS_TURN_BUCKETS - 1;
+}
+
+static void WriteArray(FILE* f, const char* name, const int64_t* v, int count)
+{
+    fprintf(f, ", \"%s\": [", name);
+    for (int i = 0; i < count; i++) fprintf(f, "%s%lld", i ? "," : "", (long long)v[i]);
+    fprintf(f, "]");
+}
+
+void StatsWriteJson(FILE* f, const Stats* s, double seconds)
+{
+    double n = s->games ? (double)s->games : 1.0;
+    fprintf(f, "{\"seconds\": %.3f, \"games\": %lld, \"unfinished\": %lld, \"avg_turns\": %.4f, \"p50\": %d, \"p99\": %d",
+        seconds, (long long)s->games, (long long)s->unfinished, (double)s->turns / n, StatsTurnPercentile(s, 50), StatsTurnPercentile(s, 99));
+    fprintf(f, ", \"moves\": %lld, \"bounces\": %lld, \"snake_hits\": %lld, \"ladder_hits\": %lld, \"chaos_placed\": %lld, \"chaos_hits\": %lld",
+        (long long)s->moves, (long long)s->bounces, (long long)s->snakeHits, (long long)s->ladderHits, (long long)s->chaosPlaced, (long long)s->chaosHits);
+    WriteArray(f, "wins", s->wins, MAX_PLAYERS);
+    WriteArray(f, "roll_totals", s->rollTotals, STATS_ROLLS);
+    WriteArray(f, "snake_tiles", s->snakeTiles, STATS_TILES);
+    WriteArray(f, "ladder_tiles", s->ladderTiles, STATS_TILES);
+    fprintf(f, "}\n");
+    fflush(f);
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <stdio.h>
+#include "game.h"
+#include "sys.h"
+
+//counters for games as they're played, in a batch or on screen. every writer has a shard of
+//its own and is the only one to write it, an add being a plain load and store, so counting
+//costs what an add to memory costs. StatsMerge sums shards whenever it's asked, writers still
+//going or not: each counter it reads is whole, two of them may be a few moves apart until
+//the writers stop
+
+#define STATS_TURN_BUCKETS 512 //game length in turns, the last bucket also takes longer games
+#define STATS_TILES        100 //per tile counts, a bigger board shares them out by position
+#define STATS_ROLLS        13  //roll totals 1..12
+
+//every field an int64_t, StatsAdd walks them as one array
+typedef struct {
+    int64_t games;
+    int64_t unfinished;
+    int64_t turns;
+    int64_t moves;       //rolls that moved a token, more than turns with house rules
+    int64_t bounces;
+    int64_t snakeHits;
+    int64_t ladderHits;
+    int64_t chaosPlaced;
+    int64_t chaosHits;   //landings on snakes a player put down
+    int64_t wins[MAX_PLAYERS];
+    int64_t turnHist[STATS_TURN_BUCKETS];
+    int64_t rollTotals[STATS_ROLLS];
+    int64_t snakeTiles[STATS_TILES];  //by head
+    int64_t ladderTiles[STATS_TILES]; //by foot
+} Stats;
+
+//the padding keeps one shard's writes off the next one's cache lines
+typedef struct {
+    Stats s;
+    char pad[64];
+} StatsShard;
+
+static inline int StatsTile(int tile, int tiles)
+{
+    return (tiles == STATS_TILES) ? tile - 1 : (int)((int64_t)(tile - 1) * STATS_TILES / tiles);
+}
+
+static inline void StatsRoll(Stats* s, int total)
+{
+    SysBump64(&s->rollTotals[total], 1);
+}
+
+//whether tile is the head of a snake from chaosFrom on, one put down during the game. a scan,
+//the batch loops keep a bit per tile instead
+static inline bool StatsChaosHead(const Board* b, int chaosFrom, int tile)
+{
+    for (int i = chaosFrom; i < b->snakeCount; i++) {
+        if (b->snakes[i].start == tile) return true;
+    }
+    return false;
+}
+
+static inline void StatsMove(Stats* s, int tiles, int landed, int to, bool bounced, bool chaosHit)
+{
+    SysBump64(&s->moves, 1);
+    if (bounced) SysBump64(&s->bounces, 1);
+    if (to < landed) {
+        SysBump64(&s->snakeHits, 1);
+        SysBump64(&s->snakeTiles[StatsTile(landed, tiles)], 1);
+        if (chaosHit) SysBump64(&s->chaosHits, 1);
+    }
+    else if (to > landed) {
+        SysBump64(&s->ladderHits, 1);
+        SysBump64(&s->ladderTiles[StatsTile(landed, tiles)], 1);
+    }
+}
+
+static inline void StatsPlaced(Stats* s)
+{
+    SysBump64(&s->chaosPlaced, 1);
+}
+
+static inline void StatsGameEnd(Stats* s, int winner, int turns)
+{
+    SysBump64(&s->games, 1);
+    SysBump64(&s->turns, turns);
+    if (winner >= 0) SysBump64(&s->wins[winner], 1);
+    else SysBump64(&s->unfinished, 1);
+    SysBump64(&s->turnHist[turns < STATS_TURN_BUCKETS ? turns : STATS_TURN_BUCKETS - 1], 1);
+}
+
+void StatsAdd(Stats* into, const Stats* from); //into is the caller's own, from may be live
+void StatsMerge(const StatsShard* shards, int count, Stats* out);
+int  StatsTurnPercentile(const Stats* s, double pct);
+void StatsWriteJson(FILE* f, const Stats* s, double seconds); //one line
@@ -0,0 +1,375 @@
+#define _POSIX_C_SOURCE 200809L
+#include "sys.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+typedef struct {
+    SysThreadFn fn;
+    void* arg;
+} ThreadStart;
+
+#if defined(_WIN32)
+
+static DWORD WINAPI ThreadMain(LPVOID p)
+{
+    ThreadStart s = *(ThreadStart*)p;
+    free(p);
+    s.fn(s.arg);
+    return 0;
+}
+
+int SysThreadStart(SysThread* t, SysThreadFn fn, void* arg)
+{
+    ThreadStart* s = (ThreadStart*)malloc(sizeof(ThreadStart));
+    if (!s) {
+        return 0;
+    }
+    s->fn = fn;
+    s->arg = arg;
+    HANDLE h = CreateThread(NULL, 0, ThreadMain, s, 0, NULL);
+    if (!h) {
+        free(s);
+        return 0;
+    }
+    t->handle = (uintptr_t)h;
+    return 1;
+}
+
+void SysThreadJoin(SysThread* t)
+{
+    WaitForSingleObject((HANDLE)t->handle, INFINITE);
+    CloseHandle((HANDLE)t->handle);
+}
+
+typedef struct {
+    SRWLOCK lock;
+    CONDITION_VARIABLE cond;
+} Lock;
+
+int SysLockInit(SysLock* l)
+{
+    Lock* k = (Lock*)malloc(sizeof(Lock));
+    if (!k) {
+        return 0;
+    }
+    InitializeSRWLock(&k->lock);
+    InitializeConditionVariable(&k->cond);
+    l->impl = k;
+    return 1;
+}
+
+void SysLockFree(SysLock* l)
+{
+    free(l->impl);
+    l->impl = NULL;
+}
+
+void SysLockEnter(SysLock* l)
+{
+    AcquireSRWLockExclusive(&((Lock*)l->impl)->lock);
+}
+
+void SysLockLeave(SysLock* l)
+{
+    ReleaseSRWLockExclusive(&((Lock*)l->impl)->lock);
+}
+
+void SysLockWait(SysLock* l)
+{
+    Lock* k = (Lock*)l->impl;
+    SleepConditionVariableSRW(&k->cond, &k->lock, INFINITE, 0);
+}
+
+void SysLockWake(SysLock* l)
+{
+    WakeAllConditionVariable(&((Lock*)l->impl)->cond);
+}
+
+int SysCpuCount(void)
+{
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    return (int)si.dwNumberOfProcessors;
+}
+
+double SysNow(void)
+{
+    LARGE_INTEGER f, c;
+    QueryPerformanceFrequency(&f);
+    QueryPerformanceCounter(&c);
+    return (double)c.QuadPart / (double)f.QuadPart;
+}
+
+double SysCpuTime(void)
+{
+    FILETIME created, exited, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user)) {
+        return 0.0;
+    }
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime;
+    k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime;
+    u.HighPart = user.dwHighDateTime;
+    return (double)(k.QuadPart + u.QuadPart) * 1e-7; //100 ns ticks
+}
+
+int SysMapFile(const char* path, SysMap* m)
+{
+    memset(m, 0, sizeof(*m));
+    HANDLE f = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (f == INVALID_HANDLE_VALUE) {
+        return 0;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(f, &size) || size.QuadPart == 0) {
+        CloseHandle(f);
+        return 0;
+    }
+    HANDLE h = CreateFileMappingA(f, NULL, PAGE_READONLY, 0, 0, NULL);
+    const void* p = h ? MapViewOfFile(h, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (!p) {
+        if (h) CloseHandle(h);
+        CloseHandle(f);
+        return 0;
+    }
+    m->data = (const uint8_t*)p;
+    m->size = (size_t)size.QuadPart;
+    m->file = (uintptr_t)f;
+    m->mapping = (uintptr_t)h;
+    return 1;
+}
+
+void SysUnmapFile(SysMap* m)
+{
+    if (m->data) {
+        UnmapViewOfFile(m->data);
+        CloseHandle((HANDLE)m->mapping);
+        CloseHandle((HANDLE)m->file);
+    }
+    memset(m, 0, sizeof(*m));
+}
+
+int SysReplaceFile(const char* from, const char* to)
+{
+    return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING) != 0;
+}
+
+static int64_t UnixNanos(FILETIME ft)
+{
+    int64_t t = (int64_t)((uint64_t)ft.dwHighDateTime << 32 | ft.dwLowDateTime);
+    return (t - 116444736000000000LL) * 100; //filetime counts 100ns from 1601
+}
+
+int SysStat(const char* path, int64_t* mtime, uint64_t* size)
+{
+    WIN32_FILE_ATTRIBUTE_DATA a;
+    if (!GetFileAttributesExA(path, GetFileExInfoStandard, &a)) {
+        return 0;
+    }
+    *mtime = UnixNanos(a.ftLastWriteTime);
+    *size = (uint64_t)a.nFileSizeHigh << 32 | a.nFileSizeLow;
+    return 1;
+}
+
+//FindFirstFile hands back the size and mtime with each name, no extra call per file
+int SysListDir(const char* dir, const char* ext, SysDirFn fn, void* ctx)
+{
+    char pattern[MAX_PATH];
+    if (snprintf(pattern, sizeof(pattern), "%s\\*%s", dir, ext) >= (int)sizeof(pattern)) {
+        return 0;
+    }
+    WIN32_FIND_DATAA d;
+    HANDLE h = FindFirstFileA(pattern, &d);
+    if (h == INVALID_HANDLE_VALUE) {
+        return GetLastError() == ERROR_FILE_NOT_FOUND;
+    }
+    do {
+        if (d.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) continue;
+        fn(d.cFileName, UnixNanos(d.ftLastWriteTime), (uint64_t)d.nFileSizeHigh << 32 | d.nFileSizeLow, ctx);
+    } while (FindNextFileA(h, &d));
+    FindClose(h);
+    return 1;
+}
+
+#else
+
+static void* ThreadMain(void* p)
+{
+    ThreadStart s = *(ThreadStart*)p;
+    free(p);
+    s.fn(s.arg);
+    return NULL;
+}
+
+int SysThreadStart(SysThread* t, SysThreadFn fn, void* arg)
+{
+    ThreadStart* s = (ThreadStart*)malloc(sizeof(ThreadStart));
+    if (!s) {
+        return 0;
+    }
+    s->fn = fn;
+    s->arg = arg;
+    pthread_t h;
+    if (pthread_create(&h, NULL, ThreadMain, s) != 0) {
+        free(s);
+        return 0;
+    }
+    t->handle = (uintptr_t)h;
+    return 1;
+}
+
+void SysThreadJoin(SysThread* t)
+{
+    pthread_join((pthread_t)t->handle, NULL);
+}
+
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+} Lock;
+
+int SysLockInit(SysLock* l)
+{
+    Lock* k = (Lock*)malloc(sizeof(Lock));
+    if (!k) {
+        return 0;
+    }
+    pthread_mutex_init(&k->mutex, NULL);
+    pthread_cond_init(&k->cond, NULL);
+    l->impl = k;
+    return 1;
+}
+
+void SysLockFree(SysLock* l)
+{
+    Lock* k = (Lock*)l->impl;
+    if (k) {
+        pthread_cond_destroy(&k->cond);
+        pthread_mutex_destroy(&k->mutex);
+        free(k);
+    }
+    l->impl = NULL;
+}
+
+void SysLockEnter(SysLock* l)
+{
+    pthread_mutex_lock(&((Lock*)l->impl)->mutex);
+}
+
+void SysLockLeave(SysLock* l)
+{
+    pthread_mutex_unlock(&((Lock*)l->impl)->mutex);
+}
+
+void SysLockWait(SysLock* l)
+{
+    Lock* k = (Lock*)l->impl;
+    pthread_cond_wait(&k->cond, &k->mutex);
+}
+
+void SysLockWake(SysLock* l)
+{
+    pthread_cond_broadcast(&((Lock*)l->impl)->cond);
+}
+
+int SysCpuCount(void)
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+
+double SysNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+double SysCpuTime(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int SysMapFile(const char* path, SysMap* m)
+{
+    memset(m, 0, sizeof(*m));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return 0;
+    }
+    void* p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); //the mapping keeps the file alive
+    if (p == MAP_FAILED) {
+        return 0;
+    }
+    m->data = (const uint8_t*)p;
+    m->size = (size_t)st.st_size;
+    return 1;
+}
+
+void SysUnmapFile(SysMap* m)
+{
+    if (m->data) {
+        munmap((void*)m->data, m->size);
+    }
+    memset(m, 0, sizeof(*m));
+}
+
+int SysReplaceFile(const char* from, const char* to)
+{
+    return rename(from, to) == 0;
+}
+
+int SysStat(const char* path, int64_t* mtime, uint64_t* size)
+{
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        return 0;
+    }
+    *mtime = (int64_t)st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+    *size = (uint64_t)st.st_size;
+    return 1;
+}
+
+int SysListDir(const char* dir, const char* ext, SysDirFn fn, void* ctx)
+{
+    DIR* d = opendir(dir);
+    if (!d) {
+        return 0;
+    }
+    size_t extLen = strlen(ext);
+    struct dirent* e;
+    while ((e = readdir(d)) != NULL) {
+        size_t n = strlen(e->d_name);
+        if (n < extLen || strcmp(e->d_name + n - extLen, ext) != 0) continue;
+        struct stat st;
+        if (fstatat(dirfd(d), e->d_name, &st, 0) != 0 || !S_ISREG(st.st_mode)) continue;
+        fn(e->d_name, (int64_t)st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec, (uint64_t)st.st_size, ctx);
+    }
+    closedir(d);
+    return 1;
+}
+
+#endif
@@ -0,0 +1,112 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+//the little bit of os the headless tools need: threads, 64-bit atomics, a clock and files.
+//windows.h stays inside sys.c because it clashes with raylib names
+
+typedef struct {
+    uintptr_t handle;
+} SysThread;
+
+typedef void (*SysThreadFn)(void* arg);
+
+int    SysThreadStart(SysThread* t, SysThreadFn fn, void* arg);
+void   SysThreadJoin(SysThread* t);
+int    SysCpuCount(void);
+double SysNow(void); //seconds on a monotonic clock
+double SysCpuTime(void); //cpu seconds this process has used on every thread
+
+//a mutex with one condition variable, enough for a job queue
+typedef struct {
+    void* impl;
+} SysLock;
+
+int  SysLockInit(SysLock* l);
+void SysLockFree(SysLock* l);
+void SysLockEnter(SysLock* l);
+void SysLockLeave(SysLock* l);
+void SysLockWait(SysLock* l); //lock held, gives it up while asleep
+void SysLockWake(SysLock* l); //wakes every waiter
+
+//read-only view of a whole file
+typedef struct {
+    const uint8_t* data;
+    size_t size;
+    uintptr_t file;
+    uintptr_t mapping;
+} SysMap;
+
+int  SysMapFile(const char* path, SysMap* m);
+void SysUnmapFile(SysMap* m);
+int  SysReplaceFile(const char* from, const char* to); //rename over an existing file
+
+//mtime is nanoseconds since 1970, fine enough to tell two saves in the same second apart
+typedef void (*SysDirFn)(const char* name, int64_t mtime, uint64_t size, void* ctx);
+
+int SysStat(const char* path, int64_t* mtime, uint64_t* size);
+int SysListDir(const char* dir, const char* ext, SysDirFn fn, void* ctx); //regular files ending in ext
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+
+static inline int64_t SysLoad64(volatile int64_t* p)
+{
+    return _InterlockedCompareExchange64(p, 0, 0);
+}
+static inline void SysStore64(volatile int64_t* p, int64_t v)
+{
+    _InterlockedExchange64(p, v);
+}
+static inline int SysCas64(volatile int64_t* p, int64_t expect, int64_t want)
+{
+    return _InterlockedCompareExchange64(p, want, expect) == expect;
+}
+static inline int64_t SysAdd64(volatile int64_t* p, int64_t v)
+{
+    return _InterlockedExchangeAdd64(p, v);
+}
+//a counter only its own thread writes: other threads read it whole, no lock on the add
+static inline int64_t SysPeek64(const volatile int64_t* p)
+{
+#if defined(_M_X64) || defined(_M_ARM64)
+    return *p;
+#else
+    return _InterlockedCompareExchange64((volatile int64_t*)p, 0, 0);
+#endif
+}
+static inline void SysBump64(volatile int64_t* p, int64_t v)
+{
+#if defined(_M_X64) || defined(_M_ARM64)
+    *p = *p + v;
+#else
+    _InterlockedExchangeAdd64(p, v);
+#endif
+}
+#else
+static inline int64_t SysLoad64(volatile int64_t* p)
+{
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+static inline void SysStore64(volatile int64_t* p, int64_t v)
+{
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+static inline int SysCas64(volatile int64_t* p, int64_t expect, int64_t want)
+{
+    return __atomic_compare_exchange_n(p, &expect, want, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+static inline int64_t SysAdd64(volatile int64_t* p, int64_t v)
+{
+    return __atomic_fetch_add(p, v, __ATOMIC_ACQ_REL);
+}
+//a counter only its own thread writes: other threads read it whole, no lock on the add
+static inline int64_t SysPeek64(const volatile int64_t* p)
+{
+    return __atomic_load_n(p, __ATOMIC_RELAXED);
+}
+static inline void SysBump64(volatile int64_t* p, int64_t v)
+{
+    __atomic_store_n(p, __atomic_load_n(p, __ATOMIC_RELAXED) + v, __ATOMIC_RELAXED);
+}
+#endif
@@ -0,0 +1,284 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include "tourney.h"
+#include "bot.h"
+#include "sys.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TOURNEY_GRAB  16  //matches a worker takes at a time
+#define RATING_PRIOR  1.0 //virtual wins and losses against an average entrant, keeps an unbeaten fit finite
+
+typedef struct {
+    uint8_t seat[MAX_PLAYERS]; //entrant per seat
+    int8_t winner;             //seat, -1 if nobody won by MAX_GAME_TURNS
+    int turns;
+} Match;
+
+typedef struct {
+    const TourneyConfig* cfg;
+    Match* matches;
+    uint64_t base; //match number of matches[0]
+    int64_t count;
+    volatile int64_t next;
+} Pool;
+
+typedef struct {
+    Pool* pool;
+    Bot* bot; //NULL when no entrant is a bot
+} Worker;
+
+//what a seat's strategy needs while its game runs
+typedef struct {
+    const TourneyConfig* cfg;
+    const Match* match;
+    Bot* bot;
+} SeatCtx;
+
+bool EntrantParse(const char* text, Entrant* out)
+{
+    memset(out, 0, sizeof(*out));
+    if (strlen(text) >= TOURNEY_NAME_LEN) {
+        return false;
+    }
+    strcpy(out->name, text);
+    if (strcmp(text, "none") == 0) out->kind = STRAT_NONE;
+    else if (strcmp(text, "random") == 0) out->kind = STRAT_RANDOM;
+    else if (strcmp(text, "greedy") == 0) out->kind = STRAT_GREEDY;
+    else if (strcmp(text, "bot") == 0) {
+        out->kind = STRAT_BOT;
+        out->depth = TOURNEY_BOT_DEPTH;
+    }
+    else if (strncmp(text, "bot:", 4) == 0) {
+        out->kind = STRAT_BOT;
+        out->budgetMs = atof(text + 4);
+        out->depth = BOT_MAX_DEPTH;
+        return out->budgetMs > 0;
+    }
+    else return false;
+    return true;
+}
+
+static int SeatPolicy(const Game* g, Rng* rng, void* ctx)
+{
+    SeatCtx* c = (SeatCtx*)ctx;
+    const Entrant* e = &c->cfg->entrants[c->match->seat[g->currentPlayer]];
+    switch (e->kind) {
+    case STRAT_RANDOM: return RandomSnakePolicy(g, rng, NULL);
+    case STRAT_GREEDY: return GreedySnakePolicy(g, rng, NULL);
+    case STRAT_BOT:
+        c->bot->budgetMs = e->budgetMs;
+        c->bot->maxDepth = e->depth;
+        return BotChooseHead(c->bot, g);
+    default: return 0;
+    }
+}
+
+static void WorkerMain(void* arg)
+{
+    Worker* w = (Worker*)arg;
+    Pool* p = w->pool;
+    const TourneyConfig* cfg = p->cfg;
+    for (;;) {
+        int64_t first = SysAdd64(&p->next, TOURNEY_GRAB);
+        if (first >= p->count) {
+            return;
+        }
+        int64_t last = first + TOURNEY_GRAB < p->count ? first + TOURNEY_GRAB : p->count;
+        for (int64_t i = first; i < last; i++) {
+            Match* m = &p->matches[i];
+            if (w->bot) BotForget(w->bot); //a table warm from another match would make this one depend on the thread
+            SeatCtx ctx = { cfg, m, w->bot };
+            SimConfig sim = { cfg->seats, cfg->diceCount, MODE_CHAOS, SeatPolicy, &ctx, 0 };
+            GameResult r;
+            SimulateGame(&sim, GameSeed(cfg->seed, p->base + (uint64_t)i), &r);
+            m->winner = (int8_t)r.winner;
+            m->turns = r.turns;
+        }
+    }
+}
+
+//plays matches[0..count) on every worker, the calling thread being worker 0
+static void PlayBatch(Pool* pool, Worker* workers, SysThread* handles, int threads)
+{
+    pool->next = 0;
+    int started = 1;
+    for (int t = 1; t < threads; t++) {
+        if (!SysThreadStart(&handles[t], WorkerMain, &workers[t])) break;
+        started++;
+    }
+    WorkerMain(&workers[0]); //also plays whatever a thread that failed to start left
+    for (int t = 1; t < started; t++) SysThreadJoin(&handles[t]);
+}
+
+//results in match order, so the totals and the csv don't depend on which thread played what
+static void Record(const TourneyConfig* cfg, const Match* m, uint64_t index, TourneyResult* out)
+{
+    out->matches++;
+    out->turns += m->turns;
+    for (int s = 0; s < cfg->seats; s++) out->games[m->seat[s]]++;
+    if (m->winner < 0) {
+        out->unfinished++;
+    }
+    else {
+        int w = m->seat[m->winner];
+        out->wins[w]++;
+        out->seatWins[m->winner]++;
+        for (int s = 0; s < cfg->seats; s++) {
+            if (s != m->winner) out->beat[w][m->seat[s]]++;
+        }
+    }
+    if (!cfg->csv) {
+        return;
+    }
+    fprintf(cfg->csv, "%llu,%llu", (unsigned long long)index, (unsigned long long)GameSeed(cfg->seed, index));
+    for (int s = 0; s < MAX_PLAYERS; s++) fprintf(cfg->csv, ",%s", s < cfg->seats ? cfg->entrants[m->seat[s]].name : "");
+    fprintf(cfg->csv, ",%d,%s,%d\n", m->winner + 1, m->winner >= 0 ? cfg->entrants[m->seat[m->winner]].name : "", m->turns);
+}
+
+//seating k of every ordered choice of seats entrants out of n, in lexicographic order
+static void Seating(uint64_t k, int n, int seats, uint8_t* seat)
+{
+    bool used[TOURNEY_MAX_ENTRANTS] = { false };
+    uint64_t below = 1; //seatings that share the first s + 1 seats
+    for (int s = 1; s < seats; s++) below *= (uint64_t)(n - s);
+    for (int s = 0; s < seats; s++) {
+        uint64_t pick = k / below;
+        k %= below;
+        int e = 0;
+        for (;; e++) {
+            if (used[e]) continue;
+            if (pick-- == 0) break;
+        }
+        used[e] = true;
+        seat[s] = (uint8_t)e;
+        if (s + 1 < seats) below /= (uint64_t)(n - s - 1);
+    }
+}
+
+//minorization-maximization on the bradley-terry likelihood, then the elo scale. the error
+//bars come from the curvature of each rating with the others held, an estimate since a
+//many-seat match gives several pairwise results that aren't independent
+static void Rate(int n, TourneyResult* out)
+{
+    double g[TOURNEY_MAX_ENTRANTS], next[TOURNEY_MAX_ENTRANTS];
+    for (int i = 0; i < n; i++) g[i] = 1.0;
+    for (int iter = 0; iter < 10000; iter++) {
+        double moved = 0.0, logSum = 0.0;
+        for (int i = 0; i < n; i++) {
+            double won = RATING_PRIOR, denom = 2.0 * RATING_PRIOR / (g[i] + 1.0);
+            for (int j = 0; j < n; j++) {
+                if (j == i) continue;
+                won += (double)out->beat[i][j];
+                denom += (double)(out->beat[i][j] + out->beat[j][i]) / (g[i] + g[j]);
+            }
+            next[i] = won / denom;
+            logSum += log(next[i]);
+        }
+        double scale = exp(-logSum / n);
+        for (int i = 0; i < n; i++) {
+            next[i] *= scale;
+            double d = fabs(log(next[i] / g[i]));
+            if (d > moved) moved = d;
+            g[i] = next[i];
+        }
+        if (moved < 1e-10) break;
+    }
+    const double perNat = 400.0 / log(10.0);
+    for (int i = 0; i < n; i++) {
+        double info = 2.0 * RATING_PRIOR * g[i] / ((g[i] + 1.0) * (g[i] + 1.0));
+        for (int j = 0; j < n; j++) {
+            if (j != i) info += (double)(out->beat[i][j] + out->beat[j][i]) * g[i] * g[j] / ((g[i] + g[j]) * (g[i] + g[j]));
+        }
+        out->elo[i] = perNat * log(g[i]);
+        out->eloCi[i] = 1.96 * perNat / sqrt(info);
+    }
+}
+
+int RunTourney(const TourneyConfig* cfg, TourneyResult* out)
+{
+    memset(out, 0, sizeof(*out));
+    int n = cfg->entrantCount;
+    if (n < 2 || n > TOURNEY_MAX_ENTRANTS || cfg->seats < 2 || cfg->seats > MAX_PLAYERS || cfg->seats > n ||
+        cfg->repeats < 1 || (cfg->format == TOURNEY_SWISS && (cfg->seats != 2 || cfg->rounds < 1 ||
+        (int64_t)cfg->repeats * (n / 2) > TOURNEY_BATCH))) {
+        return 0;
+    }
+    int threads = cfg->threads > 0 ? cfg->threads : SysCpuCount();
+    bool bots = false;
+    for (int i = 0; i < n; i++) bots |= cfg->entrants[i].kind == STRAT_BOT;
+
+    Match* matches = (Match*)malloc(TOURNEY_BATCH * sizeof(Match));
+    Worker* workers = (Worker*)calloc((size_t)threads, sizeof(Worker));
+    SysThread* handles = (SysThread*)calloc((size_t)threads, sizeof(SysThread));
+    Bot* botPool = bots ? (Bot*)calloc((size_t)threads, sizeof(Bot)) : NULL;
+    bool ok = matches && workers && handles && (!bots || botPool);
+    Pool pool = { cfg, matches, 0, 0, 0 };
+    for (int t = 0; ok && t < threads; t++) {
+        workers[t].pool = &pool;
+        if (bots) {
+            ok = BotInit(&botPool[t], 0, TOURNEY_BOT_DEPTH, 0);
+            workers[t].bot = &botPool[t];
+        }
+    }
+    if (ok && cfg->csv) {
+        fprintf(cfg->csv, "match,seed,seat1,seat2,seat3,seat4,winner_seat,winner,turns\n");
+    }
+
+    double start = SysNow();
+    uint64_t index = 0;
+    if (ok && cfg->format == TOURNEY_ROUND_ROBIN) {
+        uint64_t seatings = 1;
+        for (int s = 0; s < cfg->seats; s++) seatings *= (uint64_t)(n - s);
+        uint64_t total = seatings * (uint64_t)cfg->repeats;
+        //repeat-major, so the first batch already has every seating in it
+        while (index < total) {
+            int64_t count = total - index < TOURNEY_BATCH ? (int64_t)(total - index) : TOURNEY_BATCH;
+            for (int64_t i = 0; i < count; i++) Seating((index + (uint64_t)i) % seatings, n, cfg->seats, matches[i].seat);
+            pool.base = index;
+            pool.count = count;
+            PlayBatch(&pool, workers, handles, threads);
+            for (int64_t i = 0; i < count; i++) Record(cfg, &matches[i], index + (uint64_t)i, out);
+            index += (uint64_t)count;
+        }
+    }
+    else if (ok) {
+        //each round pairs neighbors by win rate so far, ties by entry order, an odd one out sits the round out
+        for (int round = 0; round < cfg->rounds; round++) {
+            int order[TOURNEY_MAX_ENTRANTS];
+            for (int i = 0; i < n; i++) {
+                int j = i;
+                double rate = out->games[i] ? (double)out->wins[i] / (double)out->games[i] : 0.5;
+                for (; j > 0; j--) {
+                    int o = order[j - 1];
+                    double other = out->games[o] ? (double)out->wins[o] / (double)out->games[o] : 0.5;
+                    if (other >= rate) break;
+                    order[j] = o;
+                }
+                order[j] = i;
+            }
+            int64_t count = 0;
+            for (int p = 0; p + 1 < n; p += 2) {
+                for (int r = 0; r < cfg->repeats; r++, count++) {
+                    matches[count].seat[0] = (uint8_t)order[p + (r & 1)];
+                    matches[count].seat[1] = (uint8_t)order[p + 1 - (r & 1)];
+                }
+            }
+            pool.base = index;
+            pool.count = count;
+            PlayBatch(&pool, workers, handles, threads);
+            for (int64_t i = 0; i < count; i++) Record(cfg, &matches[i], index + (uint64_t)i, out);
+            index += (uint64_t)count;
+        }
+    }
+    out->seconds = SysNow() - start;
+    out->threads = threads;
+    if (ok) Rate(n, out);
+
+    for (int t = 0; bots && botPool && t < threads; t++) BotFree(&botPool[t]);
+    free(botPool);
+    free(matches);
+    free(workers);
+    free(handles);
+    return ok;
+}
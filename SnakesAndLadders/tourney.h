@@ -0,0 +1,67 @@
+#pragma once
+#include <stdio.h>
+#include "game.h"
+
+//chaos mode tournaments between snake placement strategies, spread over every core.
+//match i of a tournament always plays from GameSeed(seed, i) and the results are taken in
+//match order, so the csv and the ratings come out the same on any number of threads
+//(time budgeted bots excepted, how deep they get depends on the box).
+//
+//ratings are bradley-terry fits on the elo scale: a win counts as beating every other seat
+//of that match. they come from all the results at once, so unlike running elo updates they
+//don't depend on the order matches were played in
+
+#define TOURNEY_MAX_ENTRANTS 32
+#define TOURNEY_NAME_LEN     24
+#define TOURNEY_BATCH        65536 //matches played between csv flushes
+#define TOURNEY_BOT_DEPTH    2     //turns a bot without a time budget searches, repeatable
+
+typedef enum {
+    STRAT_NONE,   //never places
+    STRAT_RANDOM, //RandomSnakePolicy
+    STRAT_GREEDY, //GreedySnakePolicy
+    STRAT_BOT     //the expectimax bot, "bot" to a fixed depth or "bot:<ms>" on a time budget
+} StrategyKind;
+
+typedef struct {
+    char name[TOURNEY_NAME_LEN];
+    StrategyKind kind;
+    double budgetMs;
+    int depth;
+} Entrant;
+
+typedef enum {
+    TOURNEY_ROUND_ROBIN, //every seating of every entrant mix
+    TOURNEY_SWISS        //two seats, rounds of neighbors by score so far
+} TourneyFormat;
+
+typedef struct {
+    Entrant entrants[TOURNEY_MAX_ENTRANTS];
+    int entrantCount;
+    TourneyFormat format;
+    int seats;
+    int diceCount;
+    int repeats; //matches per seating, round robin, or per pairing and round, swiss (seat order alternates)
+    int rounds;  //swiss
+    uint64_t seed;
+    int threads; //<= 0 uses one per core
+    FILE* csv;   //a line per match when set
+} TourneyConfig;
+
+typedef struct {
+    uint64_t matches;
+    uint64_t unfinished;
+    uint64_t games[TOURNEY_MAX_ENTRANTS];
+    uint64_t wins[TOURNEY_MAX_ENTRANTS];
+    uint64_t beat[TOURNEY_MAX_ENTRANTS][TOURNEY_MAX_ENTRANTS]; //beat[i][j], times i won a match j sat in
+    uint64_t seatWins[MAX_PLAYERS];
+    double elo[TOURNEY_MAX_ENTRANTS];   //0 is the average entrant
+    double eloCi[TOURNEY_MAX_ENTRANTS]; //95% half width
+    double turns;
+    double seconds;
+    int threads;
+} TourneyResult;
+
+//"none", "random", "greedy", "bot" or "bot:<ms>"
+bool EntrantParse(const char* text, Entrant* out);
+int  RunTourney(const TourneyConfig* cfg, TourneyResult* out);
@@ -0,0 +1,379 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include "traj.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define TRAJ_GRAB 4 //chunks a query worker takes at a time
+
+typedef struct {
+    const TrajReader* r;
+    int lo, hi;
+    int buckets;
+    volatile int64_t next;
+} QueryPool;
+
+typedef struct {
+    QueryPool* pool;
+    uint64_t* hist;
+} QueryWorker;
+
+static int Bits(uint32_t v)
+{
+    int n = 0;
+    while (v) {
+        n++;
+        v >>= 1;
+    }
+    return n;
+}
+
+static uint64_t Words(uint64_t count, int width)
+{
+    return (count * (uint64_t)width + 63) / 64;
+}
+
+bool TrajWriterOpen(TrajWriter* w, const char* path, const SimConfig* cfg, uint64_t games, uint64_t seed)
+{
+    memset(w, 0, sizeof(*w));
+    if (!SysLockInit(&w->lock)) {
+        return false;
+    }
+    w->f = fopen(path, "wb");
+    if (!w->f) {
+        SysLockFree(&w->lock);
+        return false;
+    }
+    TrajHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, TRAJ_MAGIC, sizeof(h.magic));
+    h.version = TRAJ_VERSION;
+    h.tiles = BOARD_TILES; //headless games are on the default board
+    h.players = (uint8_t)cfg->playerCount;
+    h.dice = (uint8_t)cfg->diceCount;
+    h.mode = (uint8_t)cfg->mode;
+    h.rules = cfg->rules;
+    h.seed = seed;
+    h.games = games;
+    w->failed = fwrite(&h, sizeof(h), 1, w->f) != 1;
+    w->at = sizeof(h);
+    return true;
+}
+
+static int ByFirstGame(const void* a, const void* b)
+{
+    uint64_t x = ((const TrajChunk*)a)->firstGame, y = ((const TrajChunk*)b)->firstGame;
+    return (x > y) - (x < y);
+}
+
+bool TrajWriterClose(TrajWriter* w)
+{
+    qsort(w->index, (size_t)w->chunks, sizeof(TrajChunk), ByFirstGame);
+    TrajFooter foot;
+    memset(&foot, 0, sizeof(foot));
+    foot.indexOffset = w->at;
+    foot.chunks = w->chunks;
+    foot.moves = w->moves;
+    memcpy(foot.magic, TRAJ_MAGIC, sizeof(foot.magic));
+    bool ok = !w->failed;
+    ok = ok && (w->chunks == 0 || fwrite(w->index, sizeof(TrajChunk), (size_t)w->chunks, w->f) == w->chunks);
+    ok = ok && fwrite(&foot, sizeof(foot), 1, w->f) == 1;
+    ok = (fclose(w->f) == 0) && ok;
+    free(w->index);
+    SysLockFree(&w->lock);
+    memset(w, 0, sizeof(*w));
+    return ok;
+}
+
+void TrajBufFree(TrajBuf* b)
+{
+    for (int c = 0; c < TRAJ_COLUMNS; c++) free(b->values[c]);
+    free(b->packed);
+    memset(b, 0, sizeof(*b));
+}
+
+void TrajBufBegin(TrajBuf* b, uint64_t firstGame)
+{
+    b->firstGame = firstGame;
+    b->games = 0;
+    b->moves = 0;
+    b->gameMoves = 0;
+    b->failed = false;
+}
+
+//doubles whichever side is full, marks the buffer failed if it can't
+bool TrajBufGrow(TrajBuf* b)
+{
+    if (b->failed) {
+        return false;
+    }
+    if (b->games == b->gameCap) {
+        uint32_t cap = b->gameCap ? 2 * b->gameCap : 1024;
+        uint32_t* v = (uint32_t*)realloc(b->values[TRAJ_MOVES], cap * sizeof(uint32_t));
+        if (!v) {
+            b->failed = true;
+            return false;
+        }
+        b->values[TRAJ_MOVES] = v;
+        b->gameCap = cap;
+    }
+    if (b->moves == b->moveCap) {
+        uint32_t cap = b->moveCap ? 2 * b->moveCap : 65536;
+        for (int c = TRAJ_SEAT; c < TRAJ_COLUMNS; c++) {
+            uint32_t* v = (uint32_t*)realloc(b->values[c], cap * sizeof(uint32_t));
+            if (!v) {
+                b->failed = true;
+                return false;
+            }
+            b->values[c] = v;
+        }
+        b->moveCap = cap;
+    }
+    return true;
+}
+
+//values less their smallest, each in width bits, little end first
+static void Pack(const uint32_t* values, uint32_t count, uint32_t base, int width, uint64_t* out)
+{
+    uint64_t words = Words(count, width);
+    memset(out, 0, (size_t)words * sizeof(uint64_t));
+    if (width == 0) {
+        return;
+    }
+    uint64_t bit = 0;
+    for (uint32_t i = 0; i < count; i++, bit += (uint64_t)width) {
+        uint64_t v = values[i] - base;
+        uint64_t at = bit >> 6;
+        int shift = (int)(bit & 63);
+        out[at] |= v << shift;
+        if (shift + width > 64) out[at + 1] |= v >> (64 - shift);
+    }
+}
+
+bool TrajFlush(TrajWriter* w, TrajBuf* b)
+{
+    if (b->games == 0 && !b->failed) {
+        return true;
+    }
+    TrajChunk c;
+    memset(&c, 0, sizeof(c));
+    c.firstGame = b->firstGame;
+    c.games = b->games;
+    c.moves = b->moves;
+    uint64_t total = 0;
+    for (int col = 0; col < TRAJ_COLUMNS && !b->failed; col++) {
+        uint32_t count = col == TRAJ_MOVES ? b->games : b->moves;
+        const uint32_t* v = b->values[col];
+        uint32_t lo = count ? v[0] : 0, hi = lo;
+        for (uint32_t i = 1; i < count; i++) {
+            if (v[i] < lo) lo = v[i];
+            if (v[i] > hi) hi = v[i];
+        }
+        c.base[col] = lo;
+        c.width[col] = (uint8_t)Bits(hi - lo);
+        c.words[col] = (uint32_t)Words(count, c.width[col]);
+        total += c.words[col];
+    }
+    if (!b->failed && total > b->packedCap) {
+        uint64_t* p = (uint64_t*)realloc(b->packed, (size_t)total * sizeof(uint64_t));
+        if (p) {
+            b->packed = p;
+            b->packedCap = (size_t)total;
+        }
+        else {
+            b->failed = true;
+        }
+    }
+    if (b->failed) {
+        SysLockEnter(&w->lock);
+        w->failed = true;
+        SysLockLeave(&w->lock);
+        return false;
+    }
+    uint64_t* out = b->packed;
+    for (int col = 0; col < TRAJ_COLUMNS; col++) {
+        Pack(b->values[col], col == TRAJ_MOVES ? b->games : b->moves, c.base[col], c.width[col], out);
+        out += c.words[col];
+    }
+
+    //the packing ran outside the lock, only the write and the index entry are in it
+    SysLockEnter(&w->lock);
+    bool ok = !w->failed;
+    if (ok && w->chunks == w->indexCap) {
+        uint64_t cap = w->indexCap ? 2 * w->indexCap : 256;
+        TrajChunk* index = (TrajChunk*)realloc(w->index, (size_t)cap * sizeof(TrajChunk));
+        if (index) {
+            w->index = index;
+            w->indexCap = cap;
+        }
+        ok = index != NULL;
+    }
+    ok = ok && fwrite(b->packed, sizeof(uint64_t), (size_t)total, w->f) == total;
+    if (ok) {
+        c.offset = w->at;
+        w->at += total * sizeof(uint64_t);
+        w->index[w->chunks++] = c;
+        w->moves += b->moves;
+    }
+    w->failed |= !ok;
+    SysLockLeave(&w->lock);
+    return ok;
+}
+
+//the columns of every chunk have to lie between the header and the index, and each has to
+//hold its values, so a query never checks as it reads
+static bool ChunkFits(const TrajChunk* c, uint64_t indexOffset)
+{
+    if (c->offset < sizeof(TrajHeader) || c->offset % sizeof(uint64_t) || c->offset > indexOffset) {
+        return false;
+    }
+    uint64_t words = 0;
+    for (int col = 0; col < TRAJ_COLUMNS; col++) {
+        uint32_t count = col == TRAJ_MOVES ? c->games : c->moves;
+        if (c->width[col] > 32 || c->words[col] < Words(count, c->width[col])) return false;
+        words += c->words[col];
+    }
+    return words <= (indexOffset - c->offset) / sizeof(uint64_t);
+}
+
+bool TrajOpen(TrajReader* r, const char* path)
+{
+    memset(r, 0, sizeof(*r));
+    if (!SysMapFile(path, &r->map)) {
+        return false;
+    }
+    const uint8_t* data = r->map.data;
+    size_t size = r->map.size;
+    if (size < sizeof(TrajHeader) + sizeof(TrajFooter)) {
+        TrajClose(r);
+        return false;
+    }
+    const TrajHeader* h = (const TrajHeader*)data;
+    const TrajFooter* foot = (const TrajFooter*)(data + size - sizeof(TrajFooter));
+    uint64_t room = size - sizeof(TrajFooter);
+    if (memcmp(h->magic, TRAJ_MAGIC, sizeof(h->magic)) != 0 || h->version != TRAJ_VERSION ||
+        memcmp(foot->magic, TRAJ_MAGIC, sizeof(foot->magic)) != 0 || foot->indexOffset > room ||
+        foot->indexOffset % sizeof(uint64_t) || foot->chunks != (room - foot->indexOffset) / sizeof(TrajChunk) ||
+        (room - foot->indexOffset) % sizeof(TrajChunk)) {
+        TrajClose(r);
+        return false;
+    }
+    r->header = h;
+    r->index = (const TrajChunk*)(data + foot->indexOffset);
+    r->chunks = foot->chunks;
+    uint64_t moves = 0;
+    for (uint64_t k = 0; k < r->chunks; k++) {
+        const TrajChunk* c = &r->index[k];
+        if (!ChunkFits(c, foot->indexOffset) || (k && c->firstGame < r->index[k - 1].firstGame + r->index[k - 1].games)) {
+            TrajClose(r);
+            return false;
+        }
+        r->games += c->games;
+        moves += c->moves;
+    }
+    r->moves = moves;
+    if (moves != foot->moves) {
+        TrajClose(r);
+        return false;
+    }
+    return true;
+}
+
+void TrajClose(TrajReader* r)
+{
+    SysUnmapFile(&r->map);
+    memset(r, 0, sizeof(*r));
+}
+
+const uint64_t* TrajColumnWords(const TrajReader* r, uint64_t k, int column)
+{
+    const TrajChunk* c = &r->index[k];
+    uint64_t at = c->offset / sizeof(uint64_t);
+    for (int col = 0; col < column; col++) at += c->words[col];
+    return (const uint64_t*)r->map.data + at;
+}
+
+int64_t TrajFindGame(const TrajReader* r, uint64_t game)
+{
+    uint64_t lo = 0, hi = r->chunks;
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (r->index[mid].firstGame + r->index[mid].games <= game) lo = mid + 1;
+        else hi = mid;
+    }
+    return (lo < r->chunks && r->index[lo].firstGame <= game) ? (int64_t)lo : -1;
+}
+
+//walks one chunk's games, the from tile of each move being where its seat last ended up
+static void TileTurnsChunk(const QueryPool* p, uint64_t k, uint64_t* hist)
+{
+    const TrajReader* r = p->r;
+    const TrajChunk* c = &r->index[k];
+    const uint64_t* moves = TrajColumnWords(r, k, TRAJ_MOVES);
+    const uint64_t* seats = TrajColumnWords(r, k, TRAJ_SEAT);
+    const uint64_t* to = TrajColumnWords(r, k, TRAJ_TO);
+    int players = r->header->players;
+    uint64_t m = 0;
+    for (uint32_t g = 0; g < c->games; g++) {
+        uint32_t pos[MAX_PLAYERS] = { 1, 1, 1, 1 };
+        uint32_t on[MAX_PLAYERS] = { 0 };
+        uint64_t end = m + TrajGet(moves, c->width[TRAJ_MOVES], c->base[TRAJ_MOVES], g);
+        if (end > c->moves) end = c->moves;
+        for (; m < end; m++) {
+            uint32_t s = TrajGet(seats, c->width[TRAJ_SEAT], c->base[TRAJ_SEAT], m) & (MAX_PLAYERS - 1);
+            on[s] += pos[s] >= (uint32_t)p->lo && pos[s] <= (uint32_t)p->hi;
+            pos[s] = TrajGet(to, c->width[TRAJ_TO], c->base[TRAJ_TO], m);
+        }
+        for (int s = 0; s < players && s < MAX_PLAYERS; s++) {
+            hist[on[s] < (uint32_t)p->buckets ? on[s] : (uint32_t)p->buckets - 1]++;
+        }
+    }
+}
+
+static void QueryMain(void* arg)
+{
+    QueryWorker* w = (QueryWorker*)arg;
+    QueryPool* p = w->pool;
+    int64_t chunks = (int64_t)p->r->chunks;
+    for (;;) {
+        int64_t first = SysAdd64(&p->next, TRAJ_GRAB);
+        if (first >= chunks) {
+            return;
+        }
+        int64_t last = first + TRAJ_GRAB < chunks ? first + TRAJ_GRAB : chunks;
+        for (int64_t k = first; k < last; k++) TileTurnsChunk(p, (uint64_t)k, w->hist);
+    }
+}
+
+bool TrajTileTurns(const TrajReader* r, int lo, int hi, int threads, uint64_t* hist, int buckets)
+{
+    if (lo > hi || buckets < 1) {
+        return false;
+    }
+    memset(hist, 0, (size_t)buckets * sizeof(uint64_t));
+    if (threads <= 0) threads = SysCpuCount();
+    if ((uint64_t)threads > r->chunks) threads = r->chunks ? (int)r->chunks : 1;
+    QueryWorker* workers = (QueryWorker*)calloc((size_t)threads, sizeof(QueryWorker));
+    SysThread* handles = (SysThread*)calloc((size_t)threads, sizeof(SysThread));
+    uint64_t* hists = (uint64_t*)calloc((size_t)threads * (size_t)buckets, sizeof(uint64_t));
+    if (!workers || !handles || !hists) {
+        free(workers); free(handles); free(hists);
+        return false;
+    }
+    QueryPool pool = { r, lo, hi, buckets, 0 };
+    for (int t = 0; t < threads; t++) {
+        workers[t].pool = &pool;
+        workers[t].hist = hists + (size_t)t * (size_t)buckets;
+    }
+    int started = 1;
+    for (int t = 1; t < threads; t++) {
+        if (!SysThreadStart(&handles[t], QueryMain, &workers[t])) break;
+        started++;
+    }
+    QueryMain(&workers[0]);
+    for (int t = 1; t < started; t++) SysThreadJoin(&handles[t]);
+    for (int t = 0; t < threads; t++) {
+        for (int b = 0; b < buckets; b++) hist[b] += workers[t].hist[b];
+    }
+    free(workers); free(handles); free(hists);
+    return true;
+}
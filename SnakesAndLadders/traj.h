@@ -0,0 +1,155 @@
+#pragma once
+#include <stdio.h>
+#include "game.h"
+#include "sys.h"
+
+//every move of every game of a batch, kept on disk in columns. games go in chunks, one per
+//SIM_CHUNK the simulator hands out, and each column of a chunk is frame of reference packed:
+//a base from the index, then each value less the base in as few bits as its largest needs.
+//a column that never changes in the chunk takes no bits at all
+//
+//  header  64 bytes  TrajHeader
+//  chunk   columns back to back, each a whole number of u64 words
+//          TRAJ_MOVES   per game, its moves
+//          TRAJ_SEAT    per move, who moved
+//          TRAJ_ROLL    per move, the dice total
+//          TRAJ_TO      per move, the tile after Slide, or where a forfeited turn put it back
+//          TRAJ_BOUNCE  per move, 1 if the roll went past the last tile
+//  index   a TrajChunk per chunk, by first game
+//  footer  32 bytes  TrajFooter
+//
+//the from tile isn't stored, it's the seat's last to tile and 1 before that, so it decodes
+//for nothing as a chunk is walked. chunks are written in the order workers finish them, the
+//index is sorted when the file closes. numbers are little endian, as the structs lie in
+//memory on x86 and arm64, so a mapped file is read where it lies
+
+#define TRAJ_MAGIC   "SLTRAJ1" //and its terminator, 8 bytes
+#define TRAJ_VERSION 1
+
+typedef enum {
+    TRAJ_MOVES,
+    TRAJ_SEAT,
+    TRAJ_ROLL,
+    TRAJ_TO,
+    TRAJ_BOUNCE,
+    TRAJ_COLUMNS
+} TrajColumn;
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t tiles;
+    uint8_t players, dice, mode, pad;
+    uint32_t rules;
+    uint64_t seed;    //game i played from GameSeed(seed, i)
+    uint64_t games;   //asked for, the footer has what got written
+    uint64_t reserved[3];
+} TrajHeader;
+
+typedef struct {
+    uint64_t offset;    //of the first column
+    uint64_t firstGame;
+    uint32_t games;
+    uint32_t moves;
+    uint32_t base[TRAJ_COLUMNS];
+    uint32_t words[TRAJ_COLUMNS];
+    uint8_t width[TRAJ_COLUMNS];
+    uint8_t pad[3];
+} TrajChunk;
+
+typedef struct {
+    uint64_t indexOffset;
+    uint64_t chunks;
+    uint64_t moves;
+    char magic[8];
+} TrajFooter;
+
+//one worker's chunk while its games play, values unpacked
+typedef struct {
+    uint64_t firstGame;
+    uint32_t games, moves;
+    uint32_t gameMoves; //of the game playing now
+    uint32_t gameCap, moveCap;
+    uint32_t* values[TRAJ_COLUMNS]; //TRAJ_MOVES by game, the rest by move
+    uint64_t* packed;
+    size_t packedCap;
+    bool failed;        //out of memory, the chunk is dropped and the file marked bad
+} TrajBuf;
+
+typedef struct {
+    FILE* f;
+    uint64_t at;        //bytes written
+    TrajChunk* index;
+    uint64_t chunks, indexCap;
+    uint64_t moves;
+    SysLock lock;
+    bool failed;
+} TrajWriter;
+
+typedef struct {
+    SysMap map;
+    const TrajHeader* header;
+    const TrajChunk* index;
+    uint64_t chunks;
+    uint64_t games;
+    uint64_t moves;
+} TrajReader;
+
+bool TrajWriterOpen(TrajWriter* w, const char* path, const SimConfig* cfg, uint64_t games, uint64_t seed);
+//writes the index and the footer. false if any chunk failed, the file is then no good
+bool TrajWriterClose(TrajWriter* w);
+
+void TrajBufFree(TrajBuf* b);
+void TrajBufBegin(TrajBuf* b, uint64_t firstGame);
+bool TrajBufGrow(TrajBuf* b);
+//packs b and appends it to w, any thread
+bool TrajFlush(TrajWriter* w, TrajBuf* b);
+
+static inline void TrajMove(TrajBuf* b, int seat, int roll, int to, bool bounced)
+{
+    if (b->moves == b->moveCap && !TrajBufGrow(b)) {
+        return;
+    }
+    uint32_t m = b->moves++;
+    b->values[TRAJ_SEAT][m] = (uint32_t)seat;
+    b->values[TRAJ_ROLL][m] = (uint32_t)roll;
+    b->values[TRAJ_TO][m] = (uint32_t)to;
+    b->values[TRAJ_BOUNCE][m] = bounced;
+    b->gameMoves++;
+}
+
+static inline void TrajGameEnd(TrajBuf* b)
+{
+    if (b->games == b->gameCap && !TrajBufGrow(b)) {
+        return;
+    }
+    b->values[TRAJ_MOVES][b->games++] = b->gameMoves;
+    b->gameMoves = 0;
+}
+
+//maps the file, nothing is read until a column is
+bool TrajOpen(TrajReader* r, const char* path);
+void TrajClose(TrajReader* r);
+//the packed words of one column of chunk k, pointing into the mapping
+const uint64_t* TrajColumnWords(const TrajReader* r, uint64_t k, int column);
+//the chunk holding game, -1 if no chunk does
+int64_t TrajFindGame(const TrajReader* r, uint64_t game);
+
+//value i of a column
+static inline uint32_t TrajGet(const uint64_t* words, int width, uint32_t base, uint64_t i)
+{
+    if (width == 0) {
+        return base;
+    }
+    uint64_t bit = i * (uint64_t)width;
+    uint64_t at = bit >> 6;
+    int shift = (int)(bit & 63);
+    uint64_t v = words[at] >> shift;
+    if (shift + width > 64) v |= words[at + 1] << (64 - shift);
+    return base + (uint32_t)(v & ((1ull << width) - 1));
+}
+
+//how many rolls each token took standing on a tile in lo..hi, a count per token per game:
+//hist[n] tokens took n, the last bucket also takes more. chunks are shared out over threads,
+//<= 0 uses one per core. TrajOpen already checked every chunk fits the file
+bool TrajTileTurns(const TrajReader* r, int lo, int hi, int threads, uint64_t* hist, int buckets);
@@ -0,0 +1,43 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include "undo.h"
+
+void UndoClear(UndoRing* u)
+{
+    u->head = 0;
+    u->back = 0;
+    u->ahead = 0;
+}
+
+void UndoPush(UndoRing* u, const SaveState* before)
+{
+    u->slots[u->head] = *before;
+    u->head = (u->head + 1) % UNDO_DEPTH;
+    if (u->back < UNDO_DEPTH - 1) u->back++; //the oldest falls off, one slot stays for the live state
+    u->ahead = 0;
+}
+
+bool UndoBack(UndoRing* u, const SaveState* now, SaveState* out)
+{
+    if (!u->back) {
+        return false;
+    }
+    u->slots[u->head] = *now;
+    u->head = (u->head + UNDO_DEPTH - 1) % UNDO_DEPTH;
+    u->back--;
+    u->ahead++;
+    *out = u->slots[u->head];
+    return true;
+}
+
+bool UndoForward(UndoRing* u, const SaveState* now, SaveState* out)
+{
+    if (!u->ahead) {
+        return false;
+    }
+    u->slots[u->head] = *now;
+    u->head = (u->head + 1) % UNDO_DEPTH;
+    u->ahead--;
+    u->back++;
+    *out = u->slots[u->head];
+    return true;
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include "save.h"
+
+//the last UNDO_DEPTH states a game went through, for undo and redo. a state is a SaveState,
+//which holds nothing but values (the board's links and lookup slots included), so keeping
+//one is a plain copy and so is cloning a game for lookahead: Game next = *g;
+
+#define UNDO_DEPTH 64
+
+typedef struct {
+    SaveState slots[UNDO_DEPTH];
+    int head;  //where the live state goes when we step away from it
+    int back;  //states before head
+    int ahead; //states after head a redo can bring back
+} UndoRing;
+
+void UndoClear(UndoRing* u);
+void UndoPush(UndoRing* u, const SaveState* before); //before a change, drops whatever could be redone
+bool UndoBack(UndoRing* u, const SaveState* now, SaveState* out); //false with nothing to undo
+bool UndoForward(UndoRing* u, const SaveState* now, SaveState* out); //false with nothing to redo